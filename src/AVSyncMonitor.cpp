@@ -0,0 +1,126 @@
+#include "AVSyncMonitor.hpp"
+
+#include "Logger.hpp"
+#include "RTSPStatus.hpp"
+#include "globals.hpp"
+
+#include <cmath>
+#include <cstdio>
+#include <imp/imp_system.h>
+#include <string>
+
+#define MODULE "AVSyncMonitor"
+
+namespace {
+
+constexpr int64_t REPORT_INTERVAL_US = 5000000;
+// Audio latency older than this is not paired with video any more
+constexpr int64_t AUDIO_STALE_US = 2000000;
+// EWMA weight of a new sample
+constexpr double ALPHA = 1.0 / 32;
+// Skew change that is worth a log line
+constexpr double WARN_SKEW_MS = 200.0;
+
+struct Latency
+{
+    bool valid = false;
+    double ms = 0;
+    int64_t lastUs = 0;
+
+    void add(double sampleMs, int64_t nowUs)
+    {
+        ms = valid ? ms + ALPHA * (sampleMs - ms) : sampleMs;
+        valid = true;
+        lastUs = nowUs;
+    }
+};
+
+struct VideoState
+{
+    Latency latency;
+    int64_t lastReportUs = 0;
+    bool haveSkew = false;
+    double lastSkewMs = 0;
+    bool warned = false;
+};
+
+Latency audio;
+VideoState video[NUM_VIDEO_CHANNELS];
+
+int64_t toUs(const struct timeval &tv)
+{
+    return (int64_t) tv.tv_sec * 1000000 + tv.tv_usec;
+}
+
+std::string formatMs(double ms)
+{
+    char buf[32];
+    snprintf(buf, sizeof(buf), "%.1f", ms);
+    return buf;
+}
+
+void report(int encChn, VideoState &v, int64_t nowUs)
+{
+    std::string streamName = "stream" + std::to_string(encChn);
+    RTSPStatus::writeCustomParameter(streamName, "video_latency_ms", formatMs(v.latency.ms));
+
+    if (!audio.valid || nowUs - audio.lastUs > AUDIO_STALE_US)
+    {
+        // No audio on this session (or it stopped), nothing to compare
+        v.haveSkew = false;
+        return;
+    }
+
+    double skewMs = audio.ms - v.latency.ms;
+    RTSPStatus::writeCustomParameter(streamName, "audio_latency_ms", formatMs(audio.ms));
+    RTSPStatus::writeCustomParameter(streamName, "av_skew_ms", formatMs(skewMs));
+
+    if (v.haveSkew)
+    {
+        double minutes = (nowUs - v.lastReportUs) / 60000000.0;
+        RTSPStatus::writeCustomParameter(streamName, "av_drift_ms_per_min",
+                                         formatMs((skewMs - v.lastSkewMs) / minutes));
+    }
+
+    if (std::fabs(skewMs) > WARN_SKEW_MS)
+    {
+        if (!v.warned)
+            LOG_WARN("stream" << encChn << " A/V skew " << formatMs(skewMs) << " ms");
+        v.warned = true;
+    }
+    else
+    {
+        v.warned = false;
+    }
+
+    v.haveSkew = true;
+    v.lastSkewMs = skewMs;
+}
+
+} // namespace
+
+void AVSyncMonitor::videoDelivered(int encChn, const struct timeval &pts)
+{
+    if (encChn < 0 || encChn >= NUM_VIDEO_CHANNELS)
+        return;
+
+    int64_t nowUs = IMP_System_GetTimeStamp();
+    VideoState &v = video[encChn];
+    v.latency.add((nowUs - toUs(pts)) / 1000.0, nowUs);
+
+    if (v.lastReportUs == 0)
+    {
+        v.lastReportUs = nowUs;
+    }
+    else if (nowUs - v.lastReportUs >= REPORT_INTERVAL_US)
+    {
+        report(encChn, v, nowUs);
+        v.lastReportUs = nowUs;
+    }
+}
+
+void AVSyncMonitor::audioDelivered(const struct timeval &pts)
+{
+    int64_t nowUs = IMP_System_GetTimeStamp();
+    audio.add((nowUs - toUs(pts)) / 1000.0, nowUs);
+}
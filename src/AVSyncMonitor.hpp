@@ -0,0 +1,30 @@
+#ifndef AV_SYNC_MONITOR_HPP
+#define AV_SYNC_MONITOR_HPP
+
+#include <cstdint>
+#include <sys/time.h>
+
+/* Audio/video sync and drift monitor.
+ *
+ * Both workers stamp frames with their hardware capture time, so the delay
+ * between capture and hand-off to live555 (now - PTS) is comparable between
+ * the two media. Its smoothed difference is the A/V skew a client sees; the
+ * rate at which the skew changes is the drift between the two capture clocks.
+ *
+ * Published every few seconds per video stream under
+ * /run/prudynt/rtsp/stream<N>/:
+ *   av_skew_ms          audio latency minus video latency (positive: audio late)
+ *   video_latency_ms    capture to RTP delivery, video
+ *   audio_latency_ms    capture to RTP delivery, audio
+ *   av_drift_ms_per_min change of av_skew_ms over time
+ *
+ * Called from the live555 event loop only, so no locking is needed.
+ */
+class AVSyncMonitor
+{
+public:
+    static void videoDelivered(int encChn, const struct timeval &pts);
+    static void audioDelivered(const struct timeval &pts);
+};
+
+#endif // AV_SYNC_MONITOR_HPP
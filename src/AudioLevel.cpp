@@ -0,0 +1,284 @@
+#include "AudioLevel.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#elif defined(__ARM_NEON)
+#include <arm_neon.h>
+#elif defined(__mips_msa)
+#include <msa.h>
+#endif
+
+namespace AudioLevel {
+
+static inline void measure16Scalar(const int16_t *in, size_t samples, size_t parity, PcmEnergy &acc)
+{
+    for (size_t i = 0; i < samples; i++)
+    {
+        size_t p = (parity + i) & 1;
+        int32_t s = in[i];
+        acc.sumSquares[p] += (uint64_t) (s * s);
+        acc.peak[p] = std::max(acc.peak[p], s < 0 ? -s : s);
+    }
+}
+
+void measure16(const int16_t *in, size_t samples, PcmEnergy &acc)
+{
+    size_t i = 0;
+    // Per parity sums and extremes produced by the vector loop
+    uint64_t sumE = 0, sumO = 0;
+    int32_t maxE = 0, minE = 0, maxO = 0, minO = 0;
+
+#if defined(__SSE2__)
+    if (samples >= 8)
+    {
+        const __m128i evenMask = _mm_set1_epi32(0x0000FFFF);
+        const __m128i zero = _mm_setzero_si128();
+        __m128i accE = zero, accO = zero;
+        __m128i vmax = _mm_set1_epi16(0), vmin = _mm_set1_epi16(0);
+
+        for (; i + 8 <= samples; i += 8)
+        {
+            __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i *>(in + i));
+            // One square per 32-bit lane, at most 2^30 so the sign bit stays clear
+            __m128i e = _mm_madd_epi16(_mm_and_si128(v, evenMask), v);
+            __m128i o = _mm_madd_epi16(_mm_andnot_si128(evenMask, v), v);
+            accE = _mm_add_epi64(accE, _mm_add_epi64(_mm_unpacklo_epi32(e, zero), _mm_unpackhi_epi32(e, zero)));
+            accO = _mm_add_epi64(accO, _mm_add_epi64(_mm_unpacklo_epi32(o, zero), _mm_unpackhi_epi32(o, zero)));
+            vmax = _mm_max_epi16(vmax, v);
+            vmin = _mm_min_epi16(vmin, v);
+        }
+
+        alignas(16) uint64_t se[2], so[2];
+        alignas(16) int16_t mx[8], mn[8];
+        _mm_store_si128(reinterpret_cast<__m128i *>(se), accE);
+        _mm_store_si128(reinterpret_cast<__m128i *>(so), accO);
+        _mm_store_si128(reinterpret_cast<__m128i *>(mx), vmax);
+        _mm_store_si128(reinterpret_cast<__m128i *>(mn), vmin);
+        sumE = se[0] + se[1];
+        sumO = so[0] + so[1];
+        for (int l = 0; l < 8; l += 2)
+        {
+            maxE = std::max<int32_t>(maxE, mx[l]);
+            minE = std::min<int32_t>(minE, mn[l]);
+            maxO = std::max<int32_t>(maxO, mx[l + 1]);
+            minO = std::min<int32_t>(minO, mn[l + 1]);
+        }
+    }
+#elif defined(__ARM_NEON)
+    if (samples >= 16)
+    {
+        int64x2_t accE = vdupq_n_s64(0), accO = vdupq_n_s64(0);
+        int16x8_t maxEv = vdupq_n_s16(0), minEv = vdupq_n_s16(0);
+        int16x8_t maxOv = vdupq_n_s16(0), minOv = vdupq_n_s16(0);
+
+        for (; i + 16 <= samples; i += 16)
+        {
+            // De-interleave into even (val[0]) and odd (val[1]) samples
+            int16x8x2_t v = vld2q_s16(in + i);
+            accE = vpadalq_s32(accE, vmull_s16(vget_low_s16(v.val[0]), vget_low_s16(v.val[0])));
+            accE = vpadalq_s32(accE, vmull_s16(vget_high_s16(v.val[0]), vget_high_s16(v.val[0])));
+            accO = vpadalq_s32(accO, vmull_s16(vget_low_s16(v.val[1]), vget_low_s16(v.val[1])));
+            accO = vpadalq_s32(accO, vmull_s16(vget_high_s16(v.val[1]), vget_high_s16(v.val[1])));
+            maxEv = vmaxq_s16(maxEv, v.val[0]);
+            minEv = vminq_s16(minEv, v.val[0]);
+            maxOv = vmaxq_s16(maxOv, v.val[1]);
+            minOv = vminq_s16(minOv, v.val[1]);
+        }
+
+        sumE = vgetq_lane_s64(accE, 0) + vgetq_lane_s64(accE, 1);
+        sumO = vgetq_lane_s64(accO, 0) + vgetq_lane_s64(accO, 1);
+        int16_t mx[8], mn[8];
+        vst1q_s16(mx, maxEv);
+        vst1q_s16(mn, minEv);
+        for (int l = 0; l < 8; l++)
+        {
+            maxE = std::max<int32_t>(maxE, mx[l]);
+            minE = std::min<int32_t>(minE, mn[l]);
+        }
+        vst1q_s16(mx, maxOv);
+        vst1q_s16(mn, minOv);
+        for (int l = 0; l < 8; l++)
+        {
+            maxO = std::max<int32_t>(maxO, mx[l]);
+            minO = std::min<int32_t>(minO, mn[l]);
+        }
+    }
+#elif defined(__mips_msa)
+    if (samples >= 8)
+    {
+        const v8u16 evenMask = (v8u16) __msa_fill_w(0x0000FFFF);
+        const v8i16 zero = __msa_ldi_h(0);
+        v2u64 accE = (v2u64) __msa_ldi_d(0), accO = (v2u64) __msa_ldi_d(0);
+        v8i16 vmax = zero, vmin = zero;
+
+        for (; i + 8 <= samples; i += 8)
+        {
+            v8i16 v = (v8i16) __msa_ld_h(const_cast<int16_t *>(in + i), 0);
+            // |v| as unsigned, so -32768 squares to 2^30 without overflow
+            v8u16 a = (v8u16) __msa_add_a_h(v, zero);
+            v8u16 ae = (v8u16) __msa_and_v((v16u8) a, (v16u8) evenMask);
+            v8u16 ao = (v8u16) __msa_xor_v((v16u8) a, (v16u8) ae);
+            v4u32 e = __msa_dotp_u_w(ae, ae);
+            v4u32 o = __msa_dotp_u_w(ao, ao);
+            accE += __msa_hadd_u_d(e, e);
+            accO += __msa_hadd_u_d(o, o);
+            vmax = __msa_max_s_h(vmax, v);
+            vmin = __msa_min_s_h(vmin, v);
+        }
+
+        uint64_t se[2], so[2];
+        int16_t mx[8], mn[8];
+        __msa_st_d((v2i64) accE, se, 0);
+        __msa_st_d((v2i64) accO, so, 0);
+        __msa_st_h(vmax, mx, 0);
+        __msa_st_h(vmin, mn, 0);
+        sumE = se[0] + se[1];
+        sumO = so[0] + so[1];
+        for (int l = 0; l < 8; l += 2)
+        {
+            maxE = std::max<int32_t>(maxE, mx[l]);
+            minE = std::min<int32_t>(minE, mn[l]);
+            maxO = std::max<int32_t>(maxO, mx[l + 1]);
+            minO = std::min<int32_t>(minO, mn[l + 1]);
+        }
+    }
+#endif
+
+    acc.sumSquares[0] += sumE;
+    acc.sumSquares[1] += sumO;
+    acc.peak[0] = std::max(acc.peak[0], std::max(maxE, -minE));
+    acc.peak[1] = std::max(acc.peak[1], std::max(maxO, -minO));
+
+    // The vector loops consume an even number of samples, parity is preserved
+    measure16Scalar(in + i, samples - i, 0, acc);
+
+    acc.count[0] += (samples + 1) / 2;
+    acc.count[1] += samples / 2;
+}
+
+float toDbfs(double value)
+{
+    if (value <= 0.0)
+        return AudioLevelMeter::SILENCE_DBFS;
+    return std::max(AudioLevelMeter::SILENCE_DBFS, (float) (20.0 * std::log10(value / 32768.0)));
+}
+
+} // namespace AudioLevel
+
+void AudioLevelMeter::reset(int rate, int channels, int thresholdDb, int windowMs, int hangoverMs)
+{
+    sampleRate = rate > 0 ? rate : 16000;
+    numChannels = std::clamp(channels, 1, MAX_CHANNELS);
+    threshold = (float) thresholdDb;
+    windowSamples = (size_t) sampleRate * windowMs / 1000;
+    hangoverSamples = (size_t) sampleRate * hangoverMs / 1000;
+
+    window = PcmEnergy{};
+    for (int ch = 0; ch < MAX_CHANNELS; ch++)
+    {
+        rms[ch] = SILENCE_DBFS;
+        peak[ch] = SILENCE_DBFS;
+    }
+
+    noiseFloor = -60.0f;
+    noiseFloorSeeded = false;
+    loudFrames = 0;
+    sinceLoudSamples = 0;
+    active = false;
+    vadChanged = false;
+}
+
+bool AudioLevelMeter::process(const int16_t *pcm, size_t samples)
+{
+    if (samples == 0)
+        return false;
+
+    PcmEnergy frame;
+    AudioLevel::measure16(pcm, samples, frame);
+
+    // The VAD looks at the frame energy across all channels
+    double meanSquare = (double) (frame.sumSquares[0] + frame.sumSquares[1]) / samples;
+    updateVad(AudioLevel::toDbfs(std::sqrt(meanSquare)), samples / numChannels);
+
+    for (int p = 0; p < 2; p++)
+    {
+        window.sumSquares[p] += frame.sumSquares[p];
+        window.peak[p] = std::max(window.peak[p], frame.peak[p]);
+        window.count[p] += frame.count[p];
+    }
+
+    if ((window.count[0] + window.count[1]) / numChannels < windowSamples)
+        return false;
+
+    if (numChannels == 1)
+    {
+        size_t n = window.count[0] + window.count[1];
+        rms[0] = AudioLevel::toDbfs(std::sqrt((double) (window.sumSquares[0] + window.sumSquares[1]) / n));
+        peak[0] = AudioLevel::toDbfs(std::max(window.peak[0], window.peak[1]));
+    }
+    else
+    {
+        for (int ch = 0; ch < 2; ch++)
+        {
+            rms[ch] = window.count[ch] ? AudioLevel::toDbfs(std::sqrt((double) window.sumSquares[ch] / window.count[ch]))
+                                       : SILENCE_DBFS;
+            peak[ch] = AudioLevel::toDbfs(window.peak[ch]);
+        }
+    }
+
+    window = PcmEnergy{};
+    return true;
+}
+
+bool AudioLevelMeter::takeVadChange()
+{
+    bool changed = vadChanged;
+    vadChanged = false;
+    return changed;
+}
+
+void AudioLevelMeter::updateVad(float frameDbfs, size_t frameSamplesPerChannel)
+{
+    float frameSeconds = (float) frameSamplesPerChannel / sampleRate;
+
+    if (!noiseFloorSeeded)
+    {
+        noiseFloor = frameDbfs;
+        noiseFloorSeeded = true;
+    }
+
+    bool loud = frameDbfs > noiseFloor + threshold && frameDbfs > -70.0f;
+
+    // Follow the floor down quickly and up slowly (about 3 dB/s), and not at
+    // all while someone is talking so speech does not raise it
+    if (frameDbfs < noiseFloor)
+        noiseFloor += (frameDbfs - noiseFloor) * 0.25f;
+    else if (!loud)
+        noiseFloor = std::min(frameDbfs, noiseFloor + 3.0f * frameSeconds);
+    noiseFloor = std::max(noiseFloor, -90.0f);
+
+    if (loud)
+    {
+        loudFrames++;
+        sinceLoudSamples = 0;
+    }
+    else
+    {
+        loudFrames = 0;
+        sinceLoudSamples += frameSamplesPerChannel;
+    }
+
+    if (!active && loudFrames >= 2)
+    {
+        active = true;
+        vadChanged = true;
+    }
+    else if (active && sinceLoudSamples >= hangoverSamples)
+    {
+        active = false;
+        vadChanged = true;
+    }
+}
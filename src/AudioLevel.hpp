@@ -0,0 +1,82 @@
+#ifndef AUDIO_LEVEL_HPP
+#define AUDIO_LEVEL_HPP
+
+#include <cstddef>
+#include <cstdint>
+
+/* Raw energy and peak of a block of 16-bit PCM, split by sample parity.
+ * For interleaved stereo the even lanes are L and the odd lanes R; for mono
+ * the caller simply adds both halves.
+ */
+struct PcmEnergy
+{
+    uint64_t sumSquares[2] = {0, 0};
+    int32_t peak[2] = {0, 0};
+    size_t count[2] = {0, 0};
+};
+
+namespace AudioLevel {
+
+/* Accumulate 'samples' interleaved 16-bit samples into 'acc'. Parity starts
+ * over with every call, so stereo blocks must hold whole frames.
+ * SSE2/NEON/MSA when available, scalar otherwise (MSA on T40/T41, see
+ * MSA_SOURCES in the Makefile).
+ */
+void measure16(const int16_t *in, size_t samples, PcmEnergy &acc);
+
+// 20*log10(value / 32768), clamped to the 16-bit noise floor
+float toDbfs(double value);
+
+} // namespace AudioLevel
+
+/* Per-channel RMS/peak meter with an energy based voice activity detector.
+ *
+ * process() is called for every captured frame. Levels are integrated over a
+ * window (250 ms by default) and become readable when process() returns true.
+ * The VAD runs per frame against an adaptive noise floor: speech must exceed
+ * the floor by 'thresholdDb' for two consecutive frames to switch on and is
+ * held for 'hangoverMs' after the last loud frame.
+ */
+class AudioLevelMeter
+{
+public:
+    static constexpr int MAX_CHANNELS = 2;
+    static constexpr float SILENCE_DBFS = -96.0f;
+
+    void reset(int sampleRate, int channels, int thresholdDb,
+               int windowMs = 250, int hangoverMs = 300);
+
+    // Returns true when a new window of levels is available.
+    bool process(const int16_t *pcm, size_t samples);
+
+    int channels() const { return numChannels; }
+    float rmsDbfs(int ch) const { return rms[ch]; }
+    float peakDbfs(int ch) const { return peak[ch]; }
+    float noiseFloorDbfs() const { return noiseFloor; }
+
+    bool voiceActive() const { return active; }
+    // True once after each VAD transition, cleared by the call
+    bool takeVadChange();
+
+private:
+    void updateVad(float frameDbfs, size_t frameSamplesPerChannel);
+
+    int sampleRate = 16000;
+    int numChannels = 1;
+    float threshold = 9.0f;
+    size_t windowSamples = 0;
+    size_t hangoverSamples = 0;
+
+    PcmEnergy window;
+    float rms[MAX_CHANNELS] = {SILENCE_DBFS, SILENCE_DBFS};
+    float peak[MAX_CHANNELS] = {SILENCE_DBFS, SILENCE_DBFS};
+
+    float noiseFloor = -60.0f;
+    bool noiseFloorSeeded = false;
+    int loudFrames = 0;
+    size_t sinceLoudSamples = 0;
+    bool active = false;
+    bool vadChanged = false;
+};
+
+#endif // AUDIO_LEVEL_HPP
@@ -6,55 +6,44 @@ AudioReframer::AudioReframer(unsigned int inputSampleRate, unsigned int inputSam
     : inputSampleRate(inputSampleRate),
       inputSamplesPerFrame(inputSamplesPerFrame),
       outputSamplesPerFrame(outputSamplesPerFrame),
-      currentTimestamp(0),
-      samplesAccumulated(0),
-      buffer(2 * std::max(inputSamplesPerFrame, outputSamplesPerFrame) * sizeof(uint16_t))
+      buffer(2 * std::max(inputSamplesPerFrame, outputSamplesPerFrame))
 {
     if (inputSamplesPerFrame == 0 || outputSamplesPerFrame == 0)
     {
         throw std::invalid_argument("Number of samples per frame must be greater than zero.");
     }
+    timeline.reset(inputSampleRate);
 }
 
-void AudioReframer::addFrame(const uint8_t* frameData, int64_t timestamp)
+bool AudioReframer::addFrame(const int16_t* frameData, int64_t timestamp)
 {
     if (frameData == nullptr)
     {
-        throw std::invalid_argument("Frame data cannot be null.");
+        return false;
     }
 
-    size_t inputFrameSize = inputSamplesPerFrame * sizeof(uint16_t);
-    buffer.push(frameData, inputFrameSize);
-
-    if (samplesAccumulated == 0)
+    if (buffer.push(frameData, inputSamplesPerFrame) != RingStatus::Ok)
     {
-        currentTimestamp = timestamp; // Initialize timestamp with the first frame
+        return false;
     }
 
-    samplesAccumulated += inputSamplesPerFrame;
+    timeline.push(timestamp, inputSamplesPerFrame);
+    return true;
 }
 
-void AudioReframer::getReframedFrame(uint8_t* frameData, int64_t& timestamp)
+bool AudioReframer::getReframedFrame(int16_t* frameData, int64_t& timestamp)
 {
-    if (!hasMoreFrames())
+    if (frameData == nullptr || buffer.fetch(frameData, outputSamplesPerFrame) != RingStatus::Ok)
     {
-        throw std::runtime_error("Insufficient samples to generate a reframed output.");
-    }
-
-    if (frameData == nullptr) {
-        throw std::invalid_argument("Output frame cannot be null.");
+        return false;
     }
 
-    size_t outputFrameSize = outputSamplesPerFrame * sizeof(uint16_t);
-    buffer.fetch(frameData, outputFrameSize);
-    samplesAccumulated -= outputSamplesPerFrame;
-
-    timestamp = currentTimestamp;
-    currentTimestamp += (static_cast<int64_t>(outputSamplesPerFrame) * 1000000) / inputSampleRate;
+    timestamp = timeline.front();
+    timeline.consume(outputSamplesPerFrame);
+    return true;
 }
 
 bool AudioReframer::hasMoreFrames() const
 {
-    return samplesAccumulated >= outputSamplesPerFrame;
+    return buffer.getSize() >= outputSamplesPerFrame;
 }
-
@@ -3,6 +3,7 @@
 
 #include <cstdint>
 #include <cstddef>
+#include "CaptureTimeline.hpp"
 #include "RingBuffer.hpp"
 
 class AudioReframer
@@ -10,9 +11,13 @@ class AudioReframer
 public:
     AudioReframer(unsigned int inputSampleRate, unsigned int inputSamplesPerFrame, unsigned int outputSamplesPerFrame);
 
-    void addFrame(const uint8_t* frameData, int64_t timestamp);
+    // Returns false (and drops the frame) if the internal buffer is full.
+    // 'timestamp' is the capture time of the frame's first sample in us.
+    bool addFrame(const int16_t* frameData, int64_t timestamp);
 
-    void getReframedFrame(uint8_t* frameData, int64_t& timestamp);
+    // Returns false if fewer than outputSamplesPerFrame samples are buffered.
+    // 'timestamp' is the capture time of the first sample of the output frame.
+    bool getReframedFrame(int16_t* frameData, int64_t& timestamp);
 
     bool hasMoreFrames() const;
 
@@ -20,11 +25,9 @@ private:
     unsigned int inputSampleRate;
     unsigned int inputSamplesPerFrame;
     unsigned int outputSamplesPerFrame;
-    int64_t currentTimestamp;
-    size_t samplesAccumulated;
+    CaptureTimeline timeline;
 
-    RingBuffer buffer;
+    RingBuffer<int16_t> buffer;
 };
 
 #endif // AUDIO_REFRAMER_HPP
-
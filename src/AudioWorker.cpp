@@ -6,7 +6,11 @@
 #include "TimestampManager.hpp"
 #include "globals.hpp"
 #include "RTSPStatus.hpp"
+#include "PcmConvert.hpp"
+#include "EventBus.hpp"
 #include <chrono>
+#include <cstdio>
+#include <cstdlib>
 
 #define MODULE "AudioWorker"
 
@@ -20,20 +24,172 @@ AudioWorker::AudioWorker(int chn)
 
 AudioWorker::~AudioWorker()
 {
+    if (encodeThread.joinable())
+    {
+        encodeRunning = false;
+        encodeReady.release();
+        encodeThread.join();
+    }
     LOG_DEBUG("AudioWorker destroyed for channel " << encChn);
 }
 
-void AudioWorker::process_audio_frame_direct(IMPAudioFrame &frame)
+void AudioWorker::publish_timing(const char *stage, StageTiming &timing)
 {
-    // SINGLE SOURCE OF TRUTH: Use TimestampManager (same as video)
-    struct timeval encoder_time;
-    TimestampManager::getInstance().getTimestamp(&encoder_time);
+    // Every ~5 s at 20 ms frames
+    if (timing.count < 250)
+        return;
+
+    std::string streamName = std::string("audio") + std::to_string(encChn);
+    std::string prefix = std::string(stage) + "_stage_";
+    RTSPStatus::writeCustomParameter(streamName, prefix + "avg_us", std::to_string(timing.sumUs / timing.count));
+    RTSPStatus::writeCustomParameter(streamName, prefix + "max_us", std::to_string(timing.maxUs));
+    timing.reset();
+}
+
+void AudioWorker::measure_levels(const IMPAudioFrame &frame)
+{
+    int channels = frame.soundmode == AUDIO_SOUND_MODE_STEREO ? 2 : 1;
+    if (channels != levelMeter.channels())
+    {
+        levelMeter.reset(global_audio[encChn]->imp_audio->sample_rate, channels, cfg->audio.vad_threshold);
+    }
+
+    bool windowDone = levelMeter.process(reinterpret_cast<const int16_t *>(frame.virAddr),
+                                         frame.len / sizeof(int16_t));
+
+    if (levelMeter.takeVadChange())
+    {
+        bool active = levelMeter.voiceActive();
+        global_audio[encChn]->voiceActive = active;
+        RTSPStatus::writeCustomParameter(std::string("audio") + std::to_string(encChn), "vad_active",
+                                         active ? "1" : "0");
+        LOG_DEBUG("Voice activity " << (active ? "started" : "stopped") << " (floor "
+                  << levelMeter.noiseFloorDbfs() << " dBFS)");
+
+        if (soundEvents)
+        {
+            auto now = std::chrono::steady_clock::now();
+            if (active && !soundEventActive
+                && now - lastSoundEvent >= std::chrono::seconds(cfg->audio.sound_event_cooldown))
+            {
+                soundEventActive = true;
+                lastSoundEvent = now;
+                EventBus::instance().publish({EventSource::Sound, true});
+            }
+            else if (!active && soundEventActive)
+            {
+                soundEventActive = false;
+                EventBus::instance().publish({EventSource::Sound, false});
+            }
+        }
+    }
+
+    if (!windowDone)
+        return;
 
+    float rms = AudioLevelMeter::SILENCE_DBFS;
+    float peak = AudioLevelMeter::SILENCE_DBFS;
+    for (int ch = 0; ch < levelMeter.channels(); ch++)
+    {
+        rms = std::max(rms, levelMeter.rmsDbfs(ch));
+        peak = std::max(peak, levelMeter.peakDbfs(ch));
+    }
+    global_audio[encChn]->levelRmsDbfs = rms;
+    global_audio[encChn]->levelPeakDbfs = peak;
+
+    // Every RTSPStatus write takes its mutex and touches the filesystem, so
+    // the files follow the meter once a second and only where a value moved
+    auto now = std::chrono::steady_clock::now();
+    if (now - lastLevelPublish < std::chrono::seconds(1))
+        return;
+    lastLevelPublish = now;
+
+    for (int ch = 0; ch < levelMeter.channels(); ch++)
+    {
+        std::string prefix = "level" + std::to_string(ch) + "_";
+        publish_level(prefix + "rms_dbfs", levelMeter.rmsDbfs(ch));
+        publish_level(prefix + "peak_dbfs", levelMeter.peakDbfs(ch));
+    }
+    publish_level("noise_floor_dbfs", levelMeter.noiseFloorDbfs());
+}
+
+void AudioWorker::publish_level(const std::string &parameter, float dbfs)
+{
+    char value[16];
+    snprintf(value, sizeof(value), "%.1f", dbfs);
+
+    std::string &last = publishedLevels[parameter];
+    if (last == value)
+        return;
+    last = value;
+    RTSPStatus::writeCustomParameter(std::string("audio") + std::to_string(encChn), parameter, last);
+}
+
+void AudioWorker::enqueue_frame(IMPAudioFrame &frame)
+{
+    EncodeJob *job = encodeQueue.acquire();
+    if (!job)
+    {
+        uint32_t drops = ++encodeQueueDropCount;
+        if (drops <= 10 || (drops % 100) == 0)
+        {
+            LOG_WARN("Audio encode queue full, dropped frame (" << drops << " drops so far)");
+        }
+        RTSPStatus::writeCustomParameter(std::string("audio") + std::to_string(encChn),
+                                         "encode_queue_drop_count",
+                                         std::to_string(drops));
+        return;
+    }
+
+    size_t samples = frame.len / sizeof(int16_t);
+    if (job->pcm.size() < samples)
+    {
+        job->pcm.resize(samples);
+    }
+    memcpy(job->pcm.data(), frame.virAddr, samples * sizeof(int16_t));
+
+    job->frame = frame;
+    job->frame.virAddr = (uint32_t *) job->pcm.data();
+
+    // PTS is the hardware capture time of the first sample, so neither
+    // queueing nor encode latency shows up as jitter
+    TimestampManager::toTimeval(frame.timeStamp, &job->time);
+
+    encodeQueue.publish();
+    encodeReady.release();
+}
+
+void AudioWorker::encode_loop()
+{
+    LOG_DEBUG("Start audio encode loop for channel " << encChn);
+
+    while (encodeRunning)
+    {
+        if (!encodeReady.try_acquire_for(std::chrono::milliseconds(250)))
+            continue;
+
+        EncodeJob *job = encodeQueue.front();
+        if (!job)
+            continue;
+
+        auto t0 = std::chrono::steady_clock::now();
+        process_audio_frame_direct(job->frame, job->time);
+        encodeQueue.pop();
+        encodeTiming.add(std::chrono::duration_cast<std::chrono::microseconds>(
+                             std::chrono::steady_clock::now() - t0).count());
+        publish_timing("encode", encodeTiming);
+    }
+
+    LOG_DEBUG("Exit audio encode loop for channel " << encChn);
+}
+
+void AudioWorker::process_audio_frame_direct(IMPAudioFrame &frame, const struct timeval &time)
+{
     // TIMESTAMP DEBUG: Log audio frame processing
-    LOG_DEBUG("AUDIO_TIMESTAMP_2_PROCESS: frame.timeStamp=" << frame.timeStamp << " encoder_time.tv_sec=" << encoder_time.tv_sec << " encoder_time.tv_usec=" << encoder_time.tv_usec);
+    LOG_DEBUG("AUDIO_TIMESTAMP_2_PROCESS: frame.timeStamp=" << frame.timeStamp << " capture_time.tv_sec=" << time.tv_sec << " capture_time.tv_usec=" << time.tv_usec);
 
     AudioFrame af;
-    af.time = encoder_time;
+    af.time = time;
 
     uint8_t *start = (uint8_t *) frame.virAddr;
     uint8_t *end = start + frame.len;
@@ -99,14 +255,34 @@ void AudioWorker::process_audio_frame_direct(IMPAudioFrame &frame)
 
 void AudioWorker::process_frame(IMPAudioFrame &frame)
 {
+    // Channel conversion: the AI device captures mono, duplicate into L/R when
+    // stereo output is forced. Done first so the Opus accumulator sees the
+    // interleaved layout it sizes its frames for.
+    if (global_audio[encChn]->imp_audio->outChnCnt == 2 && frame.soundmode == AUDIO_SOUND_MODE_MONO)
+    {
+        size_t num_samples = frame.len / sizeof(int16_t);
+        if (stereoBuffer.size() < num_samples * 2)
+        {
+            stereoBuffer.resize(num_samples * 2);
+        }
+
+        PcmConvert::monoToStereo16(reinterpret_cast<const int16_t *>(frame.virAddr),
+                                   stereoBuffer.data(),
+                                   num_samples);
+
+        IMPAudioFrame stereo_frame = frame;
+        stereo_frame.virAddr = (uint32_t *) stereoBuffer.data();
+        stereo_frame.len = num_samples * 2 * sizeof(int16_t);
+        stereo_frame.soundmode = AUDIO_SOUND_MODE_STEREO;
+        process_frame(stereo_frame);
+        return;
+    }
+
     // Handle Opus frame accumulation (320 -> 960 samples) to fix timing drift
     if (global_audio[encChn]->imp_audio->format == IMPAudioFormat::OPUS && targetSamplesPerChannel > 0) {
         int samplesPerChannel = (frame.len / sizeof(int16_t)) / global_audio[encChn]->imp_audio->outChnCnt;
 
-        // If this is the first frame in the buffer, save the timestamp
         if (frameBuffer.empty()) {
-            // SINGLE SOURCE OF TRUTH: Use TimestampManager timestamp
-            bufferStartTimestamp = TimestampManager::getInstance().getTimestampUs();
             // Only log if verbose audio debugging is enabled
             if (cfg->general.audio_debug_verbose) {
                 static int accumulationLogCount = 0;
@@ -139,15 +315,26 @@ void AudioWorker::process_frame(IMPAudioFrame &frame)
         }
 
         // Drop oldest samples to keep within capacity
-        while (maxBufferSamplesPerChannel > 0 && predictedSamplesPerChannel > maxBufferSamplesPerChannel && !frameBuffer.empty()) {
-            int dropSamplesPerChannel = std::max(targetSamplesPerChannel, predictedSamplesPerChannel - maxBufferSamplesPerChannel);
-            int dropTotalSamples = dropSamplesPerChannel * outCh;
-            dropTotalSamples = std::min(dropTotalSamples, (int)frameBuffer.size());
-            frameBuffer.erase(frameBuffer.begin(), frameBuffer.begin() + dropTotalSamples);
+        int dropSamplesPerChannel = 0;
+        if (maxBufferSamplesPerChannel > 0 && predictedSamplesPerChannel > maxBufferSamplesPerChannel && !frameBuffer.empty()) {
+            dropSamplesPerChannel = std::max(targetSamplesPerChannel, predictedSamplesPerChannel - maxBufferSamplesPerChannel);
+            dropSamplesPerChannel = frameBuffer.consume(dropSamplesPerChannel * outCh) / outCh;
+            frameBufferTimeline.consume(dropSamplesPerChannel);
+        }
+
+        // The ring is sized for cap + one frame; anything beyond that would not fit
+        // and is dropped from the oldest end of the incoming frame instead.
+        int overflowSamples = std::max(0, totalSamples - (int)frameBuffer.space());
+        if (overflowSamples > 0) {
+            frameBuffer.clear();
+            frameBufferTimeline.clear();
+            overflowSamples = std::max(0, totalSamples - (int)frameBuffer.capacity());
+            dropSamplesPerChannel = currentSamplesPerChannel + overflowSamples / outCh;
+        }
+
+        if (dropSamplesPerChannel > 0) {
             predictedSamplesPerChannel -= dropSamplesPerChannel;
             bufferDropCount.fetch_add(1);
-            // Advance buffer start PTS accordingly
-            bufferStartTimestamp += (int64_t) ( (dropSamplesPerChannel * 1000000LL) / global_audio[encChn]->imp_audio->sample_rate );
             // Expose metrics via RTSPStatus
             {
                 std::string streamName = std::string("audio") + std::to_string(encChn);
@@ -157,23 +344,26 @@ void AudioWorker::process_frame(IMPAudioFrame &frame)
             LOG_WARN("AudioWorker dropped " << dropSamplesPerChannel << " samples/ch to bound buffer");
         }
 
-        // Add samples to buffer
-        frameBuffer.insert(frameBuffer.end(), samples, samples + totalSamples);
+        // Add samples to buffer; skipped leading samples move the anchor
+        frameBuffer.push(samples + overflowSamples, totalSamples - overflowSamples);
+        frameBufferTimeline.push(frame.timeStamp + (int64_t) (overflowSamples / outCh) * 1000000LL
+                                                       / global_audio[encChn]->imp_audio->sample_rate,
+                                 (totalSamples - overflowSamples) / outCh);
 
         currentSamplesPerChannel = frameBuffer.size() / outCh;
 
         // Check if we have enough samples for a complete Opus frame
         // CRITICAL FIX: Use while loop to process multiple accumulated frames
         while (currentSamplesPerChannel >= targetSamplesPerChannel) {
-            // Create a new frame with exactly the right number of samples
-            int targetTotalSamples = targetSamplesPerChannel * global_audio[encChn]->imp_audio->outChnCnt;
+            // Hand the encoder a contiguous view straight out of the ring
+            int targetTotalSamples = targetSamplesPerChannel * outCh;
             int targetBytes = targetTotalSamples * sizeof(int16_t);
 
             IMPAudioFrame opusFrame = frame;
-            opusFrame.virAddr = (uint32_t*)frameBuffer.data();
+            opusFrame.virAddr = (uint32_t*)frameBuffer.peek();
             opusFrame.len = targetBytes;
-            // Keep original timestamp - the monotonic PTS will be applied in process_audio_frame_direct
-            opusFrame.timeStamp = bufferStartTimestamp;
+            // Capture time of the packet's first sample
+            opusFrame.timeStamp = frameBufferTimeline.front();
 
             // Only log if verbose audio debugging is enabled
             if (cfg->general.audio_debug_verbose) {
@@ -185,86 +375,38 @@ void AudioWorker::process_frame(IMPAudioFrame &frame)
                 }
             }
 
-            // Analyze raw PCM data for corruption patterns
-            static int analysis_count = 0;
-            if (analysis_count < 5) {
-                int16_t *samples = (int16_t*)frameBuffer.data();
-                int16_t min_val = samples[0], max_val = samples[0];
-                int zero_count = 0, clip_count = 0;
-
-                for (int i = 0; i < targetTotalSamples; i++) {
-                    if (samples[i] == 0) zero_count++;
-                    if (samples[i] >= 32767 || samples[i] <= -32768) clip_count++;
-                    if (samples[i] < min_val) min_val = samples[i];
-                    if (samples[i] > max_val) max_val = samples[i];
-                }
-
-                LOG_DEBUG("Raw PCM analysis " << analysis_count << ": min=" << min_val
-                         << ", max=" << max_val << ", zeros=" << zero_count
-                         << ", clipped=" << clip_count << "/" << targetTotalSamples);
-                analysis_count++;
-            }
-
-            // Process the accumulated frame
-            process_audio_frame_direct(opusFrame);
-
-            // Remove processed samples from buffer
-            frameBuffer.erase(frameBuffer.begin(), frameBuffer.begin() + targetTotalSamples);
+            // Hand the accumulated frame to the encode stage
+            enqueue_frame(opusFrame);
 
-            // Update timestamp for next frame
-            bufferStartTimestamp += (targetSamplesPerChannel * 1000000LL) / global_audio[encChn]->imp_audio->sample_rate;
+            // Release processed samples from the ring
+            frameBuffer.consume(targetTotalSamples);
+            frameBufferTimeline.consume(targetSamplesPerChannel);
 
             // Recalculate remaining samples for next iteration
-            currentSamplesPerChannel = frameBuffer.size() / global_audio[encChn]->imp_audio->outChnCnt;
+            currentSamplesPerChannel = frameBuffer.size() / outCh;
         }
 
         return; // Don't process the original frame
     }
 
-    if (global_audio[encChn]->imp_audio->outChnCnt == 2 && frame.soundmode == AUDIO_SOUND_MODE_MONO)
-    {
-        size_t sample_size = frame.bitwidth / 8;
-        size_t num_samples = frame.len / sample_size;
-        size_t stereo_size = frame.len * 2;
-        uint8_t *stereo_buffer = new uint8_t[stereo_size];
-
-        for (size_t i = 0; i < num_samples; i++)
-        {
-            uint8_t *mono_sample = ((uint8_t *) frame.virAddr) + (i * sample_size);
-            uint8_t *stereo_left = stereo_buffer + (i * sample_size * 2);
-            uint8_t *stereo_right = stereo_left + sample_size;
-            memcpy(stereo_left, mono_sample, sample_size);
-            memcpy(stereo_right, mono_sample, sample_size);
-        }
-
-        IMPAudioFrame stereo_frame = frame;
-        stereo_frame.virAddr = (uint32_t *) stereo_buffer;
-        stereo_frame.len = stereo_size;
-        stereo_frame.soundmode = AUDIO_SOUND_MODE_STEREO;
-
-        process_audio_frame_direct(stereo_frame);
-        delete[] stereo_buffer;
-    }
-    else
-    {
-        process_audio_frame_direct(frame);
-    }
+    enqueue_frame(frame);
 }
 
 void AudioWorker::run()
 {
     LOG_DEBUG("Start audio processing run loop for channel " << encChn);
 
-    // Using global TimestampManager for unified audio/video timeline
-    LOG_DEBUG("AudioWorker using TimestampManager for unified timeline");
+    // PTS comes from the hardware capture timestamps, shared with video
+    LOG_DEBUG("AudioWorker using capture timestamps for the audio timeline");
 
     // Initialize AudioReframer only if needed, store in member variable
     if (global_audio[encChn]->imp_audio->format == IMPAudioFormat::AAC)
     {
         reframer = std::make_unique<AudioReframer>(
             global_audio[encChn]->imp_audio->sample_rate,
-            /* inputSamplesPerFrame */ global_audio[encChn]->imp_audio->sample_rate * 0.040,
+            /* inputSamplesPerFrame */ global_audio[encChn]->imp_audio->sample_rate * 0.020,
             /* outputSamplesPerFrame */ 1024);
+        reframedBuffer.resize(1024);
         LOG_DEBUG("AudioReframer created for channel " << encChn);
     }
     else
@@ -272,16 +414,22 @@ void AudioWorker::run()
         LOG_DEBUG("AudioReframer not needed or imp_audio not ready for channel " << encChn);
     }
 
+    // Size the upmix scratch once for the configured 20 ms capture period
+    if (global_audio[encChn]->imp_audio->outChnCnt == 2)
+    {
+        stereoBuffer.resize(global_audio[encChn]->imp_audio->sample_rate * 0.020 * 2);
+    }
+
     // Initialize frame accumulator for Opus
     // RFC 7587 COMPLIANCE NOTE: OPUS RTP timestamps MUST always use 48kHz clock rate
     // for signaling purposes, but the actual input sampling rate can be different
     // (8kHz, 16kHz, 24kHz, 48kHz, etc.). The frame accumulator must collect samples
     // based on the ACTUAL input sample rate, not the RTP clock rate.
-    // For 20ms frames: required_samples = actual_input_rate * 0.020
+    // required_samples = actual_input_rate * packet duration (20, 40 or 60 ms)
     if (global_audio[encChn]->imp_audio->format == IMPAudioFormat::OPUS) {
-        // Calculate samples for 20ms at the actual input sample rate
-        targetSamplesPerChannel = global_audio[encChn]->imp_audio->sample_rate * 0.020;
-        frameBuffer.clear();
+        // Capture still delivers 20ms frames; longer packets are built up here
+        targetSamplesPerChannel = global_audio[encChn]->imp_audio->sample_rate
+                                  * cfg->audio.opus_frame_duration / 1000;
         // Compute buffer bounds (configurable via cfg->audio.* if provided)
         int warnFrames = 3;
         int capFrames  = 5;
@@ -292,8 +440,13 @@ void AudioWorker::run()
         }
         warnBufferSamplesPerChannel = targetSamplesPerChannel * warnFrames;
         maxBufferSamplesPerChannel  = targetSamplesPerChannel * capFrames;
+        // Ring holds the cap plus one incoming frame; rounded up to a power of two
+        frameBuffer.reset((maxBufferSamplesPerChannel + targetSamplesPerChannel)
+                          * global_audio[encChn]->imp_audio->outChnCnt);
+        frameBufferTimeline.reset(global_audio[encChn]->imp_audio->sample_rate);
         LOG_DEBUG("Opus frame accumulator initialized: target=" << targetSamplesPerChannel
-                 << " samples per channel (20ms at " << global_audio[encChn]->imp_audio->sample_rate << "Hz), "
+                 << " samples per channel (" << cfg->audio.opus_frame_duration << "ms at "
+                 << global_audio[encChn]->imp_audio->sample_rate << "Hz), "
                  << "warn@" << warnBufferSamplesPerChannel << ", cap@" << maxBufferSamplesPerChannel);
         // Expose initial metrics and thresholds
         {
@@ -304,10 +457,30 @@ void AudioWorker::run()
         }
     }
 
+    // Preallocate the encode slots for the largest frame this format produces
+    {
+        size_t slotSamples = reframer ? 1024 : global_audio[encChn]->imp_audio->sample_rate * 0.020;
+        if (targetSamplesPerChannel > 0)
+            slotSamples = std::max<size_t>(slotSamples, targetSamplesPerChannel);
+        slotSamples *= global_audio[encChn]->imp_audio->outChnCnt;
+        for (size_t i = 0; i < encodeQueue.slotCount(); i++)
+        {
+            encodeQueue.slot(i).pcm.resize(slotSamples);
+        }
+    }
+    encodeRunning = true;
+    encodeThread = std::thread(&AudioWorker::encode_loop, this);
+
+    // Sound events need the capture running even without viewers
+    levelMeter.reset(global_audio[encChn]->imp_audio->sample_rate, 1, cfg->audio.vad_threshold);
+    soundEvents = cfg->audio.sound_events_enabled;
+    soundEventActive = false;
+
     while (global_audio[encChn]->running)
     {
-        if (global_audio[encChn]->hasDataCallback && cfg->audio.input_enabled
-            && (global_video[0]->hasDataCallback || global_video[1]->hasDataCallback))
+        bool streaming = global_audio[encChn]->hasDataCallback
+                         && (global_video[0]->hasDataCallback || global_video[1]->hasDataCallback);
+        if (cfg->audio.input_enabled && (streaming || soundEvents))
         {
             if (IMP_AI_PollingFrame(global_audio[encChn]->devId,
                                     global_audio[encChn]->aiChn,
@@ -315,6 +488,7 @@ void AudioWorker::run()
                 == 0)
             {
                 IMPAudioFrame frame;
+                auto captureStart = std::chrono::steady_clock::now();
                 if (IMP_AI_GetFrame(global_audio[encChn]->devId,
                                     global_audio[encChn]->aiChn,
                                     &frame,
@@ -325,30 +499,38 @@ void AudioWorker::run()
                                                  << global_audio[encChn]->aiChn << ") failed");
                 }
 
-                // Hardware timestamps are already monotonic (from IMP_System_RebaseTimeStamp)
-                // Use them directly - no conversion needed with 64-bit approach
-                // DeepSeek's recommendation: use hardware timestamps as-is since they're already monotonic
+                // The AI timestamp shares the IMP_System_GetTimeStamp() timebase
+                // with the video packs, so it is the frame's PTS as is
+                frame.timeStamp = TimestampManager::getInstance().captureTimestampUs(frame.timeStamp);
 
-                if (reframer)
+                measure_levels(frame);
+
+                if (!streaming)
+                {
+                    // Monitoring only, nothing to encode
+                }
+                else if (reframer)
                 {
-                    // SINGLE SOURCE OF TRUTH: Use TimestampManager timestamp
-                    uint64_t unified_timestamp = TimestampManager::getInstance().getTimestampUs();
-                    reframer->addFrame(reinterpret_cast<uint8_t *>(frame.virAddr), unified_timestamp);
-                    while (reframer->hasMoreFrames())
+                    if (!reframer->addFrame(reinterpret_cast<const int16_t *>(frame.virAddr), frame.timeStamp))
                     {
-                        size_t frameLen = 1024 * sizeof(uint16_t)
-                                          * global_audio[encChn]->imp_audio->outChnCnt;
-                        std::vector<uint8_t> frameData(frameLen, 0);
-                        int64_t audio_ts;
-                        reframer->getReframedFrame(frameData.data(), audio_ts);
+                        bufferDropCount.fetch_add(1);
+                        RTSPStatus::writeCustomParameter(std::string("audio") + std::to_string(encChn),
+                                                         "buffer_drop_count",
+                                                         std::to_string(bufferDropCount.load()));
+                        LOG_WARN("AudioReframer full, dropped capture frame");
+                    }
+                    int64_t audio_ts;
+                    while (reframer->getReframedFrame(reframedBuffer.data(), audio_ts))
+                    {
+                        // Reframed data is still mono, process_frame() upmixes if needed
                         IMPAudioFrame reframed = {.bitwidth = frame.bitwidth,
                                                   .soundmode = frame.soundmode,
                                                   .virAddr = reinterpret_cast<uint32_t *>(
-                                                      frameData.data()),
+                                                      reframedBuffer.data()),
                                                   .phyAddr = frame.phyAddr,
                                                   .timeStamp = audio_ts,
                                                   .seq = frame.seq,
-                                                  .len = static_cast<int>(frameLen)};
+                                                  .len = static_cast<int>(reframedBuffer.size() * sizeof(int16_t))};
                         process_frame(reframed);
                     }
                 }
@@ -366,6 +548,16 @@ void AudioWorker::run()
                                                      << global_audio[encChn]->aiChn
                                                      << ", &frame) failed");
                 }
+
+                captureTiming.add(std::chrono::duration_cast<std::chrono::microseconds>(
+                                      std::chrono::steady_clock::now() - captureStart).count());
+                if (captureTiming.count >= 250)
+                {
+                    RTSPStatus::writeCustomParameter(std::string("audio") + std::to_string(encChn),
+                                                     "encode_queue_depth",
+                                                     std::to_string(encodeQueue.depth()));
+                }
+                publish_timing("capture", captureTiming);
             }
             else
             {
@@ -384,7 +576,7 @@ void AudioWorker::run()
             */
             while ((global_audio[encChn]->onDataCallback == nullptr
                     || (!global_video[0]->hasDataCallback && !global_video[1]->hasDataCallback))
-                   && !global_restart_audio)
+                   && !soundEvents && !global_restart_audio)
             {
                 global_audio[encChn]->should_grab_frames.wait(lock_stream);
             }
@@ -399,6 +591,10 @@ void AudioWorker::run()
             usleep(250 * 1000);
         }
     }
+
+    encodeRunning = false;
+    encodeReady.release();
+    encodeThread.join();
 }
 
 void *AudioWorker::thread_entry(void *arg)
@@ -413,7 +609,8 @@ void *AudioWorker::thread_entry(void *arg)
     try {
         global_audio[encChn]->imp_audio = IMPAudio::createNew(global_audio[encChn]->devId,
                                                               global_audio[encChn]->aiChn,
-                                                              global_audio[encChn]->aeChn);
+                                                              global_audio[encChn]->aeChn,
+                                                              encChn);
         // Keep global devId in sync with actual initialized device (IMPAudio may adjust devId on some platforms)
         if (global_audio[encChn]->imp_audio && global_audio[encChn]->devId != global_audio[encChn]->imp_audio->devId) {
             LOG_INFO("AudioWorker: remapping devId from " << global_audio[encChn]->devId
@@ -1,12 +1,23 @@
 #ifndef AUDIO_WORKER_HPP
 #define AUDIO_WORKER_HPP
 
+#include "AudioLevel.hpp"
 #include "AudioReframer.hpp"
+#include "CaptureTimeline.hpp"
 #include "IMPAudio.hpp"
+#include "SampleRing.hpp"
+#include "SpscQueue.hpp"
 
+#include <algorithm>
+#include <map>
 #include <memory>
+#include <string>
 #include <vector>
 #include <atomic>
+#include <thread>
+#include <chrono>
+#include <semaphore>
+#include <sys/time.h>
 
 #if defined(AUDIO_SUPPORT)
 
@@ -19,24 +30,77 @@ public:
     static void *thread_entry(void *arg);
 
 private:
+    // One PCM frame handed from the capture stage to the encode stage
+    struct EncodeJob
+    {
+        IMPAudioFrame frame;
+        struct timeval time;
+        std::vector<int16_t> pcm;
+    };
+
+    // Running per-stage cost, published periodically through RTSPStatus
+    struct StageTiming
+    {
+        uint64_t sumUs = 0;
+        uint32_t maxUs = 0;
+        uint32_t count = 0;
+
+        void add(uint32_t us)
+        {
+            sumUs += us;
+            maxUs = std::max(maxUs, us);
+            count++;
+        }
+        void reset() { *this = StageTiming{}; }
+    };
+
     void run();
-    void process_audio_frame_direct(IMPAudioFrame &frame);
+    void encode_loop();
+    void enqueue_frame(IMPAudioFrame &frame);
+    void process_audio_frame_direct(IMPAudioFrame &frame, const struct timeval &time);
     void process_frame(IMPAudioFrame &frame);
+    void publish_timing(const char *stage, StageTiming &timing);
+    void measure_levels(const IMPAudioFrame &frame);
+    void publish_level(const std::string &parameter, float dbfs);
 
     int encChn;
     std::unique_ptr<AudioReframer> reframer;
+    std::vector<int16_t> reframedBuffer;
 
     // Frame accumulator for Opus
-    std::vector<int16_t> frameBuffer;
-    int64_t bufferStartTimestamp = 0;
+    SampleRing<int16_t> frameBuffer;
+    CaptureTimeline frameBufferTimeline;
     int targetSamplesPerChannel = 0;
 
     // Buffer safety controls (computed from targetSamplesPerChannel)
     int maxBufferSamplesPerChannel = 0;     // e.g., 5 * targetSamplesPerChannel
     int warnBufferSamplesPerChannel = 0;    // e.g., 3 * targetSamplesPerChannel
 
+    // Preallocated scratch for mono -> stereo upmix (force_stereo)
+    std::vector<int16_t> stereoBuffer;
+
+    // Capture -> encode pipeline. The encode stage owns the IMP_AENC call chain
+    // (and thereby the software Opus/FAAC encoders) so a slow encode no longer
+    // delays IMP_AI_GetFrame.
+    SpscQueue<EncodeJob> encodeQueue{8};
+    std::counting_semaphore<64> encodeReady{0};
+    std::atomic<bool> encodeRunning{false};
+    std::thread encodeThread;
+    StageTiming captureTiming;
+    StageTiming encodeTiming;
+
+    // Always-on level meter / VAD on the raw capture
+    AudioLevelMeter levelMeter;
+    bool soundEvents = false;
+    bool soundEventActive = false;
+    std::chrono::steady_clock::time_point lastSoundEvent{};
+    // Level files last written, see measure_levels()
+    std::chrono::steady_clock::time_point lastLevelPublish{};
+    std::map<std::string, std::string> publishedLevels;
+
     // Diagnostics / metrics
     std::atomic<uint32_t> bufferDropCount{0};
+    std::atomic<uint32_t> encodeQueueDropCount{0};
 };
 
 #endif // AUDIO_SUPPORT
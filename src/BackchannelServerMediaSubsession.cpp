@@ -69,13 +69,26 @@ char const *BackchannelServerMediaSubsession::sdpLines(int /*addressFamily*/)
                 frequency);
             fmtpLine = fmtpBuf;
         }
+        else if (fFormat == IMPBackchannelFormat::OPUS)
+        {
+            // RFC 7587: always opus/48000/2; maxplaybackrate lets the client
+            // skip bandwidth the speaker cannot reproduce
+            char fmtpBuf[150];
+            snprintf(fmtpBuf,
+                     sizeof(fmtpBuf),
+                     "a=fmtp:%d maxplaybackrate=%d;stereo=0;useinbandfec=1\r\n",
+                     payloadType,
+                     cfg->audio.output_sample_rate);
+            fmtpLine = fmtpBuf;
+        }
+        unsigned channels = (fFormat == IMPBackchannelFormat::OPUS) ? 2 : 1;
 
         snprintf(fSDPLines,
                  sdpLinesSize,
                  "m=audio 0 RTP/AVP %d\r\n"
                  "c=IN IP4 0.0.0.0\r\n"
                  "b=AS:%u\r\n"
-                 "a=rtpmap:%d %s/%u/1\r\n"
+                 "a=rtpmap:%d %s/%u/%u\r\n"
                  "%s"
                  "a=control:%s\r\n"
                  "a=sendonly\r\n",
@@ -84,6 +97,7 @@ char const *BackchannelServerMediaSubsession::sdpLines(int /*addressFamily*/)
                  payloadType,
                  formatName,
                  frequency,
+                 channels,
                  fmtpLine.c_str(),
                  trackId());
 
@@ -387,6 +401,10 @@ int BackchannelServerMediaSubsession::estimatedBitrate()
     {
         return cfg->audio.output_sample_rate / 667;
     }
+    if (fFormat == IMPBackchannelFormat::OPUS)
+    {
+        return 32;
+    }
     return 64;
 }
 
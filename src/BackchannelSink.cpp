@@ -19,7 +19,7 @@ BackchannelSink::BackchannelSink(UsageEnvironment &env,
                                  IMPBackchannelFormat format)
     : MediaSink(env)
     , fRTPSource(nullptr)
-    , fReceiveBufferSize((format == IMPBackchannelFormat::AAC) ? 2048 : 1024)
+    , fReceiveBufferSize((format == IMPBackchannelFormat::AAC || format == IMPBackchannelFormat::OPUS) ? 2048 : 1024)
     , fIsActive(false)
     , fAfterFunc(nullptr)
     , fAfterClientData(nullptr)
@@ -140,7 +140,16 @@ void BackchannelSink::afterGettingFrame1(unsigned frameSize,
     }
     else if (frameSize > 0)
     {
-        sendBackchannelFrame(fReceiveBuffer, frameSize);
+        BackchannelFrame bcFrame;
+        if (fRTPSource->isRTPSource())
+        {
+            RTPSource *rtpSource = static_cast<RTPSource *>(fRTPSource);
+            bcFrame.hasRtpInfo = true;
+            bcFrame.rtpSeq = rtpSource->curPacketRTPSeqNum();
+            bcFrame.rtpTimestamp = rtpSource->curPacketRTPTimestamp();
+        }
+        bcFrame.payload.assign(fReceiveBuffer, fReceiveBuffer + frameSize);
+        sendBackchannelFrame(std::move(bcFrame));
     }
 
     // Reschedule the timeout check after receiving any frame (even size 0 or
@@ -185,7 +194,7 @@ void BackchannelSink::timeoutCheck1()
     sendBackchannelStopFrame();
 }
 
-void BackchannelSink::sendBackchannelFrame(const uint8_t *payload, unsigned payloadSize)
+void BackchannelSink::sendBackchannelFrame(BackchannelFrame &&bcFrame)
 {
     if (!global_backchannel)
     {
@@ -200,10 +209,8 @@ void BackchannelSink::sendBackchannelFrame(const uint8_t *payload, unsigned payl
         global_backchannel->is_sending.fetch_add(1, std::memory_order_relaxed);
     }
 
-    BackchannelFrame bcFrame;
     bcFrame.format = fFormat;
     bcFrame.clientSessionId = fClientSessionId;
-    bcFrame.payload.assign(payload, payload + payloadSize);
 
     if (!global_backchannel->inputQueue->write(std::move(bcFrame)))
     {
@@ -6,6 +6,7 @@
 
 #include "IMPBackchannel.hpp"
 #include "Logger.hpp"
+#include "globals.hpp"
 
 #include <cstdint>
 #include <liveMedia.hh>
@@ -42,7 +43,7 @@ private:
                             unsigned numTruncatedBytes,
                             struct timeval presentationTime);
 
-    void sendBackchannelFrame(const uint8_t *payload, unsigned payloadSize);
+    void sendBackchannelFrame(BackchannelFrame &&bcFrame);
     void sendBackchannelStopFrame();
 
     FramedSource *fRTPSource;
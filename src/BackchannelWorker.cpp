@@ -2,9 +2,11 @@
 
 #include "IMPBackchannel.hpp"
 #include "Logger.hpp"
+#include "PcmMixer.hpp"
+#include "RTSPStatus.hpp"
 
-#include <cassert>
-#include <cmath>
+#include <algorithm>
+#include <cstring>
 #include <vector>
 
 #include <fcntl.h>
@@ -13,9 +15,11 @@
 
 #define MODULE "BackchannelWorker"
 
+// Length of one mixed output block
+#define MIX_BLOCK_MS 20
+
 BackchannelWorker::BackchannelWorker()
-    : currentSessionId(0)
-    , fPipe(nullptr)
+    : fPipe(nullptr)
     , fPipeFd(-1)
 {}
 
@@ -24,46 +28,296 @@ BackchannelWorker::~BackchannelWorker()
     closePipe();
 }
 
-std::vector<int16_t> BackchannelWorker::resampleLinear(const std::vector<int16_t> &input_pcm,
-                                                       int input_rate,
-                                                       int output_rate)
+bool BackchannelWorker::openOutput()
 {
-    assert(input_rate != output_rate);
+    if (audioOutput)
+    {
+        // Already enabled at thread start, nothing to spawn
+        return audioOutput->isReady();
+    }
+    return initPipe();
+}
 
-    double ratio = static_cast<double>(output_rate) / input_rate;
-    size_t output_size = static_cast<size_t>(
-        std::max(1.0, std::round(static_cast<double>(input_pcm.size()) * ratio)));
+void BackchannelWorker::closeOutput()
+{
+    if (audioOutput)
+    {
+        audioOutput->flush();
+        RTSPStatus::writeCustomParameter("backchannel", "ao_underrun_count",
+                                         std::to_string(audioOutput->underruns()));
+        return;
+    }
+    closePipe();
+}
 
-    std::vector<int16_t> output_pcm(output_size);
-    size_t input_size = input_pcm.size();
+bool BackchannelWorker::isOutputOpen() const
+{
+    return audioOutput ? audioOutput->isReady() : fPipe != nullptr;
+}
 
-    for (size_t i = 0; i < output_size; ++i)
+bool BackchannelWorker::writePcm(const std::vector<int16_t> &pcmBuffer)
+{
+    return audioOutput ? audioOutput->write(pcmBuffer.data(), pcmBuffer.size())
+                       : writePcmToPipe(pcmBuffer);
+}
+
+BackchannelWorker::TalkSession *BackchannelWorker::findSession(unsigned int sessionId)
+{
+    for (auto &session : sessions)
     {
-        double input_pos = static_cast<double>(i) / ratio;
-        size_t index1 = static_cast<size_t>(input_pos);
+        if (session->id == sessionId)
+            return session.get();
+    }
+    return nullptr;
+}
 
-        if (index1 >= input_size)
+BackchannelWorker::TalkSession *BackchannelWorker::addSession(unsigned int sessionId,
+                                                              IMPBackchannelFormat format)
+{
+    auto session = std::make_unique<TalkSession>();
+    session->id = sessionId;
+    session->format = format;
+    session->startTime = std::chrono::steady_clock::now();
+
+    session->jitterEnabled = cfg->audio.output_jitter_delay > 0;
+    session->jitterBuffer.configure(IMPBackchannel::getFormatFrequency(format),
+                                    cfg->audio.output_jitter_delay,
+                                    cfg->audio.output_jitter_max_delay);
+
+    session->pcmRate = IMPBackchannel::getFormatFrequency(format);
+    if (format == IMPBackchannelFormat::OPUS)
+    {
+        // libopus decodes straight to any of its native rates, which saves
+        // the resampler for every output rate but 44.1 kHz
+        int rate = cfg->audio.output_sample_rate;
+        if (rate != 8000 && rate != 12000 && rate != 16000 && rate != 24000 && rate != 48000)
+            rate = 48000;
+
+        int error;
+        session->opusDecoder = opus_decoder_create(rate, 1, &error);
+        if (error != OPUS_OK)
         {
-            index1 = input_size - 1;
+            LOG_ERROR("Failed to create Opus decoder for session " << sessionId << ": " << opus_strerror(error));
+            session->opusDecoder = nullptr;
         }
+        session->pcmRate = rate;
+    }
 
-        int16_t sample1 = input_pcm[index1];
-        int16_t sample2 = (index1 + 1 < input_size) ? input_pcm[index1 + 1] : sample1;
+    if (session->pcmRate != cfg->audio.output_sample_rate)
+    {
+        LOG_DEBUG("Resampling " << session->pcmRate << " Hz -> " << cfg->audio.output_sample_rate << " Hz");
+        session->resampler.configure(session->pcmRate, cfg->audio.output_sample_rate);
+    }
+    session->pcm.reserve(mixSamples * 4);
 
-        double factor = input_pos - static_cast<double>(index1);
+    if (sessions.empty())
+    {
+        // First talker starts the mix clock
+        mixNext = session->startTime;
+        lastJitterStats = session->startTime;
+    }
 
-        double interpolated_sample = static_cast<double>(sample1) * (1.0 - factor)
-                                     + static_cast<double>(sample2) * factor;
+    sessions.push_back(std::move(session));
+    RTSPStatus::writeCustomParameter("backchannel", "talkers", std::to_string(sessions.size()));
+    return sessions.back().get();
+}
 
-        if (interpolated_sample > INT16_MAX)
-            interpolated_sample = INT16_MAX;
-        if (interpolated_sample < INT16_MIN)
-            interpolated_sample = INT16_MIN;
+void BackchannelWorker::handleFrame(BackchannelFrame &frame)
+{
+    TalkSession *session = findSession(frame.clientSessionId);
 
-        output_pcm[i] = static_cast<int16_t>(interpolated_sample);
+    // Zero-payload frame: the sink stopped or timed out
+    if (frame.payload.empty())
+    {
+        if (session == nullptr)
+        {
+            LOG_DEBUG("Stop signal from unknown session " << frame.clientSessionId << ". Ignoring.");
+            return;
+        }
+
+        LOG_INFO("Session " << session->id << " stopped.");
+        // The sender has stopped, there is nothing left to wait for
+        while (session->jitterBuffer.drain(playoutPayload))
+        {
+            decodeInto(*session, playoutPayload);
+        }
+        session->stopping = true;
+        return;
     }
 
-    return output_pcm;
+    if (session == nullptr)
+    {
+        if (sessions.size() >= MAX_TALKERS)
+        {
+            LOG_DEBUG("Discarding frame from session " << frame.clientSessionId << ", "
+                                                       << MAX_TALKERS << " talkers already mixed");
+            return;
+        }
+
+        if (IMPBackchannel::hasStatefulDecoder(frame.format)
+            && std::any_of(sessions.begin(), sessions.end(), [&](const std::unique_ptr<TalkSession> &other) {
+                   return other->format == frame.format;
+               }))
+        {
+            // Interleaving two streams through one decoder would mix each
+            // one's overlap tail into the other's next frame
+            if (frame.clientSessionId != refusedSessionId)
+            {
+                refusedSessionId = frame.clientSessionId;
+                LOG_WARN("Refusing session " << frame.clientSessionId << ": another session is already talking "
+                                             << IMPBackchannel::getFormatName(frame.format)
+                                             << ", which has a single stateful decoder");
+            }
+            return;
+        }
+
+        if (!isOutputOpen() && !openOutput())
+        {
+            LOG_ERROR("Failed to open output for new session " << frame.clientSessionId);
+            return;
+        }
+
+        session = addSession(frame.clientSessionId, frame.format);
+        LOG_INFO("New session " << session->id << " playing "
+                                << IMPBackchannel::getFormatName(frame.format) << " ("
+                                << sessions.size() << " talking)");
+    }
+    else if (session->stopping)
+    {
+        // Data resumed after an inactivity timeout
+        session->stopping = false;
+    }
+
+    if (!cfg->audio.output_enabled)
+    {
+        return;
+    }
+
+    if (session->jitterEnabled && frame.hasRtpInfo)
+    {
+        session->jitterBuffer.push(frame.rtpSeq, frame.rtpTimestamp, frame.payload,
+                                   std::chrono::steady_clock::now());
+    }
+    else
+    {
+        decodeInto(*session, frame.payload);
+    }
+}
+
+bool BackchannelWorker::mixAndPlay()
+{
+    const auto blockDuration = std::chrono::milliseconds(MIX_BLOCK_MS);
+    auto now = std::chrono::steady_clock::now();
+
+    // Writing blocked for a while (or the thread was starved): catch up
+    // instead of bursting out everything that was missed
+    if (now - mixNext > 5 * blockDuration)
+        mixNext = now;
+
+    // Pull what becomes due within the next block, so a talker whose packets
+    // land just after a tick is not cut into the following one
+    auto horizon = now + blockDuration;
+    for (auto &session : sessions)
+    {
+        JitterBuffer::Result result;
+        while ((result = session->jitterBuffer.pop(horizon, playoutPayload)) != JitterBuffer::Result::None)
+        {
+            if (result == JitterBuffer::Result::Packet)
+                decodeInto(*session, playoutPayload);
+            else
+                concealInto(*session);
+        }
+    }
+
+    std::fill(mixBuffer.begin(), mixBuffer.end(), 0);
+    bool audible = false;
+    for (auto &session : sessions)
+    {
+        size_t n = std::min(session->pending(), mixSamples);
+        if (n == 0)
+            continue;
+
+        PcmMixer::addSaturate16(mixBuffer.data(), session->pcm.data() + session->pcmRead, n);
+        session->pcmRead += n;
+        audible = true;
+
+        if (session->pcmRead == session->pcm.size())
+        {
+            session->pcm.clear();
+            session->pcmRead = 0;
+        }
+
+        if (session->starting)
+        {
+            session->starting = false;
+            auto latencyUs = std::chrono::duration_cast<std::chrono::microseconds>(now - session->startTime).count();
+            LOG_INFO("Session " << session->id << " audible after " << latencyUs << "us ("
+                                << (audioOutput ? "AO" : "pipe") << ")");
+            RTSPStatus::writeCustomParameter("backchannel", "session_start_latency_us", std::to_string(latencyUs));
+        }
+    }
+    mixNext += blockDuration;
+
+    publishJitterStats(false);
+
+    // Drop sessions that have stopped and played out
+    size_t before = sessions.size();
+    sessions.erase(std::remove_if(sessions.begin(), sessions.end(),
+                                  [](const std::unique_ptr<TalkSession> &session) {
+                                      return session->stopping && session->jitterBuffer.empty()
+                                             && session->pending() == 0;
+                                  }),
+                   sessions.end());
+    if (sessions.size() != before)
+    {
+        RTSPStatus::writeCustomParameter("backchannel", "talkers", std::to_string(sessions.size()));
+    }
+
+    if (audible && !writePcm(mixBuffer))
+    {
+        return false;
+    }
+
+    if (sessions.empty())
+    {
+        LOG_INFO("No session talking. Closing output.");
+        publishJitterStats(true);
+        closeOutput();
+    }
+    return true;
+}
+
+void BackchannelWorker::publishJitterStats(bool force)
+{
+    auto now = std::chrono::steady_clock::now();
+    if (!force && now - lastJitterStats < std::chrono::seconds(1))
+        return;
+    lastJitterStats = now;
+
+    // Worst depth and jitter, counters summed over the talkers
+    unsigned depthMs = 0, jitterMs = 0;
+    JitterBuffer::Stats total;
+    for (auto &session : sessions)
+    {
+        if (!session->jitterEnabled)
+            continue;
+        const JitterBuffer::Stats &stats = session->jitterBuffer.stats();
+        depthMs = std::max(depthMs, session->jitterBuffer.depthMs());
+        jitterMs = std::max(jitterMs, session->jitterBuffer.jitterMs());
+        total.lost += stats.lost;
+        total.late += stats.late;
+        total.reordered += stats.reordered;
+        total.overflow += stats.overflow;
+        total.underruns += stats.underruns;
+    }
+
+    RTSPStatus::writeCustomParameter("backchannel", "jitter_depth_ms", std::to_string(depthMs));
+    RTSPStatus::writeCustomParameter("backchannel", "jitter_ms", std::to_string(jitterMs));
+    RTSPStatus::writeCustomParameter("backchannel", "jitter_lost_count", std::to_string(total.lost));
+    RTSPStatus::writeCustomParameter("backchannel", "jitter_late_count", std::to_string(total.late));
+    RTSPStatus::writeCustomParameter("backchannel", "jitter_reordered_count", std::to_string(total.reordered));
+    RTSPStatus::writeCustomParameter("backchannel", "jitter_overflow_count", std::to_string(total.overflow));
+    RTSPStatus::writeCustomParameter("backchannel", "jitter_underrun_count", std::to_string(total.underruns));
 }
 
 bool BackchannelWorker::initPipe()
@@ -139,11 +393,41 @@ void BackchannelWorker::closePipe()
     }
 }
 
-bool BackchannelWorker::decodeFrame(const uint8_t *payload,
+bool BackchannelWorker::decodeFrame(TalkSession &session,
+                                    const uint8_t *payload,
                                     size_t payloadSize,
-                                    IMPBackchannelFormat format,
                                     std::vector<int16_t> &outPcmBuffer)
 {
+    if (session.format == IMPBackchannelFormat::OPUS)
+    {
+        if (!session.opusDecoder)
+        {
+            return false;
+        }
+
+        // Size the output from the TOC, 2.5 to 120 ms per packet. The buffer
+        // has capacity for the largest packet, so this never allocates.
+        int samples = opus_decoder_get_nb_samples(session.opusDecoder, payload, (opus_int32) payloadSize);
+        if (samples <= 0)
+        {
+            LOG_WARN("Invalid Opus packet (" << payloadSize << " bytes) from session " << session.id);
+            return false;
+        }
+        outPcmBuffer.resize(samples);
+
+        int ret = opus_decode(session.opusDecoder, payload, (opus_int32) payloadSize,
+                              outPcmBuffer.data(), samples, 0);
+        if (ret < 0)
+        {
+            LOG_ERROR("opus_decode failed for session " << session.id << ": " << opus_strerror(ret));
+            return false;
+        }
+        outPcmBuffer.resize(ret);
+        session.opusFrameSamples = ret;
+        return true;
+    }
+
+    IMPBackchannelFormat format = session.format;
     IMPAudioStream stream_in;
     stream_in.stream = const_cast<uint8_t *>(payload);
     stream_in.len = static_cast<int>(payloadSize);
@@ -216,6 +500,7 @@ bool BackchannelWorker::writePcmToPipe(const std::vector<int16_t> &pcmBuffer)
         if (saved_errno == EAGAIN || saved_errno == EWOULDBLOCK)
         {
             LOG_WARN("Pipe clogged (EAGAIN/EWOULDBLOCK). Discarding PCM chunk.");
+            RTSPStatus::writeCustomParameter("backchannel", "pipe_drop_count", std::to_string(++pipeDropCount));
             return true;
         }
         else if (saved_errno == EPIPE)
@@ -237,49 +522,92 @@ bool BackchannelWorker::writePcmToPipe(const std::vector<int16_t> &pcmBuffer)
     return true;
 }
 
-bool BackchannelWorker::processFrame(const BackchannelFrame &frame)
+void BackchannelWorker::decodeInto(TalkSession &session, const std::vector<uint8_t> &payload)
 {
-    if (!cfg->audio.output_enabled)
-    {
-        return true;
-    }
-
-    std::vector<int16_t> decoded_pcm;
-    if (!decodeFrame(frame.payload.data(), frame.payload.size(), frame.format, decoded_pcm))
+    if (!decodeFrame(session, payload.data(), payload.size(), decodedPcm))
     {
         // Error already logged in decodeFrame
-        return true; // Continue processing loop, maybe next frame works
+        return;
     }
 
-    if (decoded_pcm.empty())
+    if (decodedPcm.empty())
     {
         LOG_WARN("decodeFrame returned empty PCM buffer.");
-        return true; // Nothing to process
+        return;
     }
 
-    // Resample only if necessary
-    int input_rate = IMPBackchannel::getFormatFrequency(frame.format);
-    int target_rate = cfg->audio.output_sample_rate;
-    const std::vector<int16_t> *buffer_to_write = &decoded_pcm;
-    std::vector<int16_t> resampled_pcm;
-
-    if (input_rate != target_rate)
+    if (!session.opusDecoder)
     {
-        resampled_pcm = resampleLinear(decoded_pcm, input_rate, target_rate);
-        buffer_to_write = &resampled_pcm;
+        session.plcPcm.assign(decodedPcm.begin(), decodedPcm.end());
+        session.plcCount = 0;
     }
 
-    // Write the final mono PCM to the pipe
-    if (buffer_to_write != nullptr && !buffer_to_write->empty())
+    appendPcm(session, decodedPcm);
+}
+
+void BackchannelWorker::concealInto(TalkSession &session)
+{
+    if (session.opusDecoder)
     {
-        if (!writePcmToPipe(*buffer_to_write))
+        // libopus extrapolates from its own state, better than a replay
+        if (session.opusFrameSamples == 0)
+            return;
+        decodedPcm.resize(session.opusFrameSamples);
+        int ret = opus_decode(session.opusDecoder, nullptr, 0, decodedPcm.data(), session.opusFrameSamples, 0);
+        if (ret > 0)
         {
-            // Error writing to pipe, likely closed. Stop processing loop.
-            return false;
+            decodedPcm.resize(ret);
+            appendPcm(session, decodedPcm);
         }
+        return;
     }
 
-    return true;
+    if (session.plcPcm.empty())
+    {
+        return;
+    }
+
+    // Replay the last good frame, halving its level with every consecutive
+    // loss. The gain ramps across the frame so the edges do not click.
+    size_t n = session.plcPcm.size();
+    int32_t from = 32768 >> std::min(session.plcCount, 15u);
+    int32_t to = 32768 >> std::min(session.plcCount + 1, 15u);
+    decodedPcm.resize(n);
+    for (size_t i = 0; i < n; i++)
+    {
+        int32_t gain = from + (int32_t) ((int64_t) (to - from) * (int64_t) i / (int64_t) n);
+        decodedPcm[i] = (int16_t) (((int32_t) session.plcPcm[i] * gain) >> 15);
+    }
+    session.plcCount++;
+
+    appendPcm(session, decodedPcm);
+}
+
+void BackchannelWorker::appendPcm(TalkSession &session, const std::vector<int16_t> &pcm)
+{
+    // Resample only if necessary
+    const std::vector<int16_t> *converted = &pcm;
+    if (session.resampler.inputRate() != 0)
+    {
+        converted = &session.resampler.process(pcm.data(), pcm.size());
+    }
+
+    // Without a jitter buffer nothing paces the sender; keep at most the
+    // configured maximum delay queued for mixing
+    size_t limit = (size_t) cfg->audio.output_sample_rate * cfg->audio.output_jitter_max_delay / 1000;
+    if (session.pending() + converted->size() > limit && session.pending() > 0)
+    {
+        size_t drop = std::min(session.pending(), session.pending() + converted->size() - limit);
+        session.pcmRead += drop;
+    }
+
+    // Compact before growing, the buffer then stays at its steady state size
+    if (session.pcmRead > 0)
+    {
+        session.pcm.erase(session.pcm.begin(), session.pcm.begin() + session.pcmRead);
+        session.pcmRead = 0;
+    }
+    session.pcm.insert(session.pcm.end(), converted->begin(), converted->end());
 }
 
 void BackchannelWorker::run()
@@ -292,15 +620,35 @@ void BackchannelWorker::run()
 
     LOG_INFO("Processor thread running...");
 
+    // Open the speaker once for the lifetime of the thread; sessions then
+    // start without forking /bin/iac. Fall back to the pipe if AO is busy
+    // (e.g. owned by an audio daemon) or disabled.
+    if (cfg->audio.output_direct)
+    {
+        audioOutput.reset(IMPAudioOutput::createNew(0, 0, cfg->audio.output_sample_rate));
+        if (audioOutput->init() != 0)
+        {
+            LOG_WARN("IMP audio output unavailable, falling back to /bin/iac pipe");
+            audioOutput.reset();
+        }
+    }
+
+    mixSamples = (size_t) cfg->audio.output_sample_rate * MIX_BLOCK_MS / 1000;
+    mixBuffer.assign(mixSamples, 0);
+    // Largest decoded frame: a 120 ms Opus packet at 48 kHz
+    decodedPcm.reserve(48000 * 120 / 1000);
+
     global_backchannel->running = true;
     while (global_backchannel->running)
     {
-        // Wait for condition: running and at least one sink is sending
+        // Wait for condition: running and at least one sink is sending, or
+        // sessions still have audio to play out
         {
             std::unique_lock<std::mutex> lock(global_backchannel->mutex);
             global_backchannel->should_grab_frames.wait(lock, [&] {
                 return !global_backchannel->running
-                       || global_backchannel->is_sending.load(std::memory_order_acquire) > 0;
+                       || global_backchannel->is_sending.load(std::memory_order_acquire) > 0
+                       || !sessions.empty();
             });
         }
 
@@ -309,93 +657,55 @@ void BackchannelWorker::run()
             break;
         }
 
-        BackchannelFrame frame = global_backchannel->inputQueue->wait_read();
+        // While anyone is talking, wake up for the next mix block even if
+        // nothing new arrives
+        BackchannelFrame frame;
+        bool haveFrame = true;
+        if (!sessions.empty())
+        {
+            haveFrame = global_backchannel->inputQueue->wait_read_until(&frame, mixNext);
+        }
+        else
+        {
+            frame = global_backchannel->inputQueue->wait_read();
+        }
 
         if (!global_backchannel->running)
         {
             break;
         }
 
-        // Handle Zero-Payload Frame (Stop Signal)
-        if (frame.payload.empty())
+        if (haveFrame)
         {
-            LOG_DEBUG("Received stop signal (zero-payload) from session " << frame.clientSessionId);
-            if (frame.clientSessionId == currentSessionId && currentSessionId != 0)
-            {
-                LOG_INFO("Current session " << currentSessionId << " stopped. Closing pipe.");
-                closePipe();
-                currentSessionId = 0;
-            }
-            else if (currentSessionId == 0)
-            {
-                LOG_DEBUG("Stop signal received but no current session. Ignoring.");
-            }
-            else
-            {
-                LOG_WARN("Stop signal from non-current session "
-                         << frame.clientSessionId << " (Current: " << currentSessionId
-                         << "). Ignoring.");
-            }
-            continue;
+            handleFrame(frame);
         }
 
-        // Handle Playback Frame (Data)
-        if (currentSessionId == 0)
+        if (!sessions.empty() && std::chrono::steady_clock::now() >= mixNext)
         {
-            // No current session, this frame's sender becomes the current one
-            currentSessionId = frame.clientSessionId;
-            LOG_INFO("New current session " << currentSessionId << " playing "
-                                            << IMPBackchannel::getFormatName(frame.format)
-                                            << ". Opening pipe.");
-            if (!initPipe())
-            {
-                LOG_ERROR("Failed to open pipe for new session " << currentSessionId
-                                                                 << ". Resetting.");
-                currentSessionId = 0;
-                continue;
-            }
-            // Pipe is open
-            if (!processFrame(frame))
+            if (!isOutputOpen())
             {
-                // processFrame returns false if pipe write fails and closes pipe
-                LOG_WARN("processFrame failed for initial frame of session " << currentSessionId
-                                                                             << ". Pipe closed.");
-                currentSessionId = 0;
-            }
-        }
-        else if (frame.clientSessionId == currentSessionId)
-        {
-            // Frame is from the current session
-            if (!fPipe)
-            { // Ensure pipe is open (it might have closed unexpectedly)
-                LOG_WARN("Pipe was closed unexpectedly for current session " << currentSessionId
-                                                                             << ". Reopening.");
-                if (!initPipe())
+                // The pipe might have closed unexpectedly
+                LOG_WARN("Output was closed unexpectedly. Reopening.");
+                if (!openOutput())
                 {
-                    LOG_ERROR("Failed to reopen pipe for session " << currentSessionId
-                                                                   << ". Resetting.");
-                    currentSessionId = 0;
+                    LOG_ERROR("Failed to reopen output. Dropping " << sessions.size() << " session(s).");
+                    sessions.clear();
                     continue;
                 }
             }
-            // Pipe should be open
-            if (!processFrame(frame))
+
+            if (!mixAndPlay())
             {
-                // processFrame returns false if pipe write fails and closes pipe
-                LOG_WARN("processFrame failed for session " << currentSessionId << ". Pipe closed.");
-                currentSessionId = 0;
+                // mixAndPlay returns false if the output write fails
+                LOG_WARN("Playback failed. Output closed.");
             }
         }
-        else
-        {
-            // Frame is from a different session, ignore it
-            LOG_DEBUG("Discarding frame from non-current session "
-                      << frame.clientSessionId << " (Current: " << currentSessionId << ")");
-        }
     }
 
     LOG_INFO("Processor thread stopping.");
-    closePipe();
+    sessions.clear();
+    closeOutput();
+    audioOutput.reset();
 }
 
 void *BackchannelWorker::thread_entry(void *arg)
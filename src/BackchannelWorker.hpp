@@ -1,14 +1,22 @@
 #ifndef BACKCHANNEL_PROCESSOR_HPP
 #define BACKCHANNEL_PROCESSOR_HPP
 
-// Processes audio frames, decodes them, handles session management (who is
-// "current"), resamples, and sends PCM data to a pipe.
+// Processes audio frames, decodes them per talking session, smooths network
+// jitter, resamples, mixes all sessions into one stream and sends the PCM to
+// the speaker, either directly through IMP AO or through a pipe to /bin/iac.
 
+#include "IMPAudioOutput.hpp"
 #include "IMPBackchannel.hpp"
+#include "JitterBuffer.hpp"
+#include "Resampler.hpp"
 #include "globals.hpp"
 
+#include <chrono>
 #include <cstdint>
 #include <cstdio>
+#include <memory>
+#include <opus/opus.h>
+#include <vector>
 
 class BackchannelWorker
 {
@@ -19,27 +27,95 @@ public:
     static void *thread_entry(void *arg);
 
 private:
+    // Sessions mixed at the same time; frames from further ones are dropped
+    static constexpr size_t MAX_TALKERS = 4;
+
+    // Everything that has to be kept apart per talking client
+    struct TalkSession
+    {
+        ~TalkSession()
+        {
+            if (opusDecoder)
+                opus_decoder_destroy(opusDecoder);
+        }
+
+        unsigned int id = 0;
+        IMPBackchannelFormat format = IMPBackchannelFormat::UNKNOWN;
+        bool stopping = false; // stop frame seen, remove once played out
+
+        // Software decoder for formats the IMP ADEC cannot handle
+        OpusDecoder *opusDecoder = nullptr;
+        int opusFrameSamples = 0;
+        int pcmRate = 0; // rate of the decoded PCM
+
+        // Reorders packets and paces their playout
+        JitterBuffer jitterBuffer;
+        bool jitterEnabled = false;
+        Resampler resampler;
+
+        // Packet loss concealment: the last good frame, replayed with a fade
+        std::vector<int16_t> plcPcm;
+        unsigned plcCount = 0;
+
+        // Decoded PCM at the output rate waiting to be mixed
+        std::vector<int16_t> pcm;
+        size_t pcmRead = 0;
+
+        // First frame -> first PCM handed to the output
+        std::chrono::steady_clock::time_point startTime;
+        bool starting = true;
+
+        size_t pending() const { return pcm.size() - pcmRead; }
+    };
+
     void run();
 
-    std::vector<int16_t> resampleLinear(const std::vector<int16_t> &input_pcm,
-                                        int input_rate,
-                                        int output_rate);
+    bool openOutput();
+    void closeOutput();
+    bool isOutputOpen() const;
+    bool writePcm(const std::vector<int16_t> &pcmBuffer);
+
+    TalkSession *findSession(unsigned int sessionId);
+    TalkSession *addSession(unsigned int sessionId, IMPBackchannelFormat format);
+    void handleFrame(BackchannelFrame &frame);
+    bool mixAndPlay();
+    void publishJitterStats(bool force);
 
     bool initPipe();
     void closePipe();
 
-    bool processFrame(const BackchannelFrame &frame);
-    bool decodeFrame(const uint8_t *payload,
+    void decodeInto(TalkSession &session, const std::vector<uint8_t> &payload);
+    void concealInto(TalkSession &session);
+    void appendPcm(TalkSession &session, const std::vector<int16_t> &pcm);
+    bool decodeFrame(TalkSession &session,
+                     const uint8_t *payload,
                      size_t payloadSize,
-                     IMPBackchannelFormat format,
                      std::vector<int16_t> &outPcmBuffer);
     bool writePcmToPipe(const std::vector<int16_t> &pcmBuffer);
 
-    unsigned int currentSessionId;
+    std::vector<std::unique_ptr<TalkSession>> sessions;
+
+    // Mix clock: one block of output every 20 ms while anyone is talking
+    std::chrono::steady_clock::time_point mixNext;
+    std::chrono::steady_clock::time_point lastJitterStats;
+    size_t mixSamples = 0;
+    std::vector<int16_t> mixBuffer;
+
+    // Reused across frames, so steady state playback does not allocate
+    std::vector<uint8_t> playoutPayload;
+    std::vector<int16_t> decodedPcm;
 
     FILE *fPipe;
     int fPipeFd;
 
+    // Pre-opened speaker output, null when falling back to the pipe
+    std::unique_ptr<IMPAudioOutput> audioOutput;
+
+    uint32_t pipeDropCount = 0;
+
+    // Last session refused for a busy stateful decoder, to warn only once
+    unsigned int refusedSessionId = 0;
+
     BackchannelWorker(const BackchannelWorker &) = delete;
     BackchannelWorker &operator=(const BackchannelWorker &) = delete;
 };
@@ -0,0 +1,226 @@
+#include "BlockMotion.hpp"
+
+#include <algorithm>
+#include <cstring>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#elif defined(__ARM_NEON)
+#include <arm_neon.h>
+#elif defined(__mips_msa)
+#include <msa.h>
+#endif
+
+namespace BlockMotion {
+
+static inline void accumulateSad8Scalar(const uint8_t *cur, const uint8_t *ref, size_t groups, uint32_t *sums)
+{
+    for (size_t g = 0; g < groups; g++)
+    {
+        uint32_t sad = 0;
+        for (int i = 0; i < 8; i++)
+        {
+            int d = cur[g * 8 + i] - ref[g * 8 + i];
+            sad += d < 0 ? -d : d;
+        }
+        sums[g] += sad;
+    }
+}
+
+void accumulateSad8(const uint8_t *cur, const uint8_t *ref, size_t groups, uint32_t *sums)
+{
+    size_t g = 0;
+
+#if defined(__SSE2__)
+    for (; g + 2 <= groups; g += 2)
+    {
+        __m128i a = _mm_loadu_si128(reinterpret_cast<const __m128i *>(cur + g * 8));
+        __m128i b = _mm_loadu_si128(reinterpret_cast<const __m128i *>(ref + g * 8));
+        // One 16-bit sum per 64-bit lane, i.e. per 8 pixel group
+        __m128i sad = _mm_sad_epu8(a, b);
+        sums[g] += (uint32_t) _mm_cvtsi128_si32(sad);
+        sums[g + 1] += (uint32_t) _mm_cvtsi128_si32(_mm_srli_si128(sad, 8));
+    }
+#elif defined(__ARM_NEON)
+    for (; g + 2 <= groups; g += 2)
+    {
+        uint8x16_t d = vabdq_u8(vld1q_u8(cur + g * 8), vld1q_u8(ref + g * 8));
+        uint64x2_t sad = vpaddlq_u32(vpaddlq_u16(vpaddlq_u8(d)));
+        sums[g] += (uint32_t) vgetq_lane_u64(sad, 0);
+        sums[g + 1] += (uint32_t) vgetq_lane_u64(sad, 1);
+    }
+#elif defined(__mips_msa)
+    for (; g + 2 <= groups; g += 2)
+    {
+        v16u8 a = (v16u8) __msa_ld_b(const_cast<uint8_t *>(cur + g * 8), 0);
+        v16u8 b = (v16u8) __msa_ld_b(const_cast<uint8_t *>(ref + g * 8), 0);
+        v16u8 d = __msa_asub_u_b(a, b);
+        v8u16 h = __msa_hadd_u_h(d, d);
+        v4u32 w = __msa_hadd_u_w(h, h);
+        v2u64 sad = __msa_hadd_u_d(w, w);
+        // copy_u.d is MIPS64 only; the low words of the two sums suffice
+        sums[g] += (uint32_t) __msa_copy_s_w((v4i32) sad, 0);
+        sums[g + 1] += (uint32_t) __msa_copy_s_w((v4i32) sad, 2);
+    }
+#endif
+
+    accumulateSad8Scalar(cur + g * 8, ref + g * 8, groups - g, sums + g);
+}
+
+void blendBackground(uint8_t *bg, const uint8_t *cur, size_t n)
+{
+    // Three averages towards bg: bg + (cur - bg) / 8. Every average rounds
+    // towards cur, up when brightening and down when darkening, so bg always
+    // moves at least one level and settles exactly on a static scene.
+    size_t i = 0;
+
+#if defined(__SSE2__)
+    for (; i + 16 <= n; i += 16)
+    {
+        __m128i b = _mm_loadu_si128(reinterpret_cast<const __m128i *>(bg + i));
+        __m128i c = _mm_loadu_si128(reinterpret_cast<const __m128i *>(cur + i));
+        __m128i up = _mm_avg_epu8(b, _mm_avg_epu8(b, _mm_avg_epu8(b, c)));
+        // Rounding down is rounding up on the complement
+        __m128i ones = _mm_set1_epi8(-1);
+        __m128i nb = _mm_xor_si128(b, ones);
+        __m128i nc = _mm_xor_si128(c, ones);
+        __m128i down = _mm_xor_si128(_mm_avg_epu8(nb, _mm_avg_epu8(nb, _mm_avg_epu8(nb, nc))), ones);
+        // cur <= bg where the saturating cur - bg is zero
+        __m128i darker = _mm_cmpeq_epi8(_mm_subs_epu8(c, b), _mm_setzero_si128());
+        __m128i r = _mm_or_si128(_mm_and_si128(darker, down), _mm_andnot_si128(darker, up));
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(bg + i), r);
+    }
+#elif defined(__ARM_NEON)
+    for (; i + 16 <= n; i += 16)
+    {
+        uint8x16_t b = vld1q_u8(bg + i);
+        uint8x16_t c = vld1q_u8(cur + i);
+        uint8x16_t up = vrhaddq_u8(b, vrhaddq_u8(b, vrhaddq_u8(b, c)));
+        uint8x16_t down = vhaddq_u8(b, vhaddq_u8(b, vhaddq_u8(b, c)));
+        vst1q_u8(bg + i, vbslq_u8(vcleq_u8(c, b), down, up));
+    }
+#elif defined(__mips_msa)
+    for (; i + 16 <= n; i += 16)
+    {
+        v16u8 b = (v16u8) __msa_ld_b(bg + i, 0);
+        v16u8 c = (v16u8) __msa_ld_b(const_cast<uint8_t *>(cur + i), 0);
+        v16u8 up = __msa_aver_u_b(b, __msa_aver_u_b(b, __msa_aver_u_b(b, c)));
+        v16u8 down = __msa_ave_u_b(b, __msa_ave_u_b(b, __msa_ave_u_b(b, c)));
+        v16u8 r = __msa_bmnz_v(up, down, (v16u8) __msa_cle_u_b(c, b));
+        __msa_st_b((v16i8) r, bg + i, 0);
+    }
+#endif
+
+    for (; i < n; i++)
+    {
+        unsigned b = bg[i];
+        unsigned c = cur[i];
+        unsigned up = c > b;
+        unsigned r = (b + ((b + ((b + c + up) >> 1) + up) >> 1) + up) >> 1;
+        bg[i] = (uint8_t) r;
+    }
+}
+
+} // namespace BlockMotion
+
+void BlockMotionDetector::reset(int width, int height, int blockSize)
+{
+    block = (blockSize == 8 || blockSize == 32) ? blockSize : 16;
+    frameWidth = std::max(width, 0);
+    frameHeight = std::max(height, 0);
+    cols = frameWidth / block;
+    rows = frameHeight / block;
+    seeded = false;
+
+    background.assign((size_t) cols * block * rows * block, 0);
+    grid.assign((size_t) cols * rows, 0);
+    groupSums.assign((size_t) cols * block / 8, 0);
+}
+
+bool BlockMotionDetector::process(const uint8_t *luma, int stride)
+{
+    const size_t rowBytes = (size_t) cols * block;
+    const size_t groups = rowBytes / 8;
+    const int groupsPerBlock = block / 8;
+    const uint32_t pixelsPerBlock = (uint32_t) block * block;
+
+    if (!seeded)
+    {
+        for (int y = 0; y < rows * block; y++)
+            std::memcpy(&background[y * rowBytes], luma + (size_t) y * stride, rowBytes);
+        seeded = true;
+        return false;
+    }
+
+    for (int by = 0; by < rows; by++)
+    {
+        std::fill(groupSums.begin(), groupSums.end(), 0);
+        for (int y = by * block; y < (by + 1) * block; y++)
+        {
+            const uint8_t *cur = luma + (size_t) y * stride;
+            uint8_t *bg = &background[y * rowBytes];
+            BlockMotion::accumulateSad8(cur, bg, groups, groupSums.data());
+            BlockMotion::blendBackground(bg, cur, rowBytes);
+        }
+
+        for (int bx = 0; bx < cols; bx++)
+        {
+            uint32_t sad = 0;
+            for (int g = 0; g < groupsPerBlock; g++)
+                sad += groupSums[bx * groupsPerBlock + g];
+            grid[by * cols + bx] = (uint8_t) std::min<uint32_t>((sad + pixelsPerBlock / 2) / pixelsPerBlock, 255);
+        }
+    }
+
+    return true;
+}
+
+int BlockMotionDetector::countActive(int threshold, int x0, int y0, int x1, int y1) const
+{
+    int bx0 = std::max(x0, 0) / block;
+    int by0 = std::max(y0, 0) / block;
+    int bx1 = std::min((std::max(x1, 0) + block - 1) / block, cols);
+    int by1 = std::min((std::max(y1, 0) + block - 1) / block, rows);
+
+    int count = 0;
+    for (int by = by0; by < by1; by++)
+    {
+        for (int bx = bx0; bx < bx1; bx++)
+        {
+            if (grid[by * cols + bx] >= threshold)
+                count++;
+        }
+    }
+    return count;
+}
+
+bool BlockMotionDetector::activeBounds(int threshold, int &x0, int &y0, int &x1, int &y1) const
+{
+    int bx0 = std::max(x0, 0) / block;
+    int by0 = std::max(y0, 0) / block;
+    int bx1 = std::min((std::max(x1, 0) + block - 1) / block, cols);
+    int by1 = std::min((std::max(y1, 0) + block - 1) / block, rows);
+
+    int minX = cols, minY = rows, maxX = -1, maxY = -1;
+    for (int by = by0; by < by1; by++)
+    {
+        for (int bx = bx0; bx < bx1; bx++)
+        {
+            if (grid[by * cols + bx] >= threshold)
+            {
+                minX = std::min(minX, bx);
+                maxX = std::max(maxX, bx);
+                minY = std::min(minY, by);
+                maxY = std::max(maxY, by);
+            }
+        }
+    }
+    if (maxX < 0)
+        return false;
+
+    x0 = std::max(x0, minX * block);
+    y0 = std::max(y0, minY * block);
+    x1 = std::min(x1, (maxX + 1) * block);
+    y1 = std::min(y1, (maxY + 1) * block);
+    return true;
+}
@@ -0,0 +1,73 @@
+#ifndef BLOCK_MOTION_HPP
+#define BLOCK_MOTION_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace BlockMotion {
+
+/* Kernels of the detector, SSE2/NEON/MSA when available, scalar otherwise.
+ * MSA is built for the XBurst2 SoCs (T40, T41), see MSA_SOURCES in the
+ * Makefile; the other cameras run the scalar loops.
+ */
+
+// Add the sum of absolute differences of every 8 pixel group of a row to
+// sums[group].
+void accumulateSad8(const uint8_t *cur, const uint8_t *ref, size_t groups, uint32_t *sums);
+
+// bg += (cur - bg) / 8, rounded towards cur in both directions, so bg
+// reaches cur exactly when the scene stops changing
+void blendBackground(uint8_t *bg, const uint8_t *cur, size_t n);
+
+} // namespace BlockMotion
+
+/* Block based motion detector working on a luma (e.g. the Y plane of NV12)
+ * image.
+ *
+ * The frame is compared against a running average background in blocks of
+ * 8, 16 or 32 pixels. The activity of a block is the mean absolute
+ * difference of its pixels to the background (0-255); pixels right/below the
+ * last full block are ignored. Everything runs on plain buffers, so it works
+ * on recorded frames just as well as on framesource output.
+ */
+class BlockMotionDetector
+{
+public:
+    void reset(int width, int height, int blockSize);
+
+    // Process one frame. Returns false for the first frame, which only
+    // seeds the background.
+    bool process(const uint8_t *luma, int stride);
+
+    int width() const { return frameWidth; }
+    int height() const { return frameHeight; }
+    int blockSize() const { return block; }
+    int gridWidth() const { return cols; }
+    int gridHeight() const { return rows; }
+
+    // Per block activity of the last frame, row major
+    const std::vector<uint8_t> &activity() const { return grid; }
+
+    // Blocks at or above 'threshold' that overlap the pixel rectangle
+    // [x0, x1) x [y0, y1)
+    int countActive(int threshold, int x0, int y0, int x1, int y1) const;
+
+    // Shrink the pixel rectangle [x0, x1) x [y0, y1) to the bounds of the
+    // active blocks overlapping it. False, and unchanged, if there are none.
+    bool activeBounds(int threshold, int &x0, int &y0, int &x1, int &y1) const;
+
+private:
+    int frameWidth = 0;
+    int frameHeight = 0;
+    int block = 16;
+    int cols = 0;
+    int rows = 0;
+    bool seeded = false;
+
+    std::vector<uint8_t> background; // cols * block wide
+    std::vector<uint8_t> grid;
+    std::vector<uint32_t> groupSums; // one block row of 8 pixel groups
+};
+
+#endif // BLOCK_MOTION_HPP
@@ -0,0 +1,95 @@
+#ifndef CAPTURE_TIMELINE_HPP
+#define CAPTURE_TIMELINE_HPP
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+/* Capture time of buffered PCM, sample exact.
+ *
+ * Each captured frame is recorded as an anchor (hardware timestamp of its
+ * first sample, sample count). Buffers that regroup audio into differently
+ * sized frames push and consume the same sample counts here, and front()
+ * gives the capture time of the oldest buffered sample: its frame's timestamp
+ * plus its offset into that frame. No per-frame rounding accumulates and the
+ * PTS follows the capture clock rather than a sample count.
+ */
+class CaptureTimeline
+{
+public:
+    void reset(unsigned sampleRate)
+    {
+        rate = sampleRate > 0 ? sampleRate : 1;
+        clear();
+    }
+
+    void clear()
+    {
+        head = 0;
+        count = 0;
+        consumed = 0;
+    }
+
+    bool empty() const { return count == 0; }
+
+    // 'samples' per channel captured starting at 'timestampUs'
+    void push(int64_t timestampUs, size_t samples)
+    {
+        if (samples == 0)
+            return;
+
+        if (count == MAX_ANCHORS)
+        {
+            // More frames buffered than expected, extend the newest anchor
+            anchors[(head + count - 1) % MAX_ANCHORS].samples += samples;
+            return;
+        }
+        anchors[(head + count) % MAX_ANCHORS] = {timestampUs, samples};
+        count++;
+    }
+
+    // Capture time of the oldest buffered sample
+    int64_t front() const
+    {
+        if (count == 0)
+            return 0;
+        const Anchor &a = anchors[head];
+        return a.timestampUs + (int64_t) (consumed * 1000000ULL / rate);
+    }
+
+    // Drop 'samples' per channel from the front
+    void consume(size_t samples)
+    {
+        while (samples > 0 && count > 0)
+        {
+            Anchor &a = anchors[head];
+            size_t take = a.samples - consumed;
+            if (take > samples)
+            {
+                consumed += samples;
+                return;
+            }
+            samples -= take;
+            consumed = 0;
+            head = (head + 1) % MAX_ANCHORS;
+            count--;
+        }
+    }
+
+private:
+    static constexpr size_t MAX_ANCHORS = 32;
+
+    struct Anchor
+    {
+        int64_t timestampUs;
+        size_t samples;
+    };
+
+    std::array<Anchor, MAX_ANCHORS> anchors{};
+    size_t head = 0;
+    size_t count = 0;
+    size_t consumed = 0; // samples already taken from anchors[head]
+    unsigned rate = 1;
+};
+
+#endif // CAPTURE_TIMELINE_HPP
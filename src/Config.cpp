@@ -95,7 +95,11 @@ std::vector<ConfigItem<bool>> CFG::getBoolItems()
 #if defined(AUDIO_SUPPORT)
         {"audio.input_enabled", audio.input_enabled, true, validateBool},
         {"audio.output_enabled", audio.output_enabled, false, validateBool},
+        {"audio.output_direct", audio.output_direct, true, validateBool},
         {"audio.force_stereo", audio.force_stereo, false, validateBool},
+        {"audio.opus_dtx", audio.opus_dtx, false, validateBool},
+        {"audio.opus_fec", audio.opus_fec, true, validateBool},
+        {"audio.sound_events_enabled", audio.sound_events_enabled, false, validateBool},
 #if defined(LIB_AUDIO_PROCESSING)
         {"audio.input_high_pass_filter", audio.input_high_pass_filter, false, validateBool},
         {"audio.input_agc_enabled", audio.input_agc_enabled, false, validateBool},
@@ -116,6 +120,11 @@ std::vector<ConfigItem<bool>> CFG::getBoolItems()
         {"stream0.osd.time_enabled", stream0.osd.time_enabled, true, validateBool},
         {"stream0.osd.uptime_enabled", stream0.osd.uptime_enabled, true, validateBool},
         {"stream0.osd.user_text_enabled", stream0.osd.user_text_enabled, true, validateBool},
+        {"stream0.osd.motion_enabled", stream0.osd.motion_enabled, false, validateBool},
+        {"stream0.osd.bitrate_graph_enabled", stream0.osd.bitrate_graph_enabled, false, validateBool},
+        {"stream0.osd.audio_meter_enabled", stream0.osd.audio_meter_enabled, false, validateBool},
+        {"stream0.osd.logo_autoscale", stream0.osd.logo_autoscale, false, validateBool},
+        {"stream0.idle_enabled", stream0.idle_enabled, false, validateBool},
 #if defined(AUDIO_SUPPORT)
         {"stream1.audio_enabled", stream1.audio_enabled, true, validateBool},
 #endif
@@ -126,6 +135,11 @@ std::vector<ConfigItem<bool>> CFG::getBoolItems()
         {"stream1.osd.time_enabled", stream1.osd.time_enabled, true, validateBool},
         {"stream1.osd.uptime_enabled", stream1.osd.uptime_enabled, true, validateBool},
         {"stream1.osd.user_text_enabled", stream1.osd.user_text_enabled, true, validateBool},
+        {"stream1.osd.motion_enabled", stream1.osd.motion_enabled, false, validateBool},
+        {"stream1.osd.bitrate_graph_enabled", stream1.osd.bitrate_graph_enabled, false, validateBool},
+        {"stream1.osd.audio_meter_enabled", stream1.osd.audio_meter_enabled, false, validateBool},
+        {"stream1.osd.logo_autoscale", stream1.osd.logo_autoscale, false, validateBool},
+        {"stream1.idle_enabled", stream1.idle_enabled, false, validateBool},
         {"stream2.enabled", stream2.enabled, true, validateBool},
         {"websocket.enabled", websocket.enabled, true, validateBool},
         {"websocket.ws_secured", websocket.ws_secured, true, validateBool},
@@ -141,12 +155,14 @@ std::vector<ConfigItem<const char *>> CFG::getCharItems()
             std::set<std::string> a = {"OPUS", "AAC", "PCM", "G711A", "G711U", "G726"};
             return a.count(std::string(v)) == 1;
         }},
+        {"audio.sound_event_script", audio.sound_event_script, "/usr/sbin/sound", validateCharNotEmpty},
 #endif
         {"general.loglevel", general.loglevel, "INFO", [](const char *v) {
             std::set<std::string> a = {"EMERGENCY", "ALERT", "CRITICAL", "ERROR", "WARN", "NOTICE", "INFO", "DEBUG"};
             return a.count(std::string(v)) == 1;
         }},
-        {"motion.script_path", motion.script_path, "/usr/sbin/motion", validateCharNotEmpty},
+        {"motion.script_path", motion.script_path, "/usr/sbin/motion", validateCharDummy},
+        {"motion.detector", motion.detector, "ivs", [](const char *v) { return strcmp(v, "ivs") == 0 || strcmp(v, "software") == 0; }},
         {"rtsp.name", rtsp.name, "thingino prudynt", validateCharNotEmpty},
         {"rtsp.password", rtsp.password, "thingino", validateCharNotEmpty},
         {"rtsp.username", rtsp.username, "thingino", validateCharNotEmpty},
@@ -165,6 +181,7 @@ std::vector<ConfigItem<const char *>> CFG::getCharItems()
         }},
         {"stream0.rtsp_endpoint", stream0.rtsp_endpoint, "ch0", validateCharNotEmpty},
         {"stream0.rtsp_info", stream0.rtsp_info, "stream0", validateCharNotEmpty},
+        {"stream0.roi_qp_mode", stream0.roi_qp_mode, "off", [](const char *v) { return strcmp(v, "off") == 0 || strcmp(v, "motion") == 0 || strcmp(v, "static") == 0; }},
         {"stream1.format", stream1.format, "H264", [](const char *v) { return strcmp(v, "H264") == 0 || strcmp(v, "H265") == 0; }},
         {"stream1.osd.font_path", stream1.osd.font_path, "/usr/share/fonts/NotoSansDisplay-Condensed2.ttf", validateCharNotEmpty},
         {"stream1.osd.logo_path", stream1.osd.logo_path, "/usr/share/images/thingino_logo_1.bgra", validateCharNotEmpty},
@@ -177,6 +194,7 @@ std::vector<ConfigItem<const char *>> CFG::getCharItems()
         }},
         {"stream1.rtsp_endpoint", stream1.rtsp_endpoint, "ch1", validateCharNotEmpty},
         {"stream1.rtsp_info", stream1.rtsp_info, "stream1", validateCharNotEmpty},
+        {"stream1.roi_qp_mode", stream1.roi_qp_mode, "off", [](const char *v) { return strcmp(v, "off") == 0 || strcmp(v, "motion") == 0 || strcmp(v, "static") == 0; }},
        {"stream2.jpeg_path", stream2.jpeg_path, "/tmp/snapshot.jpg", validateCharNotEmpty},
         {"websocket.name", websocket.name, "wss prudynt", validateCharNotEmpty},
         {"websocket.token", websocket.token, "auto", [](const char *v) {
@@ -193,6 +211,13 @@ std::vector<ConfigItem<int>> CFG::getIntItems()
         {"audio.input_bitrate", audio.input_bitrate, 40, [](const int &v) { return v >= 6 && v <= 256; }},
         {"audio.input_sample_rate", audio.input_sample_rate, 16000, validateSampleRate},
         {"audio.output_sample_rate", audio.output_sample_rate, 16000, validateSampleRate},
+        {"audio.output_vol", audio.output_vol, 80, [](const int &v) { return v >= -30 && v <= 120; }},
+        {"audio.output_gain", audio.output_gain, 25, [](const int &v) { return v >= 0 && v <= 31; }},
+        {"audio.output_jitter_delay", audio.output_jitter_delay, 60, [](const int &v) { return v >= 0 && v <= 500; }},
+        {"audio.output_jitter_max_delay", audio.output_jitter_max_delay, 300, [](const int &v) { return v >= 20 && v <= 2000; }},
+        {"audio.opus_frame_duration", audio.opus_frame_duration, 20, [](const int &v) { return v == 20 || v == 40 || v == 60; }},
+        {"audio.vad_threshold", audio.vad_threshold, 9, [](const int &v) { return v >= 3 && v <= 40; }},
+        {"audio.sound_event_cooldown", audio.sound_event_cooldown, 10, [](const int &v) { return v >= 0 && v <= 3600; }},
         {"audio.input_vol", audio.input_vol, 80, [](const int &v) { return v >= -30 && v <= 120; }},
         {"audio.input_gain", audio.input_gain, 25, [](const int &v) { return v >= -1 && v <= 31; }},
 #if defined(LIB_AUDIO_PROCESSING)
@@ -240,6 +265,11 @@ std::vector<ConfigItem<int>> CFG::getIntItems()
         {"motion.roi_1_x", motion.roi_1_x, IVS_AUTO_VALUE, validateIntGe0},
         {"motion.roi_1_y", motion.roi_1_y, IVS_AUTO_VALUE, validateIntGe0},
         {"motion.roi_count", motion.roi_count, 1, [](const int &v) { return v >= 1 && v <= 52; }},
+        {"motion.block_size", motion.block_size, 16, [](const int &v) { return v == 8 || v == 16 || v == 32; }},
+        {"motion.block_threshold", motion.block_threshold, 20, [](const int &v) { return v >= 1 && v <= 255; }},
+        {"motion.block_min_count", motion.block_min_count, 2, [](const int &v) { return v >= 1; }},
+        {"motion.script_min_interval", motion.script_min_interval, 1000, [](const int &v) { return v >= 0 && v <= 60000; }},
+        {"motion.heatmap_half_life", motion.heatmap_half_life, 3600, [](const int &v) { return v >= 60 && v <= 604800; }},
         {"rtsp.est_bitrate", rtsp.est_bitrate, 5000, validateIntGe0},
         {"rtsp.out_buffer_size", rtsp.out_buffer_size, 500000, validateIntGe0},
         {"rtsp.port", rtsp.port, 554, validateInt65535},
@@ -259,6 +289,11 @@ std::vector<ConfigItem<int>> CFG::getIntItems()
         {"stream0.fps", stream0.fps, 25, validateInt120},
         {"stream0.gop", stream0.gop, 20, validateIntGe0},
         {"stream0.height", stream0.height, 1080, validateIntGe0},
+        {"stream0.idle_bitrate", stream0.idle_bitrate, 500, validateIntGe0},
+        {"stream0.idle_fps", stream0.idle_fps, 5, [](const int &v) { return v >= 0 && v <= 120; }},
+        {"stream0.idle_gop", stream0.idle_gop, 25, validateIntGe0},
+        {"stream0.roi_qp_active", stream0.roi_qp_active, -6, [](const int &v) { return v >= -51 && v <= 0; }},
+        {"stream0.roi_qp_background", stream0.roi_qp_background, 2, [](const int &v) { return v >= 0 && v <= 51; }},
         {"stream0.max_gop", stream0.max_gop, 60, validateIntGe0},
         {"stream0.osd.font_size", stream0.osd.font_size, OSD_AUTO_VALUE, validateIntGe0},
         {"stream0.osd.font_stroke", stream0.osd.font_stroke, 1, validateIntGe0},
@@ -271,6 +306,12 @@ std::vector<ConfigItem<int>> CFG::getIntItems()
         {"stream0.osd.logo_width", stream0.osd.logo_width, 100, validateIntGe0},
         {"stream0.osd.pos_logo_x", stream0.osd.pos_logo_x, OSD_AUTO_VALUE, validateInt15360},
         {"stream0.osd.pos_logo_y", stream0.osd.pos_logo_y, OSD_AUTO_VALUE, validateInt15360},
+        {"stream0.osd.pos_motion_x", stream0.osd.pos_motion_x, OSD_AUTO_VALUE, validateInt15360},
+        {"stream0.osd.pos_motion_y", stream0.osd.pos_motion_y, OSD_AUTO_VALUE, validateInt15360},
+        {"stream0.osd.pos_bitrate_graph_x", stream0.osd.pos_bitrate_graph_x, OSD_AUTO_VALUE, validateInt15360},
+        {"stream0.osd.pos_bitrate_graph_y", stream0.osd.pos_bitrate_graph_y, OSD_AUTO_VALUE, validateInt15360},
+        {"stream0.osd.pos_audio_meter_x", stream0.osd.pos_audio_meter_x, OSD_AUTO_VALUE, validateInt15360},
+        {"stream0.osd.pos_audio_meter_y", stream0.osd.pos_audio_meter_y, OSD_AUTO_VALUE, validateInt15360},
         {"stream0.osd.pos_time_x", stream0.osd.pos_time_x, OSD_AUTO_VALUE, validateInt15360},
         {"stream0.osd.pos_time_y", stream0.osd.pos_time_y, OSD_AUTO_VALUE, validateInt15360},
         {"stream0.osd.pos_uptime_x", stream0.osd.pos_uptime_x, OSD_AUTO_VALUE, validateInt15360},
@@ -292,6 +333,11 @@ std::vector<ConfigItem<int>> CFG::getIntItems()
         {"stream1.fps", stream1.fps, 25, validateInt120},
         {"stream1.gop", stream1.gop, 20, validateIntGe0},
         {"stream1.height", stream1.height, 360, validateIntGe0},
+        {"stream1.idle_bitrate", stream1.idle_bitrate, 150, validateIntGe0},
+        {"stream1.idle_fps", stream1.idle_fps, 5, [](const int &v) { return v >= 0 && v <= 120; }},
+        {"stream1.idle_gop", stream1.idle_gop, 25, validateIntGe0},
+        {"stream1.roi_qp_active", stream1.roi_qp_active, -6, [](const int &v) { return v >= -51 && v <= 0; }},
+        {"stream1.roi_qp_background", stream1.roi_qp_background, 2, [](const int &v) { return v >= 0 && v <= 51; }},
         {"stream1.max_gop", stream1.max_gop, 60, validateIntGe0},
         {"stream1.osd.font_size", stream1.osd.font_size, OSD_AUTO_VALUE, validateIntGe0},
         {"stream1.osd.font_stroke", stream1.osd.font_stroke, 1, validateIntGe0},
@@ -304,6 +350,12 @@ std::vector<ConfigItem<int>> CFG::getIntItems()
         {"stream1.osd.logo_width", stream1.osd.logo_width, 100, validateIntGe0},
         {"stream1.osd.pos_logo_x", stream1.osd.pos_logo_x, OSD_AUTO_VALUE, validateInt15360},
         {"stream1.osd.pos_logo_y", stream1.osd.pos_logo_y, OSD_AUTO_VALUE, validateInt15360},
+        {"stream1.osd.pos_motion_x", stream1.osd.pos_motion_x, OSD_AUTO_VALUE, validateInt15360},
+        {"stream1.osd.pos_motion_y", stream1.osd.pos_motion_y, OSD_AUTO_VALUE, validateInt15360},
+        {"stream1.osd.pos_bitrate_graph_x", stream1.osd.pos_bitrate_graph_x, OSD_AUTO_VALUE, validateInt15360},
+        {"stream1.osd.pos_bitrate_graph_y", stream1.osd.pos_bitrate_graph_y, OSD_AUTO_VALUE, validateInt15360},
+        {"stream1.osd.pos_audio_meter_x", stream1.osd.pos_audio_meter_x, OSD_AUTO_VALUE, validateInt15360},
+        {"stream1.osd.pos_audio_meter_y", stream1.osd.pos_audio_meter_y, OSD_AUTO_VALUE, validateInt15360},
         {"stream1.osd.pos_time_x", stream1.osd.pos_time_x, OSD_AUTO_VALUE, validateInt15360},
         {"stream1.osd.pos_time_y", stream1.osd.pos_time_y, OSD_AUTO_VALUE, validateInt15360},
         {"stream1.osd.pos_uptime_x", stream1.osd.pos_uptime_x, OSD_AUTO_VALUE, validateInt15360},
@@ -649,6 +701,8 @@ bool CFG::updateConfig()
         json_object_array_add(roiArray, json_object_new_int(motion.rois[i].p0_y));
         json_object_array_add(roiArray, json_object_new_int(motion.rois[i].p1_x));
         json_object_array_add(roiArray, json_object_new_int(motion.rois[i].p1_y));
+        if (motion.rois[i].sensitivity >= 0)
+            json_object_array_add(roiArray, json_object_new_int(motion.rois[i].sensitivity));
 
         json_object_object_add(roisObj, roiKey.c_str(), roiArray);
     }
@@ -732,13 +786,23 @@ void CFG::load()
                 if (json_object_object_get_ex(roisObj, roiKey.c_str(), &roiArray) &&
                     json_object_is_type(roiArray, json_type_array))
                 {
+                    // [x0, y0, x1, y1] with an optional per region sensitivity
                     int arrayLen = json_object_array_length(roiArray);
-                    if (arrayLen == 4)
+                    if (arrayLen == 4 || arrayLen == 5)
                     {
                         motion.rois[i].p0_x = json_object_get_int(json_object_array_get_idx(roiArray, 0));
                         motion.rois[i].p0_y = json_object_get_int(json_object_array_get_idx(roiArray, 1));
                         motion.rois[i].p1_x = json_object_get_int(json_object_array_get_idx(roiArray, 2));
                         motion.rois[i].p1_y = json_object_get_int(json_object_array_get_idx(roiArray, 3));
+                        motion.rois[i].sensitivity = -1;
+                        if (arrayLen == 5)
+                        {
+                            int sense = json_object_get_int(json_object_array_get_idx(roiArray, 4));
+                            if (sense >= 0 && sense <= 4)
+                                motion.rois[i].sensitivity = sense;
+                            else
+                                LOG_WARN("rois." << roiKey << ": sensitivity " << sense << " out of range (0-4), using motion.sensitivity");
+                        }
                     }
                 }
             }
@@ -71,6 +71,7 @@ struct roi{
     int p0_y;
     int p1_x;
     int p1_y;
+    int sensitivity = -1; // -1: motion.sensitivity
 };
 
 template<typename T>
@@ -94,6 +95,9 @@ struct _regions {
     int user;
     int uptime;
     int logo;
+    int motion;
+    int bitrate_graph;
+    int audio_meter;
 };
 struct _general {
     const char *loglevel;
@@ -174,7 +178,21 @@ struct _audio {
     bool output_enabled;
     int output_sample_rate;
 #endif
-    // Buffer tuning (in 20 ms frames per channel)
+    bool output_direct;
+    int output_vol;
+    int output_gain;
+    int output_jitter_delay;
+    int output_jitter_max_delay;
+    // Opus stream tuning
+    bool opus_dtx;
+    bool opus_fec;
+    int opus_frame_duration;
+    // Level meter / voice activity
+    int vad_threshold;
+    bool sound_events_enabled;
+    const char *sound_event_script;
+    int sound_event_cooldown;
+    // Buffer tuning (in Opus packets per channel)
     int buffer_warn_frames;
     int buffer_cap_frames;
 };
@@ -203,12 +221,22 @@ struct _osd {
     int pos_logo_y;
     int logo_transparency;
     int logo_rotation;
+    int pos_motion_x;
+    int pos_motion_y;
+    int pos_bitrate_graph_x;
+    int pos_bitrate_graph_y;
+    int pos_audio_meter_x;
+    int pos_audio_meter_y;
     int start_delay;
     bool enabled;
     bool time_enabled;
     bool user_text_enabled;
     bool uptime_enabled;
     bool logo_enabled;
+    bool motion_enabled;
+    bool bitrate_graph_enabled;
+    bool audio_meter_enabled;
+    bool logo_autoscale;
     const char *font_path;
     const char *time_format;
     const char *uptime_format;
@@ -246,6 +274,15 @@ struct _stream {
     int jpeg_channel;
     int jpeg_idle_fps;
     const char *jpeg_path;
+    /* Encoder profile while motion detection sees nothing */
+    bool idle_enabled;
+    int idle_fps;
+    int idle_bitrate;
+    int idle_gop;
+    /* Encoder ROIs: "off", "motion" or "static" */
+    const char *roi_qp_mode;
+    int roi_qp_active;
+    int roi_qp_background;
     _osd osd;
     _stream_stats stats;
 #if defined(AUDIO_SUPPORT)
@@ -269,8 +306,14 @@ struct _motion {
     int roi_1_x;
     int roi_1_y;
     int roi_count;
+    int block_size;
+    int block_threshold;
+    int block_min_count;
+    int script_min_interval;
+    int heatmap_half_life;
     bool enabled;
     const char *script_path;
+    const char *detector;
     std::array<roi, 52> rois;
 };
 struct _websocket {
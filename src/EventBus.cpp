@@ -0,0 +1,125 @@
+#include "EventBus.hpp"
+#include "Logger.hpp"
+
+#include <chrono>
+#include <thread>
+
+#define MODULE "EventBus"
+
+EventBus &EventBus::instance()
+{
+    // Never destroyed: the dispatcher may still be waiting on it at exit
+    static EventBus *bus = new EventBus();
+    return *bus;
+}
+
+void EventBus::publish(Event event)
+{
+    if (event.timeMs == 0)
+    {
+        event.timeMs = std::chrono::duration_cast<std::chrono::milliseconds>(
+                           std::chrono::system_clock::now().time_since_epoch()).count();
+    }
+
+    std::unique_lock<std::mutex> lck(mutex);
+    if (!started)
+    {
+        // The dispatcher lives as long as the process, like the config watcher
+        std::thread([this] { run(); }).detach();
+        started = true;
+    }
+
+    queue.push_back(event);
+    if (queue.size() > QUEUE_SIZE)
+    {
+        queue.pop_front();
+        if ((++dropped % 10) == 1)
+            LOG_WARN("Event queue full, dropped " << dropped << " events so far");
+    }
+
+    int idx = static_cast<int>(event.source);
+    last[idx] = event;
+    haveLast[idx] = true;
+
+    cv.notify_one();
+}
+
+int EventBus::subscribe(Handler handler)
+{
+    std::unique_lock<std::mutex> lck(mutex);
+    int id = nextId++;
+    handlers.emplace_back(id, std::move(handler));
+    return id;
+}
+
+void EventBus::unsubscribe(int id)
+{
+    std::unique_lock<std::mutex> lck(mutex);
+    for (auto it = handlers.begin(); it != handlers.end(); ++it)
+    {
+        if (it->first == id)
+        {
+            handlers.erase(it);
+            break;
+        }
+    }
+}
+
+bool EventBus::lastEvent(EventSource source, Event &out)
+{
+    std::unique_lock<std::mutex> lck(mutex);
+    int idx = static_cast<int>(source);
+    if (!haveLast[idx])
+        return false;
+    out = last[idx];
+    return true;
+}
+
+void EventBus::run()
+{
+    LOG_DEBUG("Event dispatcher started.");
+
+    std::vector<Handler> current;
+    while (true)
+    {
+        Event event;
+        {
+            std::unique_lock<std::mutex> lck(mutex);
+            cv.wait(lck, [this] { return !queue.empty(); });
+            event = queue.front();
+            queue.pop_front();
+
+            // Handlers are called without the lock, so they may publish,
+            // subscribe or unsubscribe themselves
+            current.clear();
+            for (auto &h : handlers)
+                current.push_back(h.second);
+        }
+
+        LOG_DEBUG(sourceName(event.source) << (event.active ? " start" : " stop")
+                  << ", region " << event.region);
+
+        for (auto &handler : current)
+            handler(event);
+    }
+}
+
+const char *EventBus::sourceName(EventSource source)
+{
+    switch (source)
+    {
+    case EventSource::Motion:
+        return "motion";
+    case EventSource::Sound:
+        return "sound";
+    }
+    return "unknown";
+}
+
+std::string EventBus::toJson(const Event &event)
+{
+    return std::string("{\"source\":\"") + sourceName(event.source) +
+           "\",\"active\":" + (event.active ? "true" : "false") +
+           ",\"region\":" + std::to_string(event.region) +
+           ",\"time\":" + std::to_string(event.timeMs) + "}";
+}
@@ -0,0 +1,71 @@
+#ifndef EVENT_BUS_HPP
+#define EVENT_BUS_HPP
+
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <utility>
+#include <vector>
+
+enum class EventSource
+{
+    Motion,
+    Sound
+};
+
+struct Event
+{
+    EventSource source = EventSource::Motion;
+    bool active = false;
+    int region = -1;      // ROI that triggered, -1 if not applicable
+    int64_t timeMs = 0;   // wall clock, filled in by publish() when 0
+};
+
+/* In-process event bus for motion and sound events.
+ *
+ * publish() only queues the event and returns, so a detector loop never
+ * waits for its consumers. A single dispatcher thread hands the events to the
+ * subscribed handlers in order. Handlers run on that thread and must not
+ * block; anything slow (scripts, sockets) does its work elsewhere. When the
+ * queue is full the oldest event is dropped.
+ */
+class EventBus
+{
+public:
+    using Handler = std::function<void(const Event &)>;
+
+    static EventBus &instance();
+
+    void publish(Event event);
+
+    int subscribe(Handler handler);
+    void unsubscribe(int id);
+
+    // Last published event per source, false if there was none yet
+    bool lastEvent(EventSource source, Event &out);
+
+    static const char *sourceName(EventSource source);
+    // {"source":"motion","active":true,"region":0,"time":1700000000000}
+    static std::string toJson(const Event &event);
+
+private:
+    EventBus() = default;
+    void run();
+
+    static constexpr size_t QUEUE_SIZE = 64;
+
+    std::mutex mutex;
+    std::condition_variable cv;
+    std::deque<Event> queue;
+    std::vector<std::pair<int, Handler>> handlers;
+    Event last[2];
+    bool haveLast[2] = {false, false};
+    int nextId = 1;
+    bool started = false;
+    uint32_t dropped = 0;
+};
+
+#endif // EVENT_BUS_HPP
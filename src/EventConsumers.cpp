@@ -0,0 +1,161 @@
+#include "EventConsumers.hpp"
+#include "Logger.hpp"
+
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <thread>
+#include <unistd.h>
+
+#define MODULE "EventConsumers"
+
+void *EventSocket::thread_entry(void *arg)
+{
+    (void) arg;
+    LOG_DEBUG("Starting event socket thread.");
+    EventSocket *eventSocket = new EventSocket(); // lives as long as its bus subscription
+    eventSocket->run();
+    return nullptr;
+}
+
+void EventSocket::run()
+{
+    std::error_code ec;
+    std::filesystem::create_directories("/run/prudynt", ec);
+    unlink(SOCKET_PATH);
+
+    int listenFd = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (listenFd < 0)
+    {
+        LOG_ERROR("Event socket: socket() failed: " << strerror(errno));
+        return;
+    }
+
+    struct sockaddr_un addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sun_family = AF_UNIX;
+    strncpy(addr.sun_path, SOCKET_PATH, sizeof(addr.sun_path) - 1);
+
+    if (bind(listenFd, (struct sockaddr *) &addr, sizeof(addr)) < 0 || listen(listenFd, 4) < 0)
+    {
+        LOG_ERROR("Event socket: cannot listen on " << SOCKET_PATH << ": " << strerror(errno));
+        close(listenFd);
+        return;
+    }
+
+    EventBus::instance().subscribe([this](const Event &event) { onEvent(event); });
+    LOG_INFO("Publishing events on " << SOCKET_PATH);
+
+    while (true)
+    {
+        int fd = accept4(listenFd, nullptr, nullptr, SOCK_NONBLOCK | SOCK_CLOEXEC);
+        if (fd < 0)
+        {
+            if (errno != EINTR)
+            {
+                LOG_WARN("Event socket: accept() failed: " << strerror(errno));
+                sleep(1);
+            }
+            continue;
+        }
+
+        // Current state first, so a helper (re)connecting mid-event knows it
+        std::unique_lock<std::mutex> lck(mutex);
+        bool ok = true;
+        for (EventSource source : {EventSource::Motion, EventSource::Sound})
+        {
+            Event last;
+            if (ok && EventBus::instance().lastEvent(source, last))
+                ok = sendLine(fd, EventBus::toJson(last));
+        }
+        if (ok)
+            clients.push_back(fd);
+        else
+            close(fd);
+    }
+}
+
+bool EventSocket::sendLine(int fd, const std::string &line)
+{
+    std::string data = line + "\n";
+    ssize_t n = send(fd, data.data(), data.size(), MSG_DONTWAIT | MSG_NOSIGNAL);
+    return n == (ssize_t) data.size();
+}
+
+void EventSocket::onEvent(const Event &event)
+{
+    std::string line = EventBus::toJson(event);
+
+    std::unique_lock<std::mutex> lck(mutex);
+    for (auto it = clients.begin(); it != clients.end();)
+    {
+        if (sendLine(*it, line))
+        {
+            ++it;
+            continue;
+        }
+
+        LOG_DEBUG("Event socket client " << *it << " gone or too slow, disconnecting");
+        close(*it);
+        it = clients.erase(it);
+    }
+}
+
+ScriptHook::ScriptHook(EventSource source, std::function<const char *()> scriptPath,
+                       std::chrono::milliseconds minInterval)
+    : source(source), scriptPath(std::move(scriptPath)), minInterval(minInterval)
+{
+    EventBus::instance().subscribe([this](const Event &event) { onEvent(event); });
+    std::thread([this] { run(); }).detach();
+}
+
+void ScriptHook::onEvent(const Event &event)
+{
+    if (event.source != source)
+        return;
+
+    std::unique_lock<std::mutex> lck(mutex);
+    pending = event.active ? 1 : 0;
+    cv.notify_one();
+}
+
+void ScriptHook::run()
+{
+    auto nextAllowed = std::chrono::steady_clock::now();
+
+    while (true)
+    {
+        int state;
+        {
+            std::unique_lock<std::mutex> lck(mutex);
+            cv.wait(lck, [this] { return pending >= 0; });
+
+            // Rate limit; whatever arrives until then replaces 'pending'
+            lck.unlock();
+            std::this_thread::sleep_until(nextAllowed);
+            lck.lock();
+
+            state = pending;
+            pending = -1;
+            if (state == lastRun)
+                continue;
+            lastRun = state;
+        }
+
+        const char *path = scriptPath();
+        if (path == nullptr || path[0] == '\0')
+            continue;
+
+        std::string cmd = std::string(path) + (state ? " start" : " stop");
+        int ret = system(cmd.c_str());
+        if (ret != 0)
+        {
+            LOG_ERROR(EventBus::sourceName(source) << " event script failed:" << cmd);
+        }
+        nextAllowed = std::chrono::steady_clock::now() + minInterval;
+    }
+}
@@ -0,0 +1,61 @@
+#ifndef EVENT_CONSUMERS_HPP
+#define EVENT_CONSUMERS_HPP
+
+#include "EventBus.hpp"
+
+#include <chrono>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <vector>
+
+/* Unix stream socket for long-lived helper processes.
+ *
+ * Every connected client receives each event as one JSON line, starting with
+ * the current state of each source on connect. Writes never block: a client
+ * that does not keep up is disconnected.
+ */
+class EventSocket
+{
+public:
+    static constexpr const char *SOCKET_PATH = "/run/prudynt/events.sock";
+
+    static void *thread_entry(void *arg);
+
+private:
+    void run();
+    void onEvent(const Event &event);
+    bool sendLine(int fd, const std::string &line);
+
+    std::mutex mutex;
+    std::vector<int> clients;
+};
+
+/* Calls a script with "start" or "stop" for the events of one source.
+ *
+ * The script runs on its own thread, one invocation at a time and at most
+ * once per 'minInterval'. Events arriving meanwhile are coalesced: only the
+ * latest state is kept, and the script is not called again for a state it
+ * was already called with. An empty script path disables the hook.
+ */
+class ScriptHook
+{
+public:
+    ScriptHook(EventSource source, std::function<const char *()> scriptPath,
+               std::chrono::milliseconds minInterval);
+
+private:
+    void onEvent(const Event &event);
+    void run();
+
+    EventSource source;
+    std::function<const char *()> scriptPath;
+    std::chrono::milliseconds minInterval;
+
+    std::mutex mutex;
+    std::condition_variable cv;
+    int pending = -1; // -1 none, 0 stop, 1 start
+    int lastRun = 0;  // the state the script last saw, "stop" initially
+};
+
+#endif // EVENT_CONSUMERS_HPP
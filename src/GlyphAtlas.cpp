@@ -0,0 +1,205 @@
+#include "GlyphAtlas.hpp"
+
+#include <algorithm>
+#include <cstring>
+
+void GlyphAtlas::reset(const uint8_t text[4], const uint8_t stroke[4], int width, size_t budgetBytes)
+{
+    std::memcpy(textColor, text, sizeof(textColor));
+    std::memcpy(strokeColor, stroke, sizeof(strokeColor));
+    strokeWidth = std::max(width, 0);
+    budget = budgetBytes;
+    evicted = 0;
+
+    cells.clear();
+    pixelData.clear();
+    spans.clear();
+    rowStarts.clear();
+}
+
+const GlyphAtlas::Cell *GlyphAtlas::add(uint32_t codepoint, const uint8_t *coverage, int width, int height,
+                                        int advance, int xmin, int ymin)
+{
+    const int r = strokeWidth;
+
+    cells.erase(codepoint);
+    if (bytes() + (size_t) (width + 2 * r) * (height + 2 * r) * 4 > budget)
+        evict();
+
+    Cell cell;
+    cell.width = width;
+    cell.height = height;
+    cell.advance = advance;
+    cell.xmin = xmin;
+    cell.ymin = ymin;
+    cell.cellWidth = width + 2 * r;
+    cell.cellHeight = height + 2 * r;
+    cell.pixels = pixelData.size();
+    cell.rows = rowStarts.size();
+    cell.lastUse = ++useCounter;
+
+    const int cw = cell.cellWidth;
+    const int ch = cell.cellHeight;
+
+    // Outline: every covered pixel stamps a disc of radius r (circular
+    // distance, i*i + j*j <= r*r), one horizontal run per disc row
+    strokeMask.assign((size_t) cw * ch, 0);
+    for (int y = 0; y < height; ++y)
+    {
+        for (int x = 0; x < width; ++x)
+        {
+            if (coverage[y * width + x] == 0)
+                continue;
+
+            for (int j = -r; j <= r; ++j)
+            {
+                int half = 0;
+                while ((half + 1) * (half + 1) + j * j <= r * r)
+                    ++half;
+                uint8_t *row = &strokeMask[(size_t) (y + r + j) * cw];
+                std::memset(row + x + r - half, 1, 2 * half + 1);
+            }
+        }
+    }
+
+    // Composite: glyph pixels over the outline
+    pixelData.resize(cell.pixels + (size_t) cw * ch * 4);
+    uint8_t *out = &pixelData[cell.pixels];
+    for (int y = 0; y < ch; ++y)
+    {
+        for (int x = 0; x < cw; ++x)
+        {
+            uint8_t *px = out + ((size_t) y * cw + x) * 4;
+            int gx = x - r;
+            int gy = y - r;
+            uint8_t alpha = (gx >= 0 && gx < width && gy >= 0 && gy < height) ? coverage[gy * width + gx] : 0;
+            if (alpha > 0)
+            {
+                px[0] = textColor[0];
+                px[1] = textColor[1];
+                px[2] = textColor[2];
+                px[3] = alpha;
+            }
+            else if (strokeMask[(size_t) y * cw + x])
+            {
+                std::memcpy(px, strokeColor, 4);
+            }
+            else
+            {
+                std::memset(px, 0, 4);
+            }
+        }
+    }
+
+    // Opaque runs per row
+    for (int y = 0; y < ch; ++y)
+    {
+        rowStarts.push_back((uint32_t) spans.size());
+        const uint8_t *row = out + (size_t) y * cw * 4;
+        int x = 0;
+        while (x < cw)
+        {
+            while (x < cw && row[x * 4 + 3] == 0)
+                ++x;
+            int start = x;
+            while (x < cw && row[x * 4 + 3] != 0)
+                ++x;
+            if (x > start)
+                spans.push_back({(uint16_t) start, (uint16_t) (x - start)});
+        }
+    }
+    rowStarts.push_back((uint32_t) spans.size());
+
+    return &(cells[codepoint] = cell);
+}
+
+const GlyphAtlas::Cell *GlyphAtlas::find(uint32_t codepoint)
+{
+    auto it = cells.find(codepoint);
+    if (it == cells.end())
+        return nullptr;
+    it->second.lastUse = ++useCounter;
+    return &it->second;
+}
+
+void GlyphAtlas::evict()
+{
+    // Drop least recently used glyphs down to 3/4 of the budget, so a text
+    // cycling through new glyphs does not compact on every one
+    std::vector<std::pair<uint64_t, uint32_t>> lru;
+    lru.reserve(cells.size());
+    for (const auto &entry : cells)
+    {
+        if (entry.second.lastUse < updateStart)
+            lru.emplace_back(entry.second.lastUse, entry.first);
+    }
+    std::sort(lru.begin(), lru.end());
+
+    size_t used = bytes();
+    size_t target = budget / 4 * 3;
+    for (const auto &victim : lru)
+    {
+        if (used <= target)
+            break;
+        const Cell &cell = cells[victim.second];
+        size_t cellSpans = rowStarts[cell.rows + cell.cellHeight] - rowStarts[cell.rows];
+        used -= (size_t) cell.cellWidth * cell.cellHeight * 4 + cellSpans * sizeof(Span)
+                + (cell.cellHeight + 1) * sizeof(uint32_t);
+        cells.erase(victim.second);
+        evicted++;
+    }
+
+    // Compact what is left into right sized buffers
+    std::vector<uint8_t> newPixels;
+    std::vector<Span> newSpans;
+    std::vector<uint32_t> newRowStarts;
+    newPixels.reserve(used);
+    for (auto &entry : cells)
+    {
+        Cell &cell = entry.second;
+        size_t pixelBytes = (size_t) cell.cellWidth * cell.cellHeight * 4;
+        size_t newPixelOffset = newPixels.size();
+        newPixels.insert(newPixels.end(), pixelData.begin() + cell.pixels,
+                         pixelData.begin() + cell.pixels + pixelBytes);
+
+        size_t newRows = newRowStarts.size();
+        uint32_t firstSpan = rowStarts[cell.rows];
+        uint32_t lastSpan = rowStarts[cell.rows + cell.cellHeight];
+        uint32_t base = (uint32_t) newSpans.size();
+        for (int row = 0; row <= cell.cellHeight; ++row)
+            newRowStarts.push_back(rowStarts[cell.rows + row] - firstSpan + base);
+        newSpans.insert(newSpans.end(), spans.begin() + firstSpan, spans.begin() + lastSpan);
+
+        cell.pixels = newPixelOffset;
+        cell.rows = newRows;
+    }
+    pixelData.swap(newPixels);
+    spans.swap(newSpans);
+    rowStarts.swap(newRowStarts);
+}
+
+void GlyphAtlas::blit(const Cell &cell, uint8_t *image, int x, int y, int imageWidth, int imageHeight,
+                      int clipBegin, int clipEnd) const
+{
+    clipBegin = std::max(clipBegin, 0);
+    clipEnd = std::min(clipEnd, imageWidth);
+
+    const uint8_t *src = &pixelData[cell.pixels];
+    const uint32_t *rows = &rowStarts[cell.rows];
+
+    int rowBegin = std::max(0, -y);
+    int rowEnd = std::min(cell.cellHeight, imageHeight - y);
+    for (int row = rowBegin; row < rowEnd; ++row)
+    {
+        uint8_t *dstRow = image + (size_t) (y + row) * imageWidth * 4;
+        const uint8_t *srcRow = src + (size_t) row * cell.cellWidth * 4;
+
+        for (uint32_t s = rows[row]; s < rows[row + 1]; ++s)
+        {
+            int begin = std::max(x + spans[s].x, clipBegin);
+            int end = std::min(x + spans[s].x + spans[s].len, clipEnd);
+            if (begin < end)
+                std::memcpy(dstRow + begin * 4, srcRow + (begin - x) * 4, (size_t) (end - begin) * 4);
+        }
+    }
+}
@@ -0,0 +1,98 @@
+#ifndef GLYPH_ATLAS_HPP
+#define GLYPH_ATLAS_HPP
+
+#include <cstddef>
+#include <climits>
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+/* Pre-rendered OSD glyphs, outline included.
+ *
+ * Every glyph is composited once into a BGRA cell 'stroke' pixels larger than
+ * the glyph on each side: the outline (the glyph coverage dilated by a disc of
+ * radius 'stroke') in the stroke colour, the antialiased glyph in the text
+ * colour on top. Cells are packed back to back into one pixel buffer.
+ *
+ * For each cell row the runs of non-transparent pixels are recorded, so
+ * drawing a glyph is one memcpy per run. Transparent pixels are skipped and
+ * neighbouring glyphs that overlap keep their pixels, exactly like drawing
+ * the outline and the glyph pixel by pixel.
+ *
+ * Glyphs are keyed by codepoint and added on demand. Once the atlas grows
+ * past its byte budget the least recently used glyphs are dropped and the
+ * buffers compacted. Glyphs used since the last beginUpdate() are never
+ * dropped, so all glyphs of the text being drawn stay valid.
+ */
+class GlyphAtlas
+{
+public:
+    struct Cell
+    {
+        int width = 0;   // glyph bitmap, without outline
+        int height = 0;
+        int advance = 0;
+        int xmin = 0;
+        int ymin = 0;
+        int cellWidth = 0;  // width + 2 * stroke
+        int cellHeight = 0; // height + 2 * stroke
+        size_t pixels = 0;  // offset of the cell in the pixel buffer
+        size_t rows = 0;    // offset of the cell's cellHeight + 1 row starts
+        uint64_t lastUse = 0;
+    };
+
+    // Drop all glyphs and set the colours (BGRA), outline width and the
+    // memory budget for cached glyphs.
+    void reset(const uint8_t text[4], const uint8_t stroke[4], int strokeWidth, size_t budgetBytes);
+
+    // Start drawing a new text: glyphs used from here on are kept.
+    void beginUpdate() { updateStart = ++useCounter; }
+
+    // Composite a glyph from its 8-bit coverage bitmap and store it.
+    const Cell *add(uint32_t codepoint, const uint8_t *coverage, int width, int height,
+                    int advance, int xmin, int ymin);
+
+    // Look up a glyph and mark it as recently used.
+    const Cell *find(uint32_t codepoint);
+
+    // Draw 'cell' with its top left outline corner at (x, y), clipped to the
+    // image and to the columns [clipBegin, clipEnd).
+    void blit(const Cell &cell, uint8_t *image, int x, int y, int imageWidth, int imageHeight,
+              int clipBegin = 0, int clipEnd = INT_MAX) const;
+
+    int stroke() const { return strokeWidth; }
+    size_t size() const { return cells.size(); }
+    size_t bytes() const
+    {
+        return pixelData.size() + spans.size() * sizeof(Span) + rowStarts.size() * sizeof(uint32_t);
+    }
+    uint32_t evictions() const { return evicted; }
+
+private:
+    struct Span
+    {
+        uint16_t x;
+        uint16_t len;
+    };
+
+    uint8_t textColor[4] = {};
+    uint8_t strokeColor[4] = {};
+    int strokeWidth = 0;
+
+    void evict();
+
+    size_t budget = 0;
+    uint64_t useCounter = 0;
+    uint64_t updateStart = 0;
+    uint32_t evicted = 0;
+
+    std::unordered_map<uint32_t, Cell> cells;
+    std::vector<uint8_t> pixelData;
+    std::vector<Span> spans;
+    std::vector<uint32_t> rowStarts; // per row: index of its first span
+
+    // Scratch for the outline mask, reused between glyphs
+    std::vector<uint8_t> strokeMask;
+};
+
+#endif // GLYPH_ATLAS_HPP
@@ -6,7 +6,9 @@
 
 #define MODULE "IMPAUDIO"
 
-static thread_local IMPAudioEncoder *encoder = nullptr;
+// Not thread_local: the encoder is created on the capture thread but the
+// AENC callbacks run on AudioWorker's encode thread.
+static IMPAudioEncoder *encoder = nullptr;
 
 static int openEncoder(void* attr, void* enc)
 {
@@ -26,9 +28,10 @@ static int closeEncoder(void* enc)
 IMPAudio *IMPAudio::createNew(
     int devId,
     int inChn,
-    int aeChn)
+    int aeChn,
+    int audioChn)
 {
-    return new IMPAudio(devId, inChn, aeChn);
+    return new IMPAudio(devId, inChn, aeChn, audioChn);
 }
 
 int IMPAudio::init()
@@ -71,10 +74,11 @@ int IMPAudio::init()
     {
         format = IMPAudioFormat::OPUS;
         bitrate = cfg->audio.input_bitrate;
-        // RFC 7587: Use 20 ms Opus packets over RTP (unified across all platforms)
+        // Capture in 20 ms frames on all platforms; AudioWorker accumulates
+        // them into audio.opus_frame_duration sized packets
         frameDuration = 0.020f;
-        LOG_INFO("Opus: Using 20ms frame duration per RFC 7587 across all platforms");
-        encoder = Opus::createNew(ioattr.samplerate, outChnCnt);
+        LOG_INFO("Opus: Using " << cfg->audio.opus_frame_duration << "ms packets");
+        encoder = Opus::createNew(ioattr.samplerate, outChnCnt, audioChn);
     }
     else if (strcmp(cfg->audio.input_format, "AAC") == 0)
     {
@@ -132,7 +136,8 @@ int IMPAudio::init()
     if (encoder)
     {
         IMPAudioEncEncoder enc;
-        enc.maxFrmLen = 1024; // Maximum code stream length
+        // Maximum code stream length, a 60 ms Opus packet can exceed 1 KiB
+        enc.maxFrmLen = format == IMPAudioFormat::OPUS ? Opus::MAX_PACKET_BYTES : 1024;
         std::snprintf(enc.name, sizeof(enc.name), "%s", cfg->audio.input_format);
         enc.openEncoder = openEncoder;
         enc.encoderFrm = encodeFrame;
@@ -28,9 +28,12 @@ public:
 class IMPAudio
 {
 public:
-    static IMPAudio *createNew(int devId, int inChn, int aeChn);
+    // 'audioChn' is the index in global_audio, where the encoder finds the
+    // feedback of the RTSP side
+    static IMPAudio *createNew(int devId, int inChn, int aeChn, int audioChn);
 
-    IMPAudio(int devId, int inChn, int aeChn) : devId(devId), inChn(inChn), aeChn(aeChn)
+    IMPAudio(int devId, int inChn, int aeChn, int audioChn)
+        : devId(devId), inChn(inChn), aeChn(aeChn), audioChn(audioChn)
     {
         if (init() != 0) {
             throw std::runtime_error("Failed to initialize IMPAudio - hardware may not be properly initialized");
@@ -51,6 +54,7 @@ public:
     int devId{};
     int inChn{};
     int aeChn{};
+    int audioChn{};
     int outChnCnt = 1;
 
 private:
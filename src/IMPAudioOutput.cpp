@@ -0,0 +1,139 @@
+#include "IMPAudioOutput.hpp"
+
+#include <algorithm>
+#include <cstring>
+
+#define MODULE "IMPAudioOutput"
+
+IMPAudioOutput *IMPAudioOutput::createNew(int devId, int chn, int sampleRate)
+{
+    return new IMPAudioOutput(devId, chn, sampleRate);
+}
+
+int IMPAudioOutput::init()
+{
+    LOG_DEBUG("IMPAudioOutput::init()");
+    int ret;
+
+    int samplesPerFrame = sampleRate / 50; // 20 ms
+    IMPAudioIOAttr attr = {
+        .samplerate = static_cast<IMPAudioSampleRate>(sampleRate),
+        .bitwidth = AUDIO_BIT_WIDTH_16,
+        .soundmode = AUDIO_SOUND_MODE_MONO,
+        .frmNum = 20,
+        .numPerFrm = samplesPerFrame,
+        .chnCnt = 1
+    };
+
+    ret = IMP_AO_SetPubAttr(devId, &attr);
+    LOG_DEBUG_OR_ERROR(ret, "IMP_AO_SetPubAttr(" << devId << ")");
+    if (ret != 0)
+        return ret;
+
+    ret = IMP_AO_Enable(devId);
+    LOG_DEBUG_OR_ERROR(ret, "IMP_AO_Enable(" << devId << ")");
+    if (ret != 0)
+        return ret;
+
+    ret = IMP_AO_EnableChn(devId, chn);
+    LOG_DEBUG_OR_ERROR(ret, "IMP_AO_EnableChn(" << devId << ", " << chn << ")");
+    if (ret != 0)
+    {
+        IMP_AO_Disable(devId);
+        return ret;
+    }
+
+    ret = IMP_AO_SetVol(devId, chn, cfg->audio.output_vol);
+    LOG_DEBUG_OR_ERROR(ret, "IMP_AO_SetVol(" << devId << ", " << chn << ", " << cfg->audio.output_vol << ")");
+
+    ret = IMP_AO_SetGain(devId, chn, cfg->audio.output_gain);
+    LOG_DEBUG_OR_ERROR(ret, "IMP_AO_SetGain(" << devId << ", " << chn << ", " << cfg->audio.output_gain << ")");
+
+    frameBuffer.assign(samplesPerFrame, 0);
+    frameFill = 0;
+    playing = false;
+    ready = true;
+
+    LOG_INFO("Audio output ready: " << sampleRate << " Hz, " << samplesPerFrame << " samples per frame");
+    return 0;
+}
+
+void IMPAudioOutput::deinit()
+{
+    if (!ready)
+        return;
+
+    LOG_DEBUG("IMPAudioOutput::deinit()");
+    int ret;
+
+    ret = IMP_AO_ClearChnBuf(devId, chn);
+    LOG_DEBUG_OR_ERROR(ret, "IMP_AO_ClearChnBuf(" << devId << ", " << chn << ")");
+
+    ret = IMP_AO_DisableChn(devId, chn);
+    LOG_DEBUG_OR_ERROR(ret, "IMP_AO_DisableChn(" << devId << ", " << chn << ")");
+
+    ret = IMP_AO_Disable(devId);
+    LOG_DEBUG_OR_ERROR(ret, "IMP_AO_Disable(" << devId << ")");
+
+    ready = false;
+}
+
+bool IMPAudioOutput::sendFrame()
+{
+    if (playing)
+    {
+        IMPAudioOChnState state;
+        if (IMP_AO_QueryChnStat(devId, chn, &state) == 0 && state.chnBusyNum == 0)
+        {
+            underrunCount++;
+            LOG_DEBUG("Audio output underrun (" << underrunCount << ")");
+        }
+    }
+
+    IMPAudioFrame frame = {};
+    frame.bitwidth = AUDIO_BIT_WIDTH_16;
+    frame.soundmode = AUDIO_SOUND_MODE_MONO;
+    frame.virAddr = reinterpret_cast<uint32_t *>(frameBuffer.data());
+    frame.len = static_cast<int>(frameBuffer.size() * sizeof(int16_t));
+
+    int ret = IMP_AO_SendFrame(devId, chn, &frame, BLOCK);
+    if (ret != 0)
+    {
+        LOG_ERROR("IMP_AO_SendFrame(" << devId << ", " << chn << ") failed: " << ret);
+        return false;
+    }
+
+    playing = true;
+    frameFill = 0;
+    return true;
+}
+
+bool IMPAudioOutput::write(const int16_t *pcm, size_t samples)
+{
+    if (!ready)
+        return false;
+
+    while (samples > 0)
+    {
+        size_t n = std::min(samples, frameBuffer.size() - frameFill);
+        std::memcpy(frameBuffer.data() + frameFill, pcm, n * sizeof(int16_t));
+        frameFill += n;
+        pcm += n;
+        samples -= n;
+
+        if (frameFill == frameBuffer.size() && !sendFrame())
+            return false;
+    }
+    return true;
+}
+
+void IMPAudioOutput::flush()
+{
+    if (ready && frameFill > 0)
+    {
+        std::fill(frameBuffer.begin() + frameFill, frameBuffer.end(), 0);
+        sendFrame();
+    }
+    // A pause between sessions is not an underrun
+    playing = false;
+}
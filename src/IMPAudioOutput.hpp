@@ -0,0 +1,54 @@
+#ifndef IMPAudioOutput_hpp
+#define IMPAudioOutput_hpp
+
+#include "Config.hpp"
+#include "Logger.hpp"
+#include <imp/imp_audio.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+/* In-process speaker output through the IMP AO API.
+ *
+ * The device is opened once and kept enabled between talk sessions, so a new
+ * session only has to start sending frames. PCM of any block size is
+ * collected into AO sized frames (20 ms) before IMP_AO_SendFrame.
+ */
+class IMPAudioOutput
+{
+public:
+    static IMPAudioOutput *createNew(int devId, int chn, int sampleRate);
+
+    IMPAudioOutput(int devId, int chn, int sampleRate)
+        : devId(devId), chn(chn), sampleRate(sampleRate) {}
+    ~IMPAudioOutput() { deinit(); }
+
+    int init();
+    void deinit();
+    bool isReady() const { return ready; }
+
+    // Queue mono PCM for playback; blocks while the AO buffer is full.
+    bool write(const int16_t *pcm, size_t samples);
+    // Play out a partial frame at the end of a session.
+    void flush();
+
+    uint32_t underruns() const { return underrunCount; }
+
+private:
+    bool sendFrame();
+
+    int devId;
+    int chn;
+    int sampleRate;
+    bool ready = false;
+
+    std::vector<int16_t> frameBuffer;
+    size_t frameFill = 0;
+
+    // Underrun: the AO ran dry while a session was still playing
+    bool playing = false;
+    uint32_t underrunCount = 0;
+};
+
+#endif // IMPAudioOutput_hpp
@@ -5,7 +5,9 @@
 #include "IMPAudio.hpp"
 #include "IMPDeviceSource.hpp"
 #include "IMPAudioServerMediaSubsession.hpp"
+#include "OpusSink.hpp"
 #include "SimpleRTPSink.hh"
+#include <algorithm>
 #include <cstdio>
 #include <cstring>
 
@@ -23,10 +25,19 @@ IMPAudioServerMediaSubsession::IMPAudioServerMediaSubsession(
       audioChn(audioChn)
 {
     LOG_INFO("IMPAudioServerMediaSubsession init");
+
+    std::lock_guard<std::mutex> lock(global_audio[audioChn]->rtcpLossLock);
+    global_audio[audioChn]->rtcpLossReports.push_back(&lossPercent);
 }
 
 IMPAudioServerMediaSubsession::~IMPAudioServerMediaSubsession()
 {
+    {
+        std::lock_guard<std::mutex> lock(global_audio[audioChn]->rtcpLossLock);
+        auto &reports = global_audio[audioChn]->rtcpLossReports;
+        reports.erase(std::remove(reports.begin(), reports.end(), &lossPercent), reports.end());
+    }
+
     if (fAuxSDPLine) {
         delete[] fAuxSDPLine;
         fAuxSDPLine = nullptr;
@@ -84,16 +95,17 @@ RTPSink* IMPAudioServerMediaSubsession::createNewRTPSink(
         break;
     case IMPAudioFormat::OPUS:
         // RFC 7587: Opus over RTP MUST use a 48 kHz RTP timestamp clock, regardless of
-        // the encoder's input sample rate. With unified 20 ms packetization, each RTP
-        // timestamp MUST advance by 960 ticks (0.020 * 48000) per packet.
+        // the encoder's input sample rate. Each RTP timestamp advances by 48 ticks per
+        // ms of packet duration (960 for the default 20 ms packets).
         // Application-level frames (IMPAudio/AudioWorker) use wall-clock PTS based on
         // the actual input sample rate for accumulation and pacing; live555 maps these
-        // to RTP timestamps using the frequency specified below (48000).
-        rtpTimestampFrequency = 48000;
-        rtpPayloadFormatName = "OPUS";
-        allowMultipleFramesPerPacket = false; // one Opus packet per RTP packet
-        outChnCnt = cfg->audio.force_stereo ? 2 : 1;
-        break;
+        // to RTP timestamps using the 48000 clock set up by OpusSink.
+        // RFC 7587 (SDP Considerations): a=rtpmap MUST use 48000/2 for Opus
+        // Always advertise 2 channels in SDP for Opus, regardless of actual encoded channels.
+        return OpusSink::createNew(
+            envir(), rtpGroupsock, rtpPayloadFormat,
+            /* numChannels */ 2,
+            /* packetDurationMs */ cfg->audio.opus_frame_duration);
     case IMPAudioFormat::AAC:
         return AACSink::createNew(
             envir(), rtpGroupsock, rtpPayloadFormat, rtpTimestampFrequency,
@@ -102,18 +114,11 @@ RTPSink* IMPAudioServerMediaSubsession::createNewRTPSink(
 
     LOG_DEBUG("createNewRTPSink: " << rtpPayloadFormatName << ", " << rtpTimestampFrequency);
 
-    // RFC 7587 (SDP Considerations): a=rtpmap MUST use 48000/2 for Opus
-    // Always advertise 2 channels in SDP for Opus, regardless of actual encoded channels.
-    int sdpChannels = outChnCnt;
-    if (global_audio[audioChn]->imp_audio->format == IMPAudioFormat::OPUS) {
-        sdpChannels = 2;
-    }
-
     return SimpleRTPSink::createNew(
         envir(), rtpGroupsock, rtpPayloadFormat, rtpTimestampFrequency,
         /* sdpMediaTypeString*/ "audio",
         rtpPayloadFormatName,
-        /* numChannels */ sdpChannels,
+        /* numChannels */ outChnCnt,
         allowMultipleFramesPerPacket);
 }
 
@@ -125,8 +130,12 @@ char const* IMPAudioServerMediaSubsession::getAuxSDPLine(RTPSink* rtpSink, Frame
         unsigned maxavg = (unsigned)(cfg->audio.input_bitrate * 1000); // bps
         char buf[256];
         int n = snprintf(buf, sizeof(buf),
-                         "a=fmtp:%u stereo=0; sprop-stereo=0; maxplaybackrate=48000; maxaveragebitrate=%u\r\n",
-                         pt, maxavg);
+                         "a=fmtp:%u stereo=0; sprop-stereo=0; maxplaybackrate=48000; maxaveragebitrate=%u%s%s\r\n"
+                         "a=ptime:%d\r\n",
+                         pt, maxavg,
+                         cfg->audio.opus_fec ? "; useinbandfec=1" : "",
+                         cfg->audio.opus_dtx ? "; usedtx=1" : "",
+                         cfg->audio.opus_frame_duration);
         if (n > 0) {
             if (fAuxSDPLine) { delete[] fAuxSDPLine; fAuxSDPLine = nullptr; }
             fAuxSDPLine = new char[(size_t)n + 1];
@@ -136,3 +145,56 @@ char const* IMPAudioServerMediaSubsession::getAuxSDPLine(RTPSink* rtpSink, Frame
     }
     return OnDemandServerMediaSubsession::getAuxSDPLine(rtpSink, inputSource);
 }
+
+RTCPInstance* IMPAudioServerMediaSubsession::createRTCP(
+    Groupsock* RTCPgs,
+    unsigned totSessionBW,
+    unsigned char const* cname,
+    RTPSink* sink)
+{
+    RTCPInstance* rtcp = OnDemandServerMediaSubsession::createRTCP(RTCPgs, totSessionBW, cname, sink);
+
+    // Receiver reports drive the Opus in-band FEC redundancy
+    if (rtcp != nullptr && sink != nullptr && cfg->audio.opus_fec &&
+        global_audio[audioChn]->imp_audio->format == IMPAudioFormat::OPUS)
+    {
+        rrSink = sink;
+        rtcp->setRRHandler(onReceiverReport, this);
+    }
+    return rtcp;
+}
+
+void IMPAudioServerMediaSubsession::closeStreamSource(FramedSource* inputSource)
+{
+    // The last client of this subsession left and its RTCP instance is gone:
+    // nobody reports its loss anymore. Other video streams have their own
+    // audio subsession and keep theirs.
+    lossPercent.store(0, std::memory_order_relaxed);
+
+    OnDemandServerMediaSubsession::closeStreamSource(inputSource);
+}
+
+void IMPAudioServerMediaSubsession::onReceiverReport(void* clientData)
+{
+    IMPAudioServerMediaSubsession* self = static_cast<IMPAudioServerMediaSubsession*>(clientData);
+
+    // Fraction lost since the previous report, 8 bit fixed point
+    unsigned lossRatio = 0;
+    RTPTransmissionStatsDB::Iterator it(self->rrSink->transmissionStatsDB());
+    RTPTransmissionStats* stats;
+    while ((stats = it.next()) != nullptr)
+    {
+        lossRatio = std::max<unsigned>(lossRatio, stats->packetLossRatio());
+    }
+
+    // Follow the worst client of this subsession up immediately, decay
+    // slowly once it recovers
+    int reported = (int)(lossRatio * 100 / 256);
+    int current = self->lossPercent.load(std::memory_order_relaxed);
+    int next = std::max(reported, current * 3 / 4);
+    if (next != current)
+    {
+        self->lossPercent.store(next, std::memory_order_relaxed);
+        LOG_DEBUG("RTCP audio packet loss " << reported << "%, FEC target " << next << "%");
+    }
+}
@@ -3,6 +3,8 @@
 
 #include "OnDemandServerMediaSubsession.hh"
 
+#include <atomic>
+
 class IMPAudioServerMediaSubsession : public OnDemandServerMediaSubsession
 {
 public:
@@ -23,13 +25,28 @@ protected:
         Groupsock* rtpGroupsock,
         unsigned char rtpPayloadTypeIfDynamic,
         FramedSource* inputSource);
+    virtual void closeStreamSource(FramedSource* inputSource);
 
 protected:
     virtual char const* getAuxSDPLine(RTPSink* rtpSink, FramedSource* inputSource);
+    virtual RTCPInstance* createRTCP(
+        Groupsock* RTCPgs,
+        unsigned totSessionBW,
+        unsigned char const* cname,
+        RTPSink* sink);
 
 private:
+    static void onReceiverReport(void* clientData);
+
     int audioChn;
     char* fAuxSDPLine = nullptr;
+    // Loss reported by this subsession's clients, registered with
+    // global_audio[audioChn] for the Opus encoder
+    std::atomic<int> lossPercent{0};
+    // Sink of the shared stream whose receiver reports drive the Opus FEC.
+    // Its RTCP instance, the only caller of onReceiverReport, is closed
+    // before the sink.
+    RTPSink* rrSink = nullptr;
 };
 
 #endif // IMPAudioServerMediaSubsession_hpp
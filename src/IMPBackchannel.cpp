@@ -219,7 +219,9 @@ void IMPBackchannel::deinit()
     LOG_DEBUG("IMPBackchannel::deinit()");
     int ret;
 
+// Opus is decoded in software by the worker and has no ADEC channel
 #define DESTROY_ADEC(EnumName, NameString, PayloadType, Frequency, MimeType) \
+    if (IMPBackchannelFormat::EnumName != IMPBackchannelFormat::OPUS) \
     { \
         int adChn = (int) IMPBackchannelFormat::EnumName; \
         ret = IMP_ADEC_DestroyChn(adChn); \
@@ -24,15 +24,22 @@
  *      payload, signaling the end of a session).
  *   4. Audio Processing and Session Management: The BackchannelWorker
  *      dequeues frames from the queue, decodes the audio data using the
- *      IMP audio SDK, and resamples it if necessary. It maintains a
- *      concept of a "current" session, processing only frames from that
- *      session and discarding frames from other sessions.
- *   5. Audio Output: The decoded PCM audio is then sent to a pipe, where
- *      the `/bin/iac` program receives the data and handles the audio
- *      output.
+ *      IMP audio SDK (libopus for Opus, which has no IMP decoder), and
+ *      resamples it if necessary. Every talking
+ *      session (up to four) has its own jitter buffer, resampler and
+ *      concealment state. AAC is decoded by a stateful ADEC channel that
+ *      cannot be shared, so only one AAC session is mixed at a time. The JitterBuffer restores RTP sequence order,
+ *      plays packets out a fixed delay after arrival and conceals packets
+ *      that are lost or arrive too late. Sessions are added on their first
+ *      frame and removed once their stop frame has been played out; every
+ *      20 ms their PCM is summed with saturation into one output block.
+ *   5. Audio Output: The decoded PCM audio is played through the IMP AO
+ *      device (IMPAudioOutput), which is opened once when the worker
+ *      starts. If AO is disabled or unavailable, it is sent to a pipe
+ *      instead, where the `/bin/iac` program handles the audio output.
  *
  *  The IMPBackchannel class is responsible for:
- *   - Registering and managing audio decoders (e.g., Opus) with the IMP
+ *   - Registering and managing audio decoders (e.g., AAC) with the IMP
  *     audio SDK.
  *   - Creating and destroying the IMP audio channels used for decoding.
  */
@@ -45,6 +52,7 @@
     X(AAC, "MPEG4-GENERIC", 97, cfg->audio.output_sample_rate, "audio/mpeg4-generic") \
     X(PCMU, "PCMU", 0, 8000, "audio/PCMU") \
     X(PCMA, "PCMA", 8, 8000, "audio/PCMA") \
+    X(OPUS, "opus", 98, 48000, "audio/OPUS") \
     /* Add new formats here */
 
 #define APPLY_ENUM(EnumName, NameString, PayloadType, Frequency, MimeType) EnumName,
@@ -96,6 +104,14 @@ public:
         return 0;
     }
 
+    // The ADEC channels exist once per format. AAC carries state from frame
+    // to frame (the overlap-add tail, in one thread-local helix decoder), so
+    // only one session at a time may decode it; G.711 has no state to mix up.
+    static bool hasStatefulDecoder(IMPBackchannelFormat format)
+    {
+        return format == IMPBackchannelFormat::AAC;
+    }
+
     static const char *getFormatMimeType(IMPBackchannelFormat format)
     {
 #define RETURN_MIME_TYPE(EnumName, NameString, PayloadType, Frequency, MimeType) \
@@ -2,6 +2,8 @@
 #include <iostream>
 #include "GroupsockHelper.hh"
 #include "WorkerUtils.hpp"
+#include "AVSyncMonitor.hpp"
+#include <type_traits>
 
 // explicit instantiation
 template class IMPDeviceSource<H264NALUnit, video_stream>;
@@ -78,6 +80,11 @@ void IMPDeviceSource<FrameType, Stream>::deliverFrame()
 
         fPresentationTime = nal.time;
 
+        if constexpr (std::is_same_v<FrameType, H264NALUnit>)
+            AVSyncMonitor::videoDelivered(encChn, fPresentationTime);
+        else
+            AVSyncMonitor::audioDelivered(fPresentationTime);
+
         // TIMESTAMP DEBUG: Log RTP presentation time assignment
         LOG_DEBUG("RTP_TIMESTAMP_3_PRESENTATION: fPresentationTime.tv_sec=" << fPresentationTime.tv_sec << " fPresentationTime.tv_usec=" << fPresentationTime.tv_usec);
 
@@ -24,6 +24,176 @@ void IMPEncoder::flush(int encChn)
     IMP_Encoder_FlushStream(encChn);
 }
 
+int IMPEncoder::setIdle(bool idle)
+{
+    // an idle value of 0 keeps the configured one
+    int fps = (idle && stream->idle_fps > 0) ? stream->idle_fps : stream->fps;
+    int bitrate = (idle && stream->idle_bitrate > 0) ? stream->idle_bitrate : stream->bitrate;
+    int gop = (idle && stream->idle_gop > 0) ? stream->idle_gop : stream->gop;
+
+    LOG_INFO("Encoder channel " << encChn << " " << (idle ? "idle" : "active") << " profile: " <<
+             "fps:" << fps << ", bps:" << bitrate << ", gop:" << gop);
+
+    int ret;
+    IMPEncoderFrmRate frmRate{};
+    frmRate.frmRateNum = fps;
+    frmRate.frmRateDen = 1;
+    ret = IMP_Encoder_SetChnFrmRate(encChn, &frmRate);
+    LOG_DEBUG_OR_ERROR(ret, "IMP_Encoder_SetChnFrmRate(" << encChn << ", " << fps << ")");
+
+#if defined(PLATFORM_T31) || defined(PLATFORM_C100) || defined(PLATFORM_T40) || defined(PLATFORM_T41)
+    if (strcmp(stream->mode, "FIXQP") != 0)
+    {
+        ret = IMP_Encoder_SetChnBitRate(encChn, bitrate, bitrate);
+        LOG_DEBUG_OR_ERROR(ret, "IMP_Encoder_SetChnBitRate(" << encChn << ", " << bitrate << ")");
+    }
+
+    ret = IMP_Encoder_SetChnGopLength(encChn, gop);
+    LOG_DEBUG_OR_ERROR(ret, "IMP_Encoder_SetChnGopLength(" << encChn << ", " << gop << ")");
+#elif defined(PLATFORM_T10) || defined(PLATFORM_T20) || defined(PLATFORM_T21) || defined(PLATFORM_T23) || defined(PLATFORM_T30)
+    IMPEncoderAttrRcMode rcMode;
+    ret = IMP_Encoder_GetChnAttrRcMode(encChn, &rcMode);
+    LOG_DEBUG_OR_ERROR(ret, "IMP_Encoder_GetChnAttrRcMode(" << encChn << ")");
+    if (ret == 0)
+    {
+        switch (rcMode.rcMode)
+        {
+        case ENC_RC_MODE_CBR:
+            rcMode.attrH264Cbr.outBitRate = bitrate;
+            break;
+        case ENC_RC_MODE_VBR:
+            rcMode.attrH264Vbr.maxBitRate = bitrate;
+            break;
+        case ENC_RC_MODE_SMART:
+#if defined(PLATFORM_T30)
+            if (chnAttr.encAttr.enType == PT_H265)
+            {
+                rcMode.attrH265Smart.maxBitRate = bitrate;
+                break;
+            }
+#endif
+            rcMode.attrH264Smart.maxBitRate = bitrate;
+            break;
+        default:
+            break;
+        }
+        ret = IMP_Encoder_SetChnAttrRcMode(encChn, &rcMode);
+        LOG_DEBUG_OR_ERROR(ret, "IMP_Encoder_SetChnAttrRcMode(" << encChn << ", " << bitrate << ")");
+    }
+
+    IMPEncoderGOPSizeCfg gopCfg{};
+    gopCfg.gopsize = gop;
+    ret = IMP_Encoder_SetGOPSize(encChn, &gopCfg);
+    LOG_DEBUG_OR_ERROR(ret, "IMP_Encoder_SetGOPSize(" << encChn << ", " << gop << ")");
+#endif
+
+    // the new parameters apply from a clean reference
+    ret = IMP_Encoder_RequestIDR(encChn);
+    LOG_DEBUG_OR_ERROR(ret, "IMP_Encoder_RequestIDR(" << encChn << ")");
+
+    return ret;
+}
+
+int IMPEncoder::setROIWindow(int index, const PixelRect &rect, int qp)
+{
+    IMPEncoderROICfg roiCfg{};
+    roiCfg.u32Index = index;
+    roiCfg.bEnable = !rect.empty();
+    roiCfg.bRelatedQp = 1;
+    roiCfg.s32Qp = qp;
+    // a disabled window keeps its last, valid, rectangle
+    const PixelRect &r = rect.empty() ? roiWindows[index] : rect;
+    roiCfg.rect.p0.x = r.x0;
+    roiCfg.rect.p0.y = r.y0;
+    roiCfg.rect.p1.x = std::max(r.x1 - 1, r.x0);
+    roiCfg.rect.p1.y = std::max(r.y1 - 1, r.y0);
+
+    int ret = IMP_Encoder_SetChnROI(encChn, &roiCfg);
+    LOG_DEBUG_OR_ERROR(ret, "IMP_Encoder_SetChnROI(" << encChn << ", " << index << ", " <<
+                       r.x0 << "," << r.y0 << " - " << r.x1 << "," << r.y1 << ", qp:" << qp <<
+                       (rect.empty() ? ", off)" : ")"));
+    if (ret == 0)
+        roiWindows[index] = rect;
+
+    return ret;
+}
+
+void IMPEncoder::setROIAreas(const std::vector<PixelRect> &areas, int srcWidth, int srcHeight)
+{
+    if (srcWidth <= 0 || srcHeight <= 0)
+        return;
+
+    // scale to the stream and grow to whole macroblocks
+    auto toStream = [&](const PixelRect &a) {
+        PixelRect r;
+        r.x0 = a.x0 * stream->width / srcWidth / 16 * 16;
+        r.y0 = a.y0 * stream->height / srcHeight / 16 * 16;
+        r.x1 = std::min((a.x1 * stream->width / srcWidth + 15) / 16 * 16, stream->width);
+        r.y1 = std::min((a.y1 * stream->height / srcHeight + 15) / 16 * 16, stream->height);
+        return r;
+    };
+
+    std::array<PixelRect, ROI_WINDOWS> wanted{};
+    for (size_t i = 0; i < areas.size(); i++)
+    {
+        PixelRect r = toStream(areas[i]);
+        if (r.empty())
+            continue;
+
+        // more areas than windows: the last window covers all the rest
+        size_t w = std::min<size_t>(i + 1, ROI_WINDOWS - 1);
+        if (!wanted[w].empty())
+        {
+            r.x0 = std::min(r.x0, wanted[w].x0);
+            r.y0 = std::min(r.y0, wanted[w].y0);
+            r.x1 = std::max(r.x1, wanted[w].x1);
+            r.y1 = std::max(r.y1, wanted[w].y1);
+        }
+        wanted[w] = r;
+    }
+
+    for (int i = 1; i < ROI_WINDOWS; i++)
+    {
+        if (!(wanted[i] == roiWindows[i]))
+            setROIWindow(i, wanted[i], stream->roi_qp_active);
+    }
+}
+
+void IMPEncoder::initROI()
+{
+    roiWindows.fill({});
+
+    if (strcmp(stream->format, "JPEG") == 0 || strcmp(stream->roi_qp_mode, "off") == 0)
+        return;
+
+    if (stream->roi_qp_background != 0)
+        setROIWindow(0, {0, 0, stream->width, stream->height}, stream->roi_qp_background);
+
+    if (strcmp(stream->roi_qp_mode, "static") == 0)
+    {
+        // the motion regions, in the monitored stream's frame until motion
+        // detection has set frame_width/height
+        _stream *monitor = cfg->motion.monitor_stream == 0 ? &cfg->stream0 : &cfg->stream1;
+        int fw = cfg->motion.frame_width != IVS_AUTO_VALUE ? cfg->motion.frame_width : monitor->width;
+        int fh = cfg->motion.frame_height != IVS_AUTO_VALUE ? cfg->motion.frame_height : monitor->height;
+
+        std::vector<PixelRect> areas;
+        for (int i = 0; i < cfg->motion.roi_count && i < (int) cfg->motion.rois.size(); i++)
+        {
+            const roi &r = cfg->motion.rois[i];
+            PixelRect area{r.p0_x, r.p0_y, r.p1_x, r.p1_y};
+            if (i == 0 && area.empty())
+            {
+                // as in Motion, roi_0_x..roi_1_y stand in for rois.roi_0
+                area = {cfg->motion.roi_0_x, cfg->motion.roi_0_y,
+                        std::min(cfg->motion.roi_1_x, fw), std::min(cfg->motion.roi_1_y, fh)};
+            }
+            areas.push_back(area);
+        }
+        setROIAreas(areas, fw, fh);
+    }
+}
+
 void MakeTables(int q, uint8_t *lqt, uint8_t *cqt)
 {
     // Ensure q is within the expected range
@@ -325,6 +495,8 @@ int IMPEncoder::init()
     ret = IMP_Encoder_RegisterChn(encGrp, encChn);
     LOG_DEBUG_OR_ERROR_AND_EXIT(ret, "IMP_Encoder_RegisterChn(" << encGrp << ", " << encChn << ")");
 
+    initROI();
+
     if (strcmp(stream->format, "JPEG") != 0)
     {
         ret = IMP_Encoder_CreateGroup(encGrp);
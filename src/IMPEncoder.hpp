@@ -2,6 +2,7 @@
 #define IMPEncoder_hpp
 
 #include <array>
+#include <vector>
 #include "Logger.hpp"
 #include "Config.hpp"
 #include "OSD.hpp"
@@ -13,6 +14,15 @@
 #define IMPEncoderCHNStat IMPEncoderChnStat
 #endif
 
+// Rectangle in pixels, end exclusive
+struct PixelRect
+{
+    int x0, y0, x1, y1;
+
+    bool empty() const { return x1 <= x0 || y1 <= y0; }
+    bool operator==(const PixelRect &) const = default;
+};
+
 static const std::array<int, 64> jpeg_chroma_quantizer = {{17, 18, 24, 47, 99, 99, 99, 99,
                                                            18, 21, 26, 66, 99, 99, 99, 99,
                                                            24, 26, 56, 99, 99, 99, 99, 99,
@@ -50,11 +60,27 @@ public:
     int destroy();
     static void flush(int encChn);
 
+    // Switch the running channel between the configured rate, bitrate and
+    // GOP and the stream's idle_* values, starting with an IDR
+    int setIdle(bool idle);
+
+    // Encoder ROIs (stream->roi_qp_mode): window 0 raises the QP of the
+    // whole frame by roi_qp_background, the others lower it by roi_qp_active
+    // on 'areas' (given in a srcWidth x srcHeight frame). Only windows that
+    // change are sent to the encoder.
+    void setROIAreas(const std::vector<PixelRect> &areas, int srcWidth, int srcHeight);
+
     OSD *osd = nullptr;
 
 private:
     IMPEncoderCHNAttr chnAttr{};
     void initProfile();
+    void initROI();
+
+    // Later windows take priority where they overlap
+    static constexpr int ROI_WINDOWS = 8;
+    std::array<PixelRect, ROI_WINDOWS> roiWindows{}; // as applied, empty = off
+    int setROIWindow(int index, const PixelRect &rect, int qp);
 
     IMPCell fs{};
     IMPCell enc{};
@@ -0,0 +1,166 @@
+#include "ImageRotate.hpp"
+
+#include <algorithm>
+#include <climits>
+#include <cmath>
+#include <cstring>
+
+namespace ImageRotate {
+
+static inline void copyPixel(uint8_t *dst, const uint8_t *src)
+{
+    memcpy(dst, src, 4);
+}
+
+// Quarter turns, dst is height x width. Both images are walked in square
+// blocks so the column-wise side stays within a few cache lines.
+static void rotateQuarter(const uint8_t *src, int width, int height, uint8_t *dst, int quarter)
+{
+    constexpr int BLOCK = 16;
+
+    for (int by = 0; by < height; by += BLOCK)
+    {
+        int yEnd = std::min(by + BLOCK, height);
+        for (int bx = 0; bx < width; bx += BLOCK)
+        {
+            int xEnd = std::min(bx + BLOCK, width);
+            for (int y = by; y < yEnd; ++y)
+            {
+                const uint8_t *srcRow = src + y * width * 4;
+                if (quarter == 1)
+                {
+                    // src (x, y) -> dst (height - 1 - y, x)
+                    uint8_t *dstCol = dst + (height - 1 - y) * 4;
+                    for (int x = bx; x < xEnd; ++x)
+                        copyPixel(dstCol + x * height * 4, srcRow + x * 4);
+                }
+                else
+                {
+                    // src (x, y) -> dst (y, width - 1 - x)
+                    uint8_t *dstCol = dst + y * 4;
+                    for (int x = bx; x < xEnd; ++x)
+                        copyPixel(dstCol + (width - 1 - x) * height * 4, srcRow + x * 4);
+                }
+            }
+        }
+    }
+}
+
+static void rotateHalf(const uint8_t *src, int width, int height, uint8_t *dst)
+{
+    for (int y = 0; y < height; ++y)
+    {
+        const uint8_t *srcRow = src + y * width * 4;
+        uint8_t *dstRow = dst + ((height - 1 - y) * width + width - 1) * 4;
+        for (int x = 0; x < width; ++x)
+            copyPixel(dstRow - x * 4, srcRow + x * 4);
+    }
+}
+
+// Truncate a 16.16 fixed point value toward zero, like a cast from double
+static inline int fixedToInt(int32_t v)
+{
+    return v >= 0 ? v >> 16 : -(-v >> 16);
+}
+
+void rotateBGRA(const uint8_t *input, uint16_t &width, uint16_t &height, int angle,
+                std::vector<uint8_t> &output)
+{
+    angle %= 360;
+    if (angle < 0)
+        angle += 360;
+
+    // Right angles are plain pixel moves
+    if (angle == 0)
+    {
+        output.assign(input, input + width * height * 4);
+        return;
+    }
+    if (angle == 180)
+    {
+        output.resize(width * height * 4);
+        rotateHalf(input, width, height, output.data());
+        return;
+    }
+    if (angle == 90 || angle == 270)
+    {
+        output.resize(width * height * 4);
+        rotateQuarter(input, width, height, output.data(), angle == 90 ? 1 : 3);
+        std::swap(width, height);
+        return;
+    }
+
+    double angleRad = angle * (M_PI / 180.0);
+    double cosA = cos(angleRad);
+    double sinA = sin(angleRad);
+
+    int originalCorners[4][2] = {
+        {0, 0},
+        {width, 0},
+        {0, height},
+        {width, height}};
+
+    int minX = INT_MAX;
+    int maxX = INT_MIN;
+    int minY = INT_MAX;
+    int maxY = INT_MIN;
+
+    for (auto &originalCorner : originalCorners)
+    {
+        int x = originalCorner[0];
+        int y = originalCorner[1];
+
+        int newX = static_cast<int>(x * cosA - y * sinA);
+        int newY = static_cast<int>(x * sinA + y * cosA);
+
+        if (newX < minX)
+            minX = newX;
+        if (newX > maxX)
+            maxX = newX;
+        if (newY < minY)
+            minY = newY;
+        if (newY > maxY)
+            maxY = newY;
+    }
+
+    int newWidth = maxX - minX + 1;
+    int newHeight = maxY - minY + 1;
+
+    int centerX = width / 2;
+    int centerY = height / 2;
+
+    int newCenterX = newWidth / 2;
+    int newCenterY = newHeight / 2;
+
+    output.assign(newWidth * newHeight * 4, 0);
+    uint8_t *rotatedImage = output.data();
+
+    // Inverse mapping stepped along each row in 16.16 fixed point, no trig
+    // or floating point per pixel
+    const int32_t cosF = lround(cosA * 65536);
+    const int32_t sinF = lround(sinA * 65536);
+
+    for (int y = 0; y < newHeight; ++y)
+    {
+        int newY = y - newCenterY;
+        int32_t fx = -newCenterX * cosF + newY * sinF;
+        int32_t fy = newCenterX * sinF + newY * cosF;
+        uint8_t *dstRow = rotatedImage + y * newWidth * 4;
+
+        for (int x = 0; x < newWidth; ++x, fx += cosF, fy -= sinF)
+        {
+            int origX = fixedToInt(fx) + centerX;
+            int origY = fixedToInt(fy) + centerY;
+
+            if (origX >= 0 && origX < width && origY >= 0 && origY < height)
+            {
+                copyPixel(dstRow + x * 4, input + (origY * width + origX) * 4);
+            }
+        }
+    }
+
+    width = newWidth;
+    height = newHeight;
+}
+
+} // namespace ImageRotate
@@ -0,0 +1,22 @@
+#ifndef IMAGE_ROTATE_HPP
+#define IMAGE_ROTATE_HPP
+
+#include <cstdint>
+#include <vector>
+
+namespace ImageRotate {
+
+/* Rotate a BGRA image clockwise by 'angle' degrees into 'output'.
+ *
+ * Right angles are exact pixel moves: 180 keeps the size, 90 and 270 swap
+ * 'width' and 'height'. Other angles sample the nearest source pixel into
+ * the bounding box of the rotated image, stepping the inverse mapping in
+ * 16.16 fixed point; uncovered pixels are transparent. 'width' and
+ * 'height' are updated to the output size, 'output' is reused.
+ */
+void rotateBGRA(const uint8_t *input, uint16_t &width, uint16_t &height, int angle,
+                std::vector<uint8_t> &output);
+
+} // namespace ImageRotate
+
+#endif // IMAGE_ROTATE_HPP
@@ -0,0 +1,281 @@
+#include "JitterBuffer.hpp"
+
+#include <algorithm>
+#include <cstdlib>
+
+namespace {
+
+// A sequence jump this large is a new stream (sender restart), not loss
+constexpr int32_t RESYNC_DISTANCE = 1000;
+
+} // namespace
+
+void JitterBuffer::configure(unsigned rate, unsigned targetDelayMs, unsigned maxDelayMs)
+{
+    clockRate = rate > 0 ? rate : 8000;
+    targetDelay = std::chrono::milliseconds(targetDelayMs);
+    maxDelayTicks = (uint32_t) ((uint64_t) std::max(maxDelayMs, targetDelayMs) * clockRate / 1000);
+    reset();
+}
+
+void JitterBuffer::reset()
+{
+    clear();
+    counters = Stats{};
+    jitterQ4 = 0;
+}
+
+void JitterBuffer::clear()
+{
+    for (Slot &slot : slots)
+    {
+        slot.filled = false;
+    }
+    count = 0;
+    started = false;
+    playing = false;
+    frameTicks = clockRate / 50; // assume 20 ms until two packets say otherwise
+    concealed = 0;
+    pendingLost = 0;
+    havePopped = false;
+    haveTransit = false;
+}
+
+uint32_t JitterBuffer::extend(uint16_t seq) const
+{
+    if (!started)
+        return (1u << 16) | seq;
+    return highestSeq + (int16_t) (seq - (uint16_t) highestSeq);
+}
+
+JitterBuffer::Clock::time_point JitterBuffer::dueTime(uint32_t timestamp) const
+{
+    int64_t ticks = (int32_t) (timestamp - baseTimestamp);
+    return baseTime + std::chrono::microseconds(ticks * 1000000 / clockRate);
+}
+
+void JitterBuffer::updateJitter(uint32_t timestamp, Clock::time_point now)
+{
+    int64_t arrivalUs = std::chrono::duration_cast<std::chrono::microseconds>(now.time_since_epoch()).count();
+    int64_t transit = (int32_t) ((uint32_t) (arrivalUs * clockRate / 1000000) - timestamp);
+    if (haveTransit)
+    {
+        uint32_t d = (uint32_t) std::llabs(transit - lastTransit);
+        jitterQ4 += d - ((jitterQ4 + 8) >> 4);
+    }
+    lastTransit = transit;
+    haveTransit = true;
+}
+
+void JitterBuffer::startPlayout(uint32_t extSeq, uint32_t timestamp, Clock::time_point now)
+{
+    nextSeq = extSeq;
+    nextTimestamp = timestamp;
+    baseTimestamp = timestamp;
+    baseTime = now + targetDelay;
+    playing = true;
+    concealed = 0;
+    pendingLost = 0;
+}
+
+void JitterBuffer::skipTo(uint32_t extSeq)
+{
+    while ((int32_t) (extSeq - nextSeq) > 0)
+    {
+        Slot &slot = slotFor(nextSeq);
+        if (slot.filled && slot.seq == nextSeq)
+        {
+            slot.filled = false;
+            count--;
+            counters.overflow++;
+        }
+        else
+        {
+            counters.lost++;
+        }
+        nextSeq++;
+        nextTimestamp += frameTicks;
+    }
+
+    const Slot &slot = slotFor(nextSeq);
+    if (slot.filled && slot.seq == nextSeq)
+        nextTimestamp = slot.timestamp;
+}
+
+void JitterBuffer::trimToMaxDelay(Clock::time_point now)
+{
+    if (count == 0 || (int32_t) (highestTimestamp - nextTimestamp) <= (int32_t) maxDelayTicks)
+        return;
+
+    // Sender clock running fast or a burst after a stall: drop the oldest
+    // packets down to the target delay and restart the playout clock there
+    uint32_t targetTicks = (uint32_t) (std::chrono::duration_cast<std::chrono::microseconds>(targetDelay).count()
+                                       * clockRate / 1000000);
+    while (count > 0 && (int32_t) (highestTimestamp - nextTimestamp) > (int32_t) targetTicks)
+    {
+        skipTo(nextSeq + 1);
+    }
+    baseTimestamp = nextTimestamp;
+    baseTime = now;
+}
+
+bool JitterBuffer::push(uint16_t seq, uint32_t timestamp, std::vector<uint8_t> &payload, Clock::time_point now)
+{
+    uint32_t extSeq = extend(seq);
+    if (!started)
+    {
+        started = true;
+        highestSeq = extSeq;
+        highestTimestamp = timestamp;
+        nextSeq = extSeq;
+    }
+
+    int32_t ahead = (int32_t) (extSeq - nextSeq);
+    if (ahead < -RESYNC_DISTANCE || ahead > RESYNC_DISTANCE)
+    {
+        clear();
+        return push(seq, timestamp, payload, now);
+    }
+    if (ahead < 0)
+    {
+        counters.late++;
+        return false;
+    }
+
+    updateJitter(timestamp, now);
+
+    if (!playing)
+    {
+        // First packet, or the first one after running dry
+        counters.lost += ahead;
+        startPlayout(extSeq, timestamp, now);
+    }
+    else
+    {
+        // Packets concealed while the buffer was empty really were lost
+        counters.lost += pendingLost;
+        pendingLost = 0;
+        if (ahead >= (int32_t) CAPACITY)
+            skipTo(extSeq - CAPACITY + 1);
+    }
+
+    Slot &slot = slotFor(extSeq);
+    if (slot.filled && slot.seq == extSeq)
+    {
+        counters.duplicate++;
+        return false;
+    }
+
+    slot.filled = true;
+    slot.seq = extSeq;
+    slot.timestamp = timestamp;
+    slot.payload.swap(payload);
+    count++;
+    counters.received++;
+
+    if ((int32_t) (extSeq - highestSeq) > 0)
+    {
+        highestSeq = extSeq;
+        highestTimestamp = timestamp;
+    }
+    else if (extSeq != highestSeq)
+    {
+        counters.reordered++;
+    }
+
+    trimToMaxDelay(now);
+    return true;
+}
+
+JitterBuffer::Result JitterBuffer::pop(Clock::time_point now, std::vector<uint8_t> &payload)
+{
+    if (!playing)
+        return Result::None;
+
+    Slot &slot = slotFor(nextSeq);
+    bool have = slot.filled && slot.seq == nextSeq;
+    if (now < dueTime(have ? slot.timestamp : nextTimestamp))
+        return Result::None;
+
+    if (have)
+    {
+        // Learn the packet duration from back to back packets
+        if (havePopped && lastPoppedSeq + 1 == nextSeq)
+        {
+            uint32_t step = slot.timestamp - lastPoppedTimestamp;
+            if (step > 0 && step < clockRate)
+                frameTicks = step;
+        }
+        havePopped = true;
+        lastPoppedSeq = nextSeq;
+        lastPoppedTimestamp = slot.timestamp;
+
+        payload.swap(slot.payload);
+        slot.filled = false;
+        count--;
+        nextSeq++;
+        nextTimestamp = lastPoppedTimestamp + frameTicks;
+        concealed = 0;
+        return Result::Packet;
+    }
+
+    if (count == 0 && concealed >= MAX_CONCEAL)
+    {
+        // Ran dry: stop the clock and buffer up again on the next packet.
+        // Whatever was concealed meanwhile was the end of a talk spurt.
+        playing = false;
+        pendingLost = 0;
+        counters.underruns++;
+        return Result::None;
+    }
+
+    if (count == 0)
+        pendingLost++;
+    else
+        counters.lost++;
+    nextSeq++;
+    nextTimestamp += frameTicks;
+    concealed++;
+    return Result::Lost;
+}
+
+bool JitterBuffer::drain(std::vector<uint8_t> &payload)
+{
+    while (count > 0)
+    {
+        Slot &slot = slotFor(nextSeq);
+        uint32_t seq = nextSeq++;
+        if (slot.filled && slot.seq == seq)
+        {
+            payload.swap(slot.payload);
+            slot.filled = false;
+            count--;
+            return true;
+        }
+    }
+    playing = false;
+    return false;
+}
+
+JitterBuffer::Clock::time_point JitterBuffer::nextDue() const
+{
+    if (!playing)
+        return Clock::time_point::max();
+
+    const Slot &slot = slotFor(nextSeq);
+    bool have = slot.filled && slot.seq == nextSeq;
+    return dueTime(have ? slot.timestamp : nextTimestamp);
+}
+
+unsigned JitterBuffer::depthMs() const
+{
+    if (count == 0)
+        return 0;
+    int64_t ticks = (int64_t) (int32_t) (highestTimestamp - nextTimestamp) + frameTicks;
+    return ticks > 0 ? (unsigned) (ticks * 1000 / clockRate) : 0;
+}
+
+unsigned JitterBuffer::jitterMs() const
+{
+    return (unsigned) ((uint64_t) (jitterQ4 >> 4) * 1000 / clockRate);
+}
@@ -0,0 +1,120 @@
+#ifndef JITTER_BUFFER_HPP
+#define JITTER_BUFFER_HPP
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+/* Receive side jitter buffer for backchannel RTP payloads.
+ *
+ * Packets are stored in a ring indexed by RTP sequence number, so reordered
+ * packets slot into place. Playout starts 'target delay' after the first
+ * packet arrives; from then on every packet is due at a fixed offset from its
+ * RTP timestamp. A packet still missing at its due time is reported as lost
+ * (the caller conceals it), one arriving after that is dropped as late.
+ *
+ * Payload vectors are swapped in and out of the slots, so once the ring has
+ * warmed up no allocation happens per packet.
+ */
+class JitterBuffer
+{
+public:
+    using Clock = std::chrono::steady_clock;
+
+    enum class Result
+    {
+        None,   // nothing due yet
+        Packet, // next packet in sequence
+        Lost    // next packet is missing at its due time, conceal it
+    };
+
+    struct Stats
+    {
+        uint32_t received = 0;
+        uint32_t lost = 0;       // concealed
+        uint32_t late = 0;       // arrived after its due time
+        uint32_t duplicate = 0;
+        uint32_t overflow = 0;   // discarded to bring the delay back to max
+        uint32_t underruns = 0;  // ran dry and had to re-buffer
+        uint32_t reordered = 0;  // arrived out of order but in time
+    };
+
+    static constexpr size_t CAPACITY = 128;
+    // Consecutive concealed packets before an empty buffer re-buffers
+    static constexpr unsigned MAX_CONCEAL = 3;
+
+    JitterBuffer() : slots(CAPACITY) {}
+
+    void configure(unsigned clockRate, unsigned targetDelayMs, unsigned maxDelayMs);
+    void reset();
+
+    // Insert a packet; on success 'payload' is swapped with a spare buffer.
+    bool push(uint16_t seq, uint32_t timestamp, std::vector<uint8_t> &payload, Clock::time_point now);
+    // Take the next packet if it is due. For Packet, 'payload' receives it.
+    Result pop(Clock::time_point now, std::vector<uint8_t> &payload);
+    // Take the next buffered packet regardless of its due time (end of session).
+    bool drain(std::vector<uint8_t> &payload);
+
+    // Time of the next pop() that may return something, or max() when idle.
+    Clock::time_point nextDue() const;
+
+    bool empty() const { return count == 0; }
+    size_t depth() const { return count; }
+    unsigned depthMs() const;
+    unsigned jitterMs() const;
+    const Stats &stats() const { return counters; }
+
+private:
+    struct Slot
+    {
+        bool filled = false;
+        uint32_t seq = 0; // extended
+        uint32_t timestamp = 0;
+        std::vector<uint8_t> payload;
+    };
+
+    void clear();
+    Slot &slotFor(uint32_t extSeq) { return slots[extSeq % CAPACITY]; }
+    const Slot &slotFor(uint32_t extSeq) const { return slots[extSeq % CAPACITY]; }
+    uint32_t extend(uint16_t seq) const;
+    Clock::time_point dueTime(uint32_t timestamp) const;
+    void startPlayout(uint32_t extSeq, uint32_t timestamp, Clock::time_point now);
+    void skipTo(uint32_t extSeq);
+    void trimToMaxDelay(Clock::time_point now);
+    void updateJitter(uint32_t timestamp, Clock::time_point now);
+
+    std::vector<Slot> slots;
+    size_t count = 0;
+
+    unsigned clockRate = 8000;
+    Clock::duration targetDelay{};
+    uint32_t maxDelayTicks = 0;
+
+    bool started = false;   // a sequence number has been seen
+    bool playing = false;   // playout clock running
+    uint32_t highestSeq = 0;
+    uint32_t highestTimestamp = 0;
+    uint32_t nextSeq = 0;
+    uint32_t nextTimestamp = 0;
+    uint32_t frameTicks = 0;   // timestamp step of one packet, learned
+    unsigned concealed = 0;    // consecutive
+    uint32_t pendingLost = 0;  // concealed while empty, lost once a later packet shows up
+
+    bool havePopped = false;
+    uint32_t lastPoppedSeq = 0;
+    uint32_t lastPoppedTimestamp = 0;
+
+    // Playout clock: 'baseTimestamp' plays at 'baseTime'
+    uint32_t baseTimestamp = 0;
+    Clock::time_point baseTime;
+
+    // RFC 3550 interarrival jitter, in timestamp units << 4
+    bool haveTransit = false;
+    int64_t lastTransit = 0;
+    uint32_t jitterQ4 = 0;
+
+    Stats counters;
+};
+
+#endif // JITTER_BUFFER_HPP
@@ -1,8 +1,31 @@
 #include "Motion.hpp"
 
+#include <algorithm>
+#include <unistd.h>
+
 using namespace std::chrono;
 bool ignoreInitialPeriod = true;
 
+std::atomic<bool> Motion::indicator{false};
+std::array<std::atomic<uint32_t>, IMP_IVS_MOVE_MAX_ROI_CNT> Motion::regionHits{};
+MotionHeatmap Motion::heatmap;
+
+std::mutex Motion::areasMutex;
+std::vector<PixelRect> Motion::areas;
+std::atomic<uint32_t> Motion::areasSeq{0};
+int Motion::areasWidth = 0;
+int Motion::areasHeight = 0;
+
+// Streams drop to their idle encoder profile while nothing moves
+static void requestIdleProfile(bool idle)
+{
+    for (auto &video : global_video)
+    {
+        if (video)
+            video->idle = idle;
+    }
+}
+
 std::string Motion::getConfigPath(const char *itemName)
 {
     return "motion." + std::string(itemName);
@@ -12,33 +35,23 @@ void Motion::detect()
 {
     LOG_INFO("Start motion detection thread.");
 
-    int ret;
     int debounce = 0;
-    IMP_IVS_MoveOutput *result;
     bool isInCooldown = false;
     auto cooldownEndTime = steady_clock::now();
     auto motionEndTime = steady_clock::now();
     auto startTime = steady_clock::now();
+    lastHitsReport = startTime;
 
     if(init() != 0) return;
 
+    requestIdleProfile(true);
+
     global_motion_thread_signal = true;
     while (global_motion_thread_signal)
     {
-
-        ret = IMP_IVS_PollingResult(ivsChn, cfg->motion.ivs_polling_timeout);
-        if (ret < 0)
-        {
-            LOG_WARN("IMP_IVS_PollingResult error: " << ret);
-            continue;
-        }
-
-        ret = IMP_IVS_GetResult(ivsChn, (void **)&result);
-        if (ret < 0)
-        {
-            LOG_WARN("IMP_IVS_GetResult error: " << ret);
+        bool hits[IMP_IVS_MOVE_MAX_ROI_CNT] = {};
+        if (!(software ? pollSoftware(hits) : pollIvs(hits)))
             continue;
-        }
 
         auto currentTime = steady_clock::now();
         auto elapsedTime = duration_cast<seconds>(currentTime - startTime);
@@ -52,6 +65,15 @@ void Motion::detect()
             ignoreInitialPeriod = false;
         }
 
+        // Everything after the settling time counts, cooldown included
+        updateHeatmap(hits);
+        updateActiveAreas(hits);
+        for (int i = 0; i < IMP_IVS_MOVE_MAX_ROI_CNT; i++)
+        {
+            if (hits[i])
+                regionHits[i]++;
+        }
+
         if (isInCooldown && duration_cast<seconds>(currentTime - cooldownEndTime).count() < cfg->motion.cooldown_time)
         {
             continue;
@@ -61,33 +83,33 @@ void Motion::detect()
             isInCooldown = false;
         }
 
-        bool motionDetected = false;
+        // Debounce counts analysed frames with motion, however many regions hit
+        int firstRegion = -1;
         for (int i = 0; i < IMP_IVS_MOVE_MAX_ROI_CNT; i++)
         {
-            if (result->retRoi[i])
+            if (hits[i])
             {
-                motionDetected = true;
                 LOG_INFO("Active motion detected in region " << i);
-                debounce++;
-                if (debounce >= cfg->motion.debounce_time)
+                if (firstRegion < 0)
+                    firstRegion = i;
+            }
+        }
+
+        bool motionDetected = firstRegion >= 0;
+        if (motionDetected)
+        {
+            debounce++;
+            if (debounce >= cfg->motion.debounce_time)
+            {
+                if (!moving.load())
                 {
-                    if (!moving.load())
-                    {
-                        moving = true;
-                        LOG_INFO("Motion Start");
-
-                        char cmd[128];
-                        memset(cmd, 0, sizeof(cmd));
-                        snprintf(cmd, sizeof(cmd), "%s start", cfg->motion.script_path);
-                        ret = system(cmd);
-                        if (ret != 0)
-                        {
-                            LOG_ERROR("Motion script failed:" << cmd);
-                        }
-                    }
-                    indicator = true;
-                    motionEndTime = steady_clock::now(); // Update last motion time
+                    moving = true;
+                    LOG_INFO("Motion Start");
+                    requestIdleProfile(false);
+                    EventBus::instance().publish({EventSource::Motion, true, firstRegion});
                 }
+                indicator = true;
+                motionEndTime = steady_clock::now(); // Update last motion time
             }
         }
 
@@ -98,14 +120,8 @@ void Motion::detect()
             if (moving && duration >= cfg->motion.min_time && duration >= cfg->motion.post_time)
             {
                 LOG_INFO("End of Motion");
-                char cmd[128];
-                memset(cmd, 0, sizeof(cmd));
-                snprintf(cmd, sizeof(cmd), "%s stop", cfg->motion.script_path);
-                ret = system(cmd);
-                if (ret != 0)
-                {
-                    LOG_ERROR("Motion script failed:" << cmd);
-                }
+                requestIdleProfile(true);
+                EventBus::instance().publish({EventSource::Motion, false});
                 moving = false;
                 indicator = false;
                 cooldownEndTime = steady_clock::now(); // Start cooldown
@@ -113,11 +129,10 @@ void Motion::detect()
             }
         }
 
-        ret = IMP_IVS_ReleaseResult(ivsChn, (void *)result);
-        if (ret < 0)
+        if (duration_cast<seconds>(currentTime - lastHitsReport).count() >= 5)
         {
-            LOG_WARN("IMP_IVS_ReleaseResult error: " << ret);
-            continue;
+            publishHits();
+            lastHitsReport = currentTime;
         }
     }
 
@@ -126,6 +141,231 @@ void Motion::detect()
     LOG_DEBUG("Exit motion detect thread.");
 }
 
+bool Motion::pollIvs(bool *hits)
+{
+    IMP_IVS_MoveOutput *result;
+
+    int ret = IMP_IVS_PollingResult(ivsChn, cfg->motion.ivs_polling_timeout);
+    if (ret < 0)
+    {
+        LOG_WARN("IMP_IVS_PollingResult error: " << ret);
+        return false;
+    }
+
+    ret = IMP_IVS_GetResult(ivsChn, (void **)&result);
+    if (ret < 0)
+    {
+        LOG_WARN("IMP_IVS_GetResult error: " << ret);
+        return false;
+    }
+
+    for (int i = 0; i < IMP_IVS_MOVE_MAX_ROI_CNT; i++)
+    {
+        hits[i] = result->retRoi[i] != 0;
+    }
+
+    ret = IMP_IVS_ReleaseResult(ivsChn, (void *)result);
+    if (ret < 0)
+    {
+        LOG_WARN("IMP_IVS_ReleaseResult error: " << ret);
+    }
+
+    return true;
+}
+
+bool Motion::pollSoftware(bool *hits)
+{
+    IMPFrameInfo *frame;
+
+    int ret = IMP_FrameSource_GetFrame(cfg->motion.monitor_stream, &frame);
+    if (ret < 0)
+    {
+        LOG_WARN("IMP_FrameSource_GetFrame error: " << ret);
+        usleep(cfg->motion.ivs_polling_timeout * 1000 / 10);
+        return false;
+    }
+
+    // Every (skip_frame_count + 1)th frame is compared, like the IVS does
+    bool analysed = false;
+    if (frameCounter++ % (cfg->motion.skip_frame_count + 1) == 0)
+    {
+        if (frame->width != blockDetector.width() || frame->height != blockDetector.height())
+        {
+            blockDetector.reset(frame->width, frame->height, cfg->motion.block_size);
+        }
+
+        // NV12: the luma plane comes first, one byte per pixel
+        analysed = blockDetector.process((const uint8_t *)(uintptr_t)frame->virAddr, frame->width);
+    }
+
+    IMP_FrameSource_ReleaseFrame(cfg->motion.monitor_stream, frame);
+
+    if (!analysed)
+        return false;
+
+    // Regions are given in frame_width x frame_height coordinates
+    int fw = std::max(cfg->motion.frame_width, 1);
+    int fh = std::max(cfg->motion.frame_height, 1);
+    for (size_t i = 0; i < regions.size(); i++)
+    {
+        const Region &r = regions[i];
+        int x0 = r.x0 * blockDetector.width() / fw;
+        int y0 = r.y0 * blockDetector.height() / fh;
+        int x1 = r.x1 * blockDetector.width() / fw;
+        int y1 = r.y1 * blockDetector.height() / fh;
+
+        int active = blockDetector.countActive(r.blockThreshold, x0, y0, x1, y1);
+        hits[i] = active >= cfg->motion.block_min_count;
+    }
+
+    return true;
+}
+
+void Motion::updateHeatmap(const bool *hits)
+{
+    heatmap.beginFrame();
+    for (size_t i = 0; i < regions.size(); i++)
+    {
+        if (hits[i])
+        {
+            const Region &r = regions[i];
+            heatmap.addRegion(i, r.x0, r.y0, r.x1, r.y1,
+                              software ? &blockDetector : nullptr, r.blockThreshold);
+        }
+    }
+    heatmap.endFrame();
+}
+
+void Motion::updateActiveAreas(const bool *hits)
+{
+    auto now = steady_clock::now();
+
+    areaScratch.clear();
+    for (size_t i = 0; i < regions.size(); i++)
+    {
+        Region &r = regions[i];
+        if (hits[i])
+        {
+            r.area = {r.x0, r.y0, r.x1, r.y1};
+            r.lastHit = now;
+
+            if (software)
+            {
+                // only the part of the region that moves, in detector
+                // coordinates and back
+                int fw = std::max(cfg->motion.frame_width, 1);
+                int fh = std::max(cfg->motion.frame_height, 1);
+                int dw = blockDetector.width();
+                int dh = blockDetector.height();
+                int x0 = r.x0 * dw / fw, y0 = r.y0 * dh / fh;
+                int x1 = r.x1 * dw / fw, y1 = r.y1 * dh / fh;
+                if (dw > 0 && dh > 0 && blockDetector.activeBounds(r.blockThreshold, x0, y0, x1, y1))
+                {
+                    r.area = {x0 * fw / dw, y0 * fh / dh,
+                              std::min((x1 * fw + dw - 1) / dw, r.x1),
+                              std::min((y1 * fh + dh - 1) / dh, r.y1)};
+                }
+            }
+        }
+
+        if (now - r.lastHit < AREA_HOLD)
+            areaScratch.push_back(r.area);
+    }
+
+    std::lock_guard<std::mutex> lock(areasMutex);
+    if (areaScratch != areas)
+    {
+        areas = areaScratch;
+        areasWidth = cfg->motion.frame_width;
+        areasHeight = cfg->motion.frame_height;
+        areasSeq++;
+    }
+}
+
+void Motion::clearActiveAreas()
+{
+    std::lock_guard<std::mutex> lock(areasMutex);
+    if (!areas.empty())
+    {
+        areas.clear();
+        areasSeq++;
+    }
+}
+
+bool Motion::activeAreas(uint32_t &seq, std::vector<PixelRect> &out, int &frameWidth, int &frameHeight)
+{
+    if (areasSeq == seq)
+        return false;
+
+    std::lock_guard<std::mutex> lock(areasMutex);
+    out = areas;
+    frameWidth = areasWidth;
+    frameHeight = areasHeight;
+    seq = areasSeq;
+    return true;
+}
+
+void Motion::loadRegions()
+{
+    const int fw = cfg->motion.frame_width;
+    const int fh = cfg->motion.frame_height;
+    const int count = std::clamp(cfg->motion.roi_count, 1, IMP_IVS_MOVE_MAX_ROI_CNT);
+
+    regions.clear();
+    for (int i = 0; i < count; i++)
+    {
+        const roi &cfgRoi = cfg->motion.rois[i];
+        Region r{cfgRoi.p0_x, cfgRoi.p0_y, cfgRoi.p1_x, cfgRoi.p1_y,
+                 cfgRoi.sensitivity >= 0 ? cfgRoi.sensitivity : cfg->motion.sensitivity, 0, {}, {}};
+
+        // A region more sensitive than motion.sensitivity gets a lower
+        // block threshold, a less sensitive one a higher
+        r.blockThreshold = cfg->motion.block_threshold * (1 + cfg->motion.sensitivity) / (1 + r.sensitivity);
+        r.blockThreshold = std::clamp(r.blockThreshold, 1, 255);
+
+        // roi_0_x..roi_1_y still define the first region if rois has none
+        if (i == 0 && (r.x1 <= r.x0 || r.y1 <= r.y0))
+        {
+            r.x0 = cfg->motion.roi_0_x;
+            r.y0 = cfg->motion.roi_0_y;
+            r.x1 = cfg->motion.roi_1_x;
+            r.y1 = cfg->motion.roi_1_y;
+        }
+
+        r.x0 = std::clamp(r.x0, 0, fw - 1);
+        r.y0 = std::clamp(r.y0, 0, fh - 1);
+        r.x1 = std::clamp(r.x1, r.x0 + 1, fw);
+        r.y1 = std::clamp(r.y1, r.y0 + 1, fh);
+        if (cfgRoi.p1_x <= cfgRoi.p0_x && i > 0)
+        {
+            LOG_WARN("Motion region " << i << " is empty, check rois.roi_" << i);
+        }
+
+        LOG_INFO("Motion detection roi[" << i << "]: " << r.x0 << "," << r.y0 << " - "
+                 << r.x1 << "," << r.y1 << ", sensitivity: " << r.sensitivity);
+        regions.push_back(r);
+    }
+
+    heatmap.reset(fw, fh, cfg->motion.heatmap_half_life);
+
+    for (auto &hits : regionHits)
+        hits = 0;
+    publishedHits.fill(UINT32_MAX);
+}
+
+void Motion::publishHits()
+{
+    for (size_t i = 0; i < regions.size(); i++)
+    {
+        uint32_t hits = regionHits[i];
+        if (hits != publishedHits[i])
+        {
+            RTSPStatus::writeCustomParameter("motion", "roi" + std::to_string(i) + "_hits", std::to_string(hits));
+            publishedHits[i] = hits;
+        }
+    }
+}
+
 int Motion::init()
 {
     LOG_INFO("Initialize motion detection.");
@@ -138,8 +378,7 @@ int Motion::init()
     }
     int ret;
 
-    ret = IMP_IVS_CreateGroup(0);
-    LOG_DEBUG_OR_ERROR_AND_EXIT(ret, "IMP_IVS_CreateGroup(0)");
+    software = strcmp(cfg->motion.detector, "software") == 0;
 
     //automatically set frame size / height
     ret = IMP_Encoder_GetChnAttr(cfg->motion.monitor_stream, &channelAttributes);
@@ -163,6 +402,30 @@ int Motion::init()
         }
     }
 
+    loadRegions();
+    publishHits();
+
+    if (software)
+    {
+        // Frames are pulled from the framesource channel of the monitored
+        // stream, next to the encoder
+        frameCounter = 0;
+        blockDetector.reset(0, 0, cfg->motion.block_size);
+
+        ret = IMP_FrameSource_SetFrameDepth(cfg->motion.monitor_stream, 1);
+        LOG_DEBUG_OR_ERROR_AND_EXIT(ret, "IMP_FrameSource_SetFrameDepth(" << cfg->motion.monitor_stream << ", 1)");
+
+        LOG_INFO("Software motion detection:" <<
+                 " block size: " << cfg->motion.block_size <<
+                 ", threshold:" << cfg->motion.block_threshold <<
+                 ", min blocks:" << cfg->motion.block_min_count <<
+                 ", skipCnt:" << cfg->motion.skip_frame_count);
+        return ret;
+    }
+
+    ret = IMP_IVS_CreateGroup(0);
+    LOG_DEBUG_OR_ERROR_AND_EXIT(ret, "IMP_IVS_CreateGroup(0)");
+
     memset(&move_param, 0, sizeof(IMP_IVS_MoveParam));
     // OSD is affecting motion for some reason.
     // Sensitivity range is 0-4
@@ -177,17 +440,16 @@ int Motion::init()
              ", width:" << move_param.frameInfo.width <<
              ", height:" << move_param.frameInfo.height);
 
-    move_param.roiRect[0].p0.x = cfg->motion.roi_0_x;
-    move_param.roiRect[0].p0.y = cfg->motion.roi_0_y;
-    move_param.roiRect[0].p1.x = cfg->motion.roi_1_x - 1;
-    move_param.roiRect[0].p1.y = cfg->motion.roi_1_y - 1;
-    move_param.roiRectCnt = cfg->motion.roi_count;
-
-    LOG_INFO("Motion detection roi[0]:" <<
-             " roi_0_x: " << cfg->motion.roi_0_x <<
-             ", roi_0_y:" << cfg->motion.roi_0_y <<
-             ", roi_1_x: " << cfg->motion.roi_1_x <<
-             ", roi_1_y:" << cfg->motion.roi_1_y);
+    // Every region with its own sensitivity, the IVS corners are inclusive
+    for (size_t i = 0; i < regions.size(); i++)
+    {
+        move_param.roiRect[i].p0.x = regions[i].x0;
+        move_param.roiRect[i].p0.y = regions[i].y0;
+        move_param.roiRect[i].p1.x = regions[i].x1 - 1;
+        move_param.roiRect[i].p1.y = regions[i].y1 - 1;
+        move_param.sense[i] = regions[i].sensitivity;
+    }
+    move_param.roiRectCnt = regions.size();
 
     move_intf = IMP_IVS_CreateMoveInterface(&move_param);
 
@@ -224,6 +486,17 @@ int Motion::exit()
 
     LOG_DEBUG("Exit motion detection.");
 
+    // without detection nobody would switch back
+    requestIdleProfile(false);
+    clearActiveAreas();
+
+    if (software)
+    {
+        ret = IMP_FrameSource_SetFrameDepth(cfg->motion.monitor_stream, 0);
+        LOG_DEBUG_OR_ERROR(ret, "IMP_FrameSource_SetFrameDepth(" << cfg->motion.monitor_stream << ", 0)");
+        return ret;
+    }
+
     ret = IMP_IVS_StopRecvPic(ivsChn);
     LOG_DEBUG_OR_ERROR(ret, "IMP_IVS_StopRecvPic(0)");
 
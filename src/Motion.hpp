@@ -4,12 +4,21 @@
 #include <memory>
 #include <thread>
 #include <atomic>
+#include <array>
+#include <chrono>
+#include <mutex>
+#include <vector>
 #include "Config.hpp"
 #include "Logger.hpp"
 #include "globals.hpp"
 #include "imp/imp_system.h"
 #include "imp/imp_ivs.h"
 #include "imp/imp_ivs_move.h"
+#include "imp/imp_framesource.h"
+#include "BlockMotion.hpp"
+#include "MotionHeatmap.hpp"
+#include "EventBus.hpp"
+#include "RTSPStatus.hpp"
 
 #if defined(PLATFORM_T31) || defined(PLATFORM_C100) || defined(PLATFORM_T40) || defined(PLATFORM_T41)
 #define IMPEncoderCHNAttr IMPEncoderChnAttr
@@ -28,14 +37,65 @@ class Motion {
         int init();
         int exit();
 
+        // Debounced motion state, read by the OSD motion marker
+        static std::atomic<bool> indicator;
+        // Analysed frames with motion, per region, since the detector started
+        static std::array<std::atomic<uint32_t>, IMP_IVS_MOVE_MAX_ROI_CNT> regionHits;
+        // Decaying map of where motion happened, kept across restarts
+        static MotionHeatmap heatmap;
+
+        // Areas with recent motion in frame_width x frame_height, for the
+        // encoder ROIs. Returns true and updates 'seq' when they changed
+        // since 'seq'.
+        static bool activeAreas(uint32_t &seq, std::vector<PixelRect> &areas, int &frameWidth, int &frameHeight);
+
     private:
         int ivsChn = 0;
         int ivsGrp = 0;
 
         std::string getConfigPath(const char *itemName);
 
+        // motion.rois (or roi_0_x..roi_1_y for the first one) clamped to the
+        // frame, end exclusive
+        struct Region
+        {
+            int x0, y0, x1, y1;
+            int sensitivity;
+            int blockThreshold; // software detector
+            // last motion, narrowed to the active blocks in software mode
+            PixelRect area;
+            std::chrono::steady_clock::time_point lastHit;
+        };
+        std::vector<Region> regions;
+        void loadRegions();
+
+        // Hit counters go to /run/prudynt/rtsp/motion/roi<N>_hits
+        void publishHits();
+        std::array<uint32_t, IMP_IVS_MOVE_MAX_ROI_CNT> publishedHits{};
+        std::chrono::steady_clock::time_point lastHitsReport;
+
+        // One poll per analysed frame, hits[i] is set for ROIs with motion
+        bool pollIvs(bool *hits);
+        bool pollSoftware(bool *hits);
+        void updateHeatmap(const bool *hits);
+
+        // Regions stay an active area this long after their last hit
+        static constexpr std::chrono::milliseconds AREA_HOLD{1000};
+        void updateActiveAreas(const bool *hits);
+        void clearActiveAreas();
+        std::vector<PixelRect> areaScratch;
+        static std::mutex areasMutex;
+        static std::vector<PixelRect> areas;
+        static std::atomic<uint32_t> areasSeq;
+        static int areasWidth;
+        static int areasHeight;
+
+        // motion.detector "software": block SAD on the framesource output
+        bool software = false;
+        BlockMotionDetector blockDetector;
+        unsigned frameCounter = 0;
+
         std::atomic<bool> moving;
-        std::atomic<bool> indicator;
         IMP_IVS_MoveParam move_param;
         IMPIVSInterface *move_intf;
         std::thread detect_thread;
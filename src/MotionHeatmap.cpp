@@ -0,0 +1,168 @@
+#include "MotionHeatmap.hpp"
+
+#include "BlockMotion.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+
+void MotionHeatmap::reset(int frameWidth, int frameHeight, int halfLifeSeconds)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+
+    halfLife = std::max(halfLifeSeconds, 1);
+    if (frameWidth == width && frameHeight == height)
+        return;
+
+    width = frameWidth;
+    height = frameHeight;
+    lastDecay = std::chrono::steady_clock::now();
+    cells.fill(0);
+    regionHeat.fill(0);
+}
+
+void MotionHeatmap::beginFrame()
+{
+    cellMarks.fill(0);
+    regionMarks.fill(0);
+}
+
+void MotionHeatmap::addRegion(int region, int x0, int y0, int x1, int y1,
+                              const BlockMotionDetector *blocks, int blockThreshold)
+{
+    if (width <= 0 || height <= 0 || region < 0 || region >= MAX_REGIONS)
+        return;
+
+    regionMarks[region] = 1;
+
+    for (int cy = 0; cy < ROWS; cy++)
+    {
+        // cell and region overlap, in frame coordinates
+        int top = std::max(cy * height / ROWS, y0);
+        int bottom = std::min((cy + 1) * height / ROWS, y1);
+        if (top >= bottom)
+            continue;
+
+        for (int cx = 0; cx < COLS; cx++)
+        {
+            int left = std::max(cx * width / COLS, x0);
+            int right = std::min((cx + 1) * width / COLS, x1);
+            if (left >= right || cellMarks[cy * COLS + cx])
+                continue;
+
+            if (blocks)
+            {
+                // any active block in the overlap, in detector coordinates
+                int bw = blocks->width();
+                int bh = blocks->height();
+                if (blocks->countActive(blockThreshold, left * bw / width, top * bh / height,
+                                        (right * bw + width - 1) / width,
+                                        (bottom * bh + height - 1) / height) == 0)
+                    continue;
+            }
+
+            cellMarks[cy * COLS + cx] = 1;
+        }
+    }
+}
+
+void MotionHeatmap::endFrame()
+{
+    std::lock_guard<std::mutex> lock(mutex);
+
+    decay(std::chrono::steady_clock::now());
+    for (int i = 0; i < COLS * ROWS; i++)
+        cells[i] += cellMarks[i];
+    for (int i = 0; i < MAX_REGIONS; i++)
+        regionHeat[i] += regionMarks[i];
+}
+
+void MotionHeatmap::decay(std::chrono::steady_clock::time_point now)
+{
+    // Whole seconds only, frame sized steps would need far more precision
+    // than a float has for a half life of hours
+    auto seconds = std::chrono::duration_cast<std::chrono::seconds>(now - lastDecay).count();
+    if (seconds < 1)
+        return;
+    lastDecay += std::chrono::seconds(seconds);
+
+    float factor = std::exp2(-(float) seconds / halfLife);
+    for (auto &cell : cells)
+        cell *= factor;
+    for (auto &heat : regionHeat)
+        heat *= factor;
+}
+
+float MotionHeatmap::maxCell() const
+{
+    return *std::max_element(cells.begin(), cells.end());
+}
+
+std::string MotionHeatmap::toJson(int regionCount)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+
+    decay(std::chrono::steady_clock::now());
+    float max = maxCell();
+    regionCount = std::clamp(regionCount, 0, MAX_REGIONS);
+
+    char buf[160];
+    snprintf(buf, sizeof(buf),
+             "{\"cols\":%d,\"rows\":%d,\"frame_width\":%d,\"frame_height\":%d,\"half_life\":%d,\"max\":%.1f,\"cells\":[",
+             COLS, ROWS, width, height, halfLife, max);
+
+    std::string json(buf);
+    json.reserve(json.size() + COLS * ROWS * 4 + regionCount * 10 + 16);
+    for (int i = 0; i < COLS * ROWS; i++)
+    {
+        int scaled = max > 0 ? (int) std::lround(cells[i] * 255 / max) : 0;
+        snprintf(buf, sizeof(buf), i ? ",%d" : "%d", scaled);
+        json.append(buf);
+    }
+    json.append("],\"regions\":[");
+    for (int i = 0; i < regionCount; i++)
+    {
+        snprintf(buf, sizeof(buf), i ? ",%.1f" : "%.1f", regionHeat[i]);
+        json.append(buf);
+    }
+    json.append("]}");
+
+    return json;
+}
+
+std::vector<uint8_t> MotionHeatmap::toBGRA()
+{
+    std::lock_guard<std::mutex> lock(mutex);
+
+    decay(std::chrono::steady_clock::now());
+    float max = maxCell();
+
+    std::vector<uint8_t> image(COLS * ROWS * 4, 0);
+    if (max <= 0)
+        return image;
+
+    for (int i = 0; i < COLS * ROWS; i++)
+    {
+        float v = cells[i] / max;
+        if (v <= 0)
+            continue;
+
+        // blue -> green -> red over the first and second half of the range
+        uint8_t *px = &image[i * 4];
+        if (v < 0.5f)
+        {
+            px[0] = (uint8_t) std::lround(255 * (1 - 2 * v));
+            px[1] = (uint8_t) std::lround(255 * 2 * v);
+            px[2] = 0;
+        }
+        else
+        {
+            px[0] = 0;
+            px[1] = (uint8_t) std::lround(255 * (2 - 2 * v));
+            px[2] = (uint8_t) std::lround(255 * (2 * v - 1));
+        }
+        px[3] = (uint8_t) std::lround(64 + 160 * v);
+    }
+
+    return image;
+}
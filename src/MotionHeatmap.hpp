@@ -0,0 +1,71 @@
+#ifndef MOTION_HEATMAP_HPP
+#define MOTION_HEATMAP_HPP
+
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <vector>
+
+class BlockMotionDetector;
+
+/* Where motion happened over the last hours, for placing ROIs.
+ *
+ * The frame is covered by a fixed COLS x ROWS grid, plus one value per motion
+ * region. Every analysed frame adds 1 to the cells with motion: with the
+ * software detector the cells of a region whose block is active, with the
+ * IVS (which only reports per region) all cells of the regions that reported
+ * motion. A cell counts once per frame, however many regions cover it. All
+ * values decay exponentially with a configurable half life, so the map shows
+ * recent activity and its memory never grows.
+ *
+ * Frames are fed by the motion thread, the exports are read by the
+ * websocket.
+ */
+class MotionHeatmap
+{
+public:
+    static constexpr int COLS = 32;
+    static constexpr int ROWS = 18;
+    static constexpr int MAX_REGIONS = 52;
+
+    // Set the frame size the regions are given in. The map is kept when the
+    // size does not change, so restarting detection does not lose it.
+    void reset(int frameWidth, int frameHeight, int halfLifeSeconds);
+
+    // Per analysed frame: beginFrame(), addRegion() for every region with
+    // motion, endFrame(). Rectangles are end exclusive in frame coordinates;
+    // 'blocks' is the software detector, null for the IVS.
+    void beginFrame();
+    void addRegion(int region, int x0, int y0, int x1, int y1,
+                   const BlockMotionDetector *blocks, int blockThreshold);
+    void endFrame();
+
+    // {"cols":32,"rows":18,"frame_width":..,"frame_height":..,"half_life":..,
+    //  "max":..,"cells":[0-255, relative to max],"regions":[..]}
+    std::string toJson(int regionCount);
+
+    // COLS x ROWS BGRA image: transparent where nothing moved, blue to red
+    // and more opaque towards the hottest cell
+    std::vector<uint8_t> toBGRA();
+
+private:
+    void decay(std::chrono::steady_clock::time_point now);
+    float maxCell() const;
+
+    std::mutex mutex;
+    int width = 0;
+    int height = 0;
+    int halfLife = 3600;
+    std::chrono::steady_clock::time_point lastDecay;
+
+    std::array<float, COLS * ROWS> cells{};
+    std::array<float, MAX_REGIONS> regionHeat{};
+
+    // Current frame, motion thread only
+    std::array<uint8_t, COLS * ROWS> cellMarks{};
+    std::array<uint8_t, MAX_REGIONS> regionMarks{};
+};
+
+#endif // MOTION_HEATMAP_HPP
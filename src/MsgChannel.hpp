@@ -5,6 +5,7 @@
 #include <deque>
 #include <thread>
 #include <atomic>
+#include <chrono>
 #include <mutex>
 #include <condition_variable>
 
@@ -46,6 +47,17 @@ public:
         return val;
     }
 
+    template <class Clock, class Duration>
+    bool wait_read_until(T *out, const std::chrono::time_point<Clock, Duration> &deadline) {
+        std::unique_lock<std::mutex> lck(cv_mtx);
+        if (!write_cv.wait_until(lck, deadline, [this] { return can_read(); })) {
+            return false;
+        }
+        *out = msg_buffer.back();
+        msg_buffer.pop_back();
+        return true;
+    }
+
 private:
     bool can_read() {
         return !msg_buffer.empty();
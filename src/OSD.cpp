@@ -5,7 +5,13 @@
 #include <pthread.h>
 #include "Logger.hpp"
 #include "globals.hpp"
+#include "Motion.hpp"
+#include "ImageRotate.hpp"
 #include <unistd.h>
+#include <poll.h>
+#include <sys/eventfd.h>
+#include <sys/timerfd.h>
+#include <cerrno>
 #include <vector>
 
 #if defined(PLATFORM_T31) || defined(PLATFORM_C100) || defined(PLATFORM_T40) || defined(PLATFORM_T41)
@@ -18,6 +24,7 @@
 #define picHeight uHeight
 #endif
 
+#include <algorithm>
 #include <cstdio>
 #include <cstdlib>
 #include <cstring>
@@ -27,154 +34,132 @@
 
 #include "schrift.h"
 
-int OSD::renderGlyph(const char *characters)
+// Decode one UTF-8 sequence and advance 'text' past it. Malformed input
+// gives U+FFFD and skips a single byte.
+static uint32_t nextCodepoint(const char *&text)
 {
+    const unsigned char *p = reinterpret_cast<const unsigned char *>(text);
+    uint32_t cp;
+    int extra;
 
-    while (*characters)
+    if (p[0] < 0x80)
     {
+        text += 1;
+        return p[0];
+    }
+    else if ((p[0] & 0xE0) == 0xC0)
+    {
+        cp = p[0] & 0x1F;
+        extra = 1;
+    }
+    else if ((p[0] & 0xF0) == 0xE0)
+    {
+        cp = p[0] & 0x0F;
+        extra = 2;
+    }
+    else if ((p[0] & 0xF8) == 0xF0)
+    {
+        cp = p[0] & 0x07;
+        extra = 3;
+    }
+    else
+    {
+        text += 1;
+        return 0xFFFD;
+    }
 
-        SFT_LMetrics lmetrics;
-        SFT_GMetrics gmetrics;
-        SFT_Glyph glyph;
-        SFT_Image imageBuffer;
-
-        if (sft_lmetrics(sft, &lmetrics) == 0 && sft_lookup(sft, *characters, &glyph) == 0)
+    for (int i = 1; i <= extra; ++i)
+    {
+        if ((p[i] & 0xC0) != 0x80)
         {
-            if (sft_gmetrics(sft, glyph, &gmetrics) == 0)
-            {
-                imageBuffer.width = gmetrics.minWidth;
-                imageBuffer.height = gmetrics.minHeight;
-                imageBuffer.pixels = (uint8_t *)malloc(imageBuffer.width * imageBuffer.height);
-
-                if (sft_render(sft, glyph, imageBuffer) == 0)
-                {
-                    Glyph g;
-                    g.width = imageBuffer.width;
-                    g.height = imageBuffer.height;
-                    g.advance = gmetrics.advanceWidth;
-                    g.xmin = gmetrics.leftSideBearing;
-                    g.ymin = gmetrics.yOffset;
-                    g.glyph = glyph;
-
-                    g.bitmap.resize(g.width * g.height * 4);
-                    for (int y = 0; y < g.height; ++y)
-                    {
-                        for (int x = 0; x < g.width; ++x)
-                        {
-                            int pixelIndex = y * g.width + x;
-                            uint8_t alpha = ((uint8_t *)imageBuffer.pixels)[pixelIndex];
-                            if (alpha > 0)
-                            {
-                                g.bitmap[pixelIndex * 4] = BGRA_TEXT[0];
-                                g.bitmap[pixelIndex * 4 + 1] = BGRA_TEXT[1];
-                                g.bitmap[pixelIndex * 4 + 2] = BGRA_TEXT[2];
-                                g.bitmap[pixelIndex * 4 + 3] = alpha;
-                            }
-                        }
-                    }
-
-                    glyphs[*characters] = g;
-                }
-                free(imageBuffer.pixels);
-            }
+            text += 1;
+            return 0xFFFD;
         }
-        ++characters;
+        cp = (cp << 6) | (p[i] & 0x3F);
     }
 
-    return 0;
+    // Overlong forms, surrogates and values past Unicode
+    static const uint32_t minValue[4] = {0, 0x80, 0x800, 0x10000};
+    if (cp < minValue[extra] || (cp >= 0xD800 && cp <= 0xDFFF) || cp > 0x10FFFF)
+    {
+        text += 1;
+        return 0xFFFD;
+    }
+
+    text += extra + 1;
+    return cp;
 }
 
-void setPixel(uint8_t *image, int x, int y, const uint8_t *color, int WIDTH, int HEIGHT)
+const GlyphAtlas::Cell *OSD::renderGlyph(uint32_t codepoint)
 {
-    if (x >= 0 && x < WIDTH && y >= 0 && y < HEIGHT)
+    SFT_GMetrics gmetrics;
+    SFT_Glyph glyph;
+    SFT_Image imageBuffer;
+
+    if (sft_lookup(sft, codepoint, &glyph) == 0 && sft_gmetrics(sft, glyph, &gmetrics) == 0)
     {
-        int index = (y * WIDTH + x) * 4;
-        image[index] = color[0];     // B
-        image[index + 1] = color[1]; // G
-        image[index + 2] = color[2]; // R
-        image[index + 3] = color[3]; // A
-    }
-}
+        glyphCoverage.assign(gmetrics.minWidth * gmetrics.minHeight, 0);
+        imageBuffer.width = gmetrics.minWidth;
+        imageBuffer.height = gmetrics.minHeight;
+        imageBuffer.pixels = glyphCoverage.data();
 
-void OSD::drawOutline(uint8_t* image, const Glyph& g, int x, int y, int outlineSize, int WIDTH, int HEIGHT) {
-    for (int j = -outlineSize; j <= outlineSize; ++j) {
-        for (int i = -outlineSize; i <= outlineSize; ++i) {
-            if (i * i + j * j <= outlineSize * outlineSize) { // Use circular distance
-                for (int h = 0; h < g.height; ++h) {
-                    for (int w = 0; w < g.width; ++w) {
-                        int srcIndex = (h * g.width + w) * 4;
-                        if (g.bitmap[srcIndex + 3] > 0) { // Check alpha value
-                            setPixel(image, x + w + i, y + h + j, BGRA_STROKE, WIDTH, HEIGHT);
-                        }
-                    }
-                }
-            }
+        if (sft_render(sft, glyph, imageBuffer) == 0)
+        {
+            return glyphs.add(codepoint, glyphCoverage.data(), imageBuffer.width, imageBuffer.height,
+                              gmetrics.advanceWidth, gmetrics.leftSideBearing, gmetrics.yOffset);
         }
     }
+
+    // Remember failures, so a broken glyph is not retried every second
+    if (failedGlyphs.size() >= 256)
+        failedGlyphs.clear();
+    failedGlyphs.insert(codepoint);
+    LOG_DEBUG("Unable to render glyph for codepoint " << codepoint);
+    return nullptr;
 }
-/*
-void OSD::drawOutline(uint8_t *image, const Glyph &g, int x, int y, int outlineSize, int WIDTH, int HEIGHT)
+
+const GlyphAtlas::Cell *OSD::getGlyph(uint32_t codepoint)
 {
-    for (int j = -outlineSize; j <= outlineSize; ++j)
-    {
-        for (int i = -outlineSize; i <= outlineSize; ++i)
-        {
-            if (abs(i) + abs(j) <= outlineSize)
-            { // Use Manhattan distance
-                for (int h = 0; h < g.height; ++h)
-                {
-                    for (int w = 0; w < g.width; ++w)
-                    {
-                        int srcIndex = (h * g.width + w) * 4;
-                        if (g.bitmap[srcIndex + 3] > 0)
-                        { // Check alpha value
-                            setPixel(image, x + w + i, y + h + j, BGRA_STROKE, WIDTH, HEIGHT);
-                        }
-                    }
-                }
-            }
-        }
-    }
+    const GlyphAtlas::Cell *g = glyphs.find(codepoint);
+    if (g || !sft || !sft->font || failedGlyphs.count(codepoint))
+        return g;
+    return renderGlyph(codepoint);
 }
-*/
-int OSD::drawText(uint8_t *image, const char *text, int WIDTH, int HEIGHT, int outlineSize)
+
+void OSD::layoutText(const char *text, std::vector<OSDGlyph> &layout, int outlineSize)
 {
     int penX = 1;
     int penY = 1;
 
-    // Draw text and outline
+    layout.clear();
     while (*text)
     {
-        auto it = glyphs.find(*text);
-        if (it != glyphs.end())
+        uint32_t codepoint = nextCodepoint(text);
+        const GlyphAtlas::Cell *g = getGlyph(codepoint);
+        if (g)
         {
-            const Glyph &g = it->second;
+            int x = penX + g->xmin + outlineSize;
+            int y = penY + (sft->yScale + g->ymin);
+            layout.push_back({codepoint, x - outlineSize, y - outlineSize, g->cellWidth});
 
-            int x = penX + g.xmin + outlineSize;
-            int y = penY + (sft->yScale + g.ymin);
-
-            // Draw the outline
-            drawOutline(image, g, x, y, outlineSize, WIDTH, HEIGHT);
-
-            // Draw the actual text
-            for (int j = 0; j < g.height; ++j)
-            {
-                for (int i = 0; i < g.width; ++i)
-                {
-                    int srcIndex = (j * g.width + i) * 4;
-                    if (g.bitmap[srcIndex + 3] > 0)
-                    { // Check alpha value
-                        setPixel(image, x + i, y + j, &g.bitmap[srcIndex], WIDTH, HEIGHT);
-                    }
-                }
-            }
-
-            penX += g.advance + (outlineSize * 2);
+            penX += g->advance + (outlineSize * 2);
         }
-        ++text;
     }
+}
 
-    return 0;
+void OSD::drawGlyphs(uint8_t *image, const std::vector<OSDGlyph> &layout, int WIDTH, int HEIGHT, int clipBegin, int clipEnd)
+{
+    // Glyphs come with their outline, so each one is a few row copies.
+    // Later glyphs overdraw earlier ones where outlines overlap.
+    for (const OSDGlyph &pg : layout)
+    {
+        if (pg.x >= clipEnd || pg.x + pg.width <= clipBegin)
+            continue;
+
+        const GlyphAtlas::Cell *g = glyphs.find(pg.codepoint);
+        if (g)
+            glyphs.blit(*g, image, pg.x, pg.y, WIDTH, HEIGHT, clipBegin, clipEnd);
+    }
 }
 
 int OSD::calculateTextSize(const char *text, uint16_t &width, uint16_t &height, int outlineSize)
@@ -184,19 +169,15 @@ int OSD::calculateTextSize(const char *text, uint16_t &width, uint16_t &height,
 
     while (*text)
     {
-        auto it = glyphs.find(*text);
-        if (it != glyphs.end())
+        const GlyphAtlas::Cell *g = getGlyph(nextCodepoint(text));
+        if (g)
         {
-            const Glyph &g = it->second;
-
-            width += g.advance + (outlineSize * 2);
-            if (g.height > height)
+            width += g->advance + (outlineSize * 2);
+            if (g->height > height)
             {
-                height = g.height;
+                height = g->height;
             }
         }
-
-        ++text;
     }
 
     height += sft->yScale;
@@ -245,7 +226,17 @@ int OSD::libschrift_init()
         return -1;
     }
 
-    renderGlyph("01234567890abcdefghijklmnopqrstuvwxyzABCDEFGHIJKLMNOPQRSTUVWXYZ!§$%&/()=?,.-_:;#'+*~}{} ");
+    // Outline and colours are baked into the atlas; a change of either
+    // recreates the OSD and lands here again. Characters beyond the common
+    // set below are rendered when a text first uses them.
+    glyphs.reset(BGRA_TEXT, BGRA_STROKE, osd.font_stroke, GLYPH_CACHE_BYTES);
+    failedGlyphs.clear();
+    const char *preload = "01234567890abcdefghijklmnopqrstuvwxyzABCDEFGHIJKLMNOPQRSTUVWXYZ!§$%&/()=?,.-_:;#'+*~}{} ";
+    while (*preload)
+    {
+        getGlyph(nextCodepoint(preload));
+    }
+    LOG_DEBUG("Glyph atlas: " << glyphs.size() << " glyphs, " << glyphs.bytes() << " bytes");
 
     fontData.clear();
     return 0;
@@ -253,30 +244,92 @@ int OSD::libschrift_init()
 
 void OSD::set_text(OSDItem *osdItem, IMPOSDRgnAttr *irgnAttr, const char *text, int posX, int posY, int angle)
 {
+    // Static text, or the same value as last time: nothing to send
+    if (osdItem->data != nullptr && osdItem->angle == angle && osdItem->text == text)
+        return;
 
     // size and stroke
-    uint8_t stroke_width = osd.font_stroke;
+    int stroke_width = glyphs.stroke();
     uint16_t item_width = 0;
     uint16_t item_height = 0;
 
+    // Keeps this text's glyphs in the cache while new ones are rendered
+    glyphs.beginUpdate();
     calculateTextSize(text, item_width, item_height, stroke_width);
 
     if (item_width % 2 != 0)
         ++item_width;
 
-    int item_size = item_width * item_height * 4;
+    layoutText(text, layoutScratch, stroke_width);
+
+    if (item_width != osdItem->canvasWidth || item_height != osdItem->canvasHeight || osdItem->canvas.empty())
+    {
+        // New size: redraw everything (assign keeps the capacity)
+        osdItem->canvas.assign(item_width * item_height * 4, 0);
+        osdItem->canvasWidth = item_width;
+        osdItem->canvasHeight = item_height;
+
+        drawGlyphs(osdItem->canvas.data(), layoutScratch, item_width, item_height, 0, item_width);
+    }
+    else
+    {
+        // Same size: find the columns covered by glyphs that changed or
+        // moved, old and new, and redraw only those
+        const std::vector<OSDGlyph> &prev = osdItem->layout;
+        int dirtyBegin = item_width;
+        int dirtyEnd = 0;
+        size_t n = std::max(prev.size(), layoutScratch.size());
+        for (size_t i = 0; i < n; ++i)
+        {
+            if (i < prev.size() && i < layoutScratch.size() && prev[i] == layoutScratch[i])
+                continue;
+            if (i < prev.size())
+            {
+                dirtyBegin = std::min(dirtyBegin, prev[i].x);
+                dirtyEnd = std::max(dirtyEnd, prev[i].x + prev[i].width);
+            }
+            if (i < layoutScratch.size())
+            {
+                dirtyBegin = std::min(dirtyBegin, layoutScratch[i].x);
+                dirtyEnd = std::max(dirtyEnd, layoutScratch[i].x + layoutScratch[i].width);
+            }
+        }
+        dirtyBegin = std::max(dirtyBegin, 0);
+        dirtyEnd = std::min<int>(dirtyEnd, item_width);
 
-    free(osdItem->data);
-    osdItem->data = (uint8_t *)malloc(item_size);
-    memset(osdItem->data, 0, item_size);
+        if (dirtyBegin < dirtyEnd)
+        {
+            uint8_t *canvas = osdItem->canvas.data();
+            for (int y = 0; y < item_height; ++y)
+            {
+                memset(canvas + (y * item_width + dirtyBegin) * 4, 0, (dirtyEnd - dirtyBegin) * 4);
+            }
+            drawGlyphs(canvas, layoutScratch, item_width, item_height, dirtyBegin, dirtyEnd);
+        }
+        else if (osdItem->angle == angle)
+        {
+            // Different text, same pixels (e.g. a glyph the font lacks)
+            osdItem->text = text;
+            return;
+        }
+    }
 
-    drawText(osdItem->data, text, item_width, item_height, stroke_width);
+    osdItem->layout.swap(layoutScratch);
+    osdItem->text = text;
+    osdItem->angle = angle;
 
+    osdItem->data = osdItem->canvas.data();
     if (angle)
     {
-        rotateBGRAImage(osdItem->data, item_width, item_height, angle, true);
+        rotateBGRAImage(osdItem->canvas.data(), item_width, item_height, angle, osdItem->rotated);
+        osdItem->data = osdItem->rotated.data();
     }
 
+    update_region(osdItem, irgnAttr, item_width, item_height, posX, posY);
+}
+
+void OSD::update_region(OSDItem *osdItem, IMPOSDRgnAttr *irgnAttr, uint16_t item_width, uint16_t item_height, int posX, int posY)
+{
     if (item_width != osdItem->width || item_height != osdItem->height)
     {
         if (irgnAttr == nullptr)
@@ -299,8 +352,143 @@ void OSD::set_text(OSDItem *osdItem, IMPOSDRgnAttr *irgnAttr, const char *text,
         osdItem->rgnAttrData->picData.pData = osdItem->data;
         IMP_OSD_UpdateRgnAttrData(osdItem->imp_rgn, osdItem->rgnAttrData);
     }
+}
+
+static inline void fillPixels(uint8_t *dst, const uint8_t *color, int count)
+{
+    for (int i = 0; i < count; ++i)
+        memcpy(dst + i * 4, color, 4);
+}
+
+void OSD::create_widget(OSDItem *item, uint16_t width, uint16_t height, int posX, int posY, int layer)
+{
+    item->imp_rgn = IMP_OSD_CreateRgn(nullptr);
+    IMP_OSD_RegisterRgn(item->imp_rgn, osdGrp, nullptr);
+
+    memset(&item->rgnAttr, 0, sizeof(IMPOSDRgnAttr));
+    item->rgnAttr.type = OSD_REG_PIC;
+    item->rgnAttr.fmt = PIX_FMT_BGRA;
+
+    item->canvas.assign(width * height * 4, 0);
+    item->canvasWidth = width;
+    item->canvasHeight = height;
+    item->data = item->canvas.data();
+    item->width = 0;
+    item->height = 0;
+    update_region(item, &item->rgnAttr, width, height, posX, posY);
+
+    IMPOSDGrpRgnAttr grpRgnAttr;
+    memset(&grpRgnAttr, 0, sizeof(IMPOSDGrpRgnAttr));
+    grpRgnAttr.show = 1;
+    grpRgnAttr.layer = layer;
+    grpRgnAttr.gAlphaEn = 1;
+    grpRgnAttr.fgAlhpa = 255;
+    IMP_OSD_SetGrpRgnAttr(item->imp_rgn, osdGrp, &grpRgnAttr);
+}
+
+void OSD::destroy_widget(OSDItem *item)
+{
+    if (item->data == nullptr)
+        return;
+
+    int ret = IMP_OSD_ShowRgn(item->imp_rgn, osdGrp, 0);
+    LOG_DEBUG_OR_ERROR(ret, "IMP_OSD_ShowRgn(" << item->imp_rgn << ", " << osdGrp << ", 0)");
+    ret = IMP_OSD_UnRegisterRgn(item->imp_rgn, osdGrp);
+    LOG_DEBUG_OR_ERROR(ret, "IMP_OSD_UnRegisterRgn(" << item->imp_rgn << ", " << osdGrp << ")");
+    IMP_OSD_DestroyRgn(item->imp_rgn);
+    item->data = nullptr;
+}
+
+void OSD::draw_bitrate_graph()
+{
+    // One 2 px bar per second, oldest on the left, scaled to the window max
+    const int width = osdBitrate.canvasWidth;
+    const int height = osdBitrate.canvasHeight;
+    const size_t count = bitrateHistory.size();
+
+    uint32_t maxValue = 1;
+    for (uint32_t v : bitrateHistory)
+        maxValue = std::max(maxValue, v);
+
+    bool changed = false;
+    for (size_t i = 0; i < count; ++i)
+    {
+        uint32_t v = bitrateHistory[(bitrateHead + i) % count];
+        uint8_t bar = (uint8_t)((uint64_t)v * (height - 2) / maxValue);
+        if (bar != bitrateBars[i])
+        {
+            bitrateBars[i] = bar;
+            changed = true;
+        }
+    }
+    if (!changed)
+        return;
+
+    static const uint8_t background[4] = {0, 0, 0, 96};
+    const uint8_t bar[4] = {BGRA_TEXT[0], BGRA_TEXT[1], BGRA_TEXT[2], 255};
+    uint8_t *canvas = osdBitrate.canvas.data();
+    for (int y = 0; y < height; ++y)
+    {
+        uint8_t *row = canvas + y * width * 4;
+        int fromBottom = height - 1 - y;
+        for (size_t i = 0; i < count; ++i)
+        {
+            const uint8_t *color = (fromBottom >= 1 && fromBottom <= bitrateBars[i]) ? bar : background;
+            fillPixels(row + i * 2 * 4, color, 2);
+        }
+    }
+
+    IMP_OSD_UpdateRgnAttrData(osdBitrate.imp_rgn, osdBitrate.rgnAttrData);
+}
+
+void OSD::draw_audio_meter(int length)
+{
+    static const uint8_t unlit[4] = {0x30, 0x30, 0x30, 0x80};
+    const int width = osdAudio.canvasWidth;
+    uint8_t *canvas = osdAudio.canvas.data();
+
+    for (int y = 0; y < osdAudio.canvasHeight; ++y)
+    {
+        uint8_t *row = canvas + y * width * 4;
+        memcpy(row, audioMeterLit.data(), length * 4);
+        fillPixels(row + length * 4, unlit, width - length);
+    }
 
-    return;
+    audioMeterLength = length;
+    IMP_OSD_UpdateRgnAttrData(osdAudio.imp_rgn, osdAudio.rgnAttrData);
+}
+
+void OSD::updateWidgets(bool secondTick)
+{
+    if (osd.motion_enabled && osdMotion.data)
+    {
+        // The marker is drawn once; motion only toggles its visibility
+        bool active = Motion::indicator.load();
+        if (active != motionShown)
+        {
+            IMP_OSD_ShowRgn(osdMotion.imp_rgn, osdGrp, active ? 1 : 0);
+            motionShown = active;
+        }
+    }
+
+    if (secondTick && osd.bitrate_graph_enabled && osdBitrate.data)
+    {
+        bitrateHistory[bitrateHead] = osd.stats.bps;
+        bitrateHead = (bitrateHead + 1) % bitrateHistory.size();
+        draw_bitrate_graph();
+    }
+
+#if defined(AUDIO_SUPPORT)
+    if (osd.audio_meter_enabled && osdAudio.data)
+    {
+        // Peak level over -60..0 dBFS, in 2 px steps
+        float peak = global_audio[0] ? global_audio[0]->levelPeakDbfs.load() : -96.0f;
+        float fraction = std::clamp((peak + 60.0f) / 60.0f, 0.0f, 1.0f);
+        int length = ((int)(fraction * osdAudio.canvasWidth) / 2) * 2;
+        if (length != audioMeterLength)
+            draw_audio_meter(length);
+    }
+#endif
 }
 
 unsigned long getSystemUptime()
@@ -358,75 +546,9 @@ void replace(std::string& str, const std::string& oldToken, const std::string& n
     }
 }
 
-void OSD::rotateBGRAImage(uint8_t *&inputImage, uint16_t &width, uint16_t &height, int angle, bool del = true)
+void OSD::rotateBGRAImage(const uint8_t *inputImage, uint16_t &width, uint16_t &height, int angle, std::vector<uint8_t> &output)
 {
-    double angleRad = angle * (M_PI / 180.0);
-
-    int originalCorners[4][2] = {
-        {0, 0},
-        {width, 0},
-        {0, height},
-        {width, height}};
-
-    int minX = INT_MAX;
-    int maxX = INT_MIN;
-    int minY = INT_MAX;
-    int maxY = INT_MIN;
-
-    for (auto &originalCorner : originalCorners)
-    {
-        int x = originalCorner[0];
-        int y = originalCorner[1];
-
-        int newX = static_cast<int>(x * cos(angleRad) - y * sin(angleRad));
-        int newY = static_cast<int>(x * sin(angleRad) + y * cos(angleRad));
-
-        if (newX < minX)
-            minX = newX;
-        if (newX > maxX)
-            maxX = newX;
-        if (newY < minY)
-            minY = newY;
-        if (newY > maxY)
-            maxY = newY;
-    }
-
-    int newWidth = maxX - minX + 1;
-    int newHeight = maxY - minY + 1;
-
-    int centerX = width / 2;
-    int centerY = height / 2;
-
-    int newCenterX = newWidth / 2;
-    int newCenterY = newHeight / 2;
-
-    auto *rotatedImage = new uint8_t[newWidth * newHeight * 4]();
-
-    for (int y = 0; y < newHeight; ++y)
-    {
-        for (int x = 0; x < newWidth; ++x)
-        {
-            int newX = x - newCenterX;
-            int newY = y - newCenterY;
-
-            int origX = static_cast<int>(newX * cos(angleRad) + newY * sin(angleRad)) + centerX;
-            int origY = static_cast<int>(-newX * sin(angleRad) + newY * cos(angleRad)) + centerY;
-
-            if (origX >= 0 && origX < width && origY >= 0 && origY < height)
-            {
-                for (int c = 0; c < 4; ++c)
-                {
-                    rotatedImage[(y * newWidth + x) * 4 + c] = inputImage[(origY * width + origX) * 4 + c];
-                }
-            }
-        }
-    }
-
-    if (del)
-        delete[] inputImage;
-    inputImage = rotatedImage;
-    width = newWidth;
-    height = newHeight;
+    ImageRotate::rotateBGRA(inputImage, width, height, angle, output);
 }
 
 uint16_t OSD::get_abs_pos(const uint16_t max, const uint16_t size, const int pos)
@@ -462,39 +584,6 @@ void OSD::set_pos(IMPOSDRgnAttr *rgnAttr, int x, int y, uint16_t width, uint16_t
     rgnAttr->rect.p1.y = rgnAttr->rect.p0.y + height - 1;
 }
 
-unsigned char *loadBGRAImage(const char *filepath, size_t &length)
-{
-    FILE *file = fopen(filepath, "rb");
-    if (!file)
-    {
-        printf("Failed to open the OSD logo file.\n");
-        return nullptr;
-    }
-
-    fseek(file, 0, SEEK_END);
-    length = ftell(file);
-    fseek(file, 0, SEEK_SET);
-
-    unsigned char *data = (unsigned char *)malloc(length);
-    if (!data)
-    {
-        printf("Failed to allocate memory for the image.\n");
-        fclose(file);
-        return nullptr;
-    }
-
-    if (fread(data, 1, length, file) != length)
-    {
-        printf("Failed to read OSD logo data.\n");
-        free(data);
-        fclose(file);
-        return nullptr;
-    }
-
-    fclose(file);
-    return data;
-}
-
 OSD *OSD::createNew(
     _osd &osd,
     int osdGrp,
@@ -513,7 +602,6 @@ void OSD::init()
     LOG_DEBUG_OR_ERROR(ret, "IMP_OSD_SetPoolSize(" << (cfg->general.osd_pool_size * 1024) << ")");
 
     // cfg = _cfg;
-    last_updated_second = -1;
 
     ret = IMP_Encoder_GetChnAttr(osdGrp, &channelAttributes);
     if (ret < 0)
@@ -666,8 +754,7 @@ void OSD::init()
             cfg->set<int>(getConfigPath("pos_logo_y").c_str(), -autoOffset, true);
         }
 
-        size_t imageSize;
-        auto imageData = loadBGRAImage(osd.logo_path, imageSize);
+        logo = OSDLogo::load(osd.logo_path, osd.logo_width, osd.logo_height);
 
         osdLogo.data = nullptr;
         osdLogo.imp_rgn = IMP_OSD_CreateRgn(nullptr);
@@ -676,33 +763,40 @@ void OSD::init()
 
         memset(&osdLogo.rgnAttr, 0, sizeof(IMPOSDRgnAttr));
 
-        // Verify OSD logo size vs dimensions
-        if ((osd.logo_width * osd.logo_height * 4) == (int)imageSize)
+        // The mapping is validated against logo_width/height on load
+        if (logo)
         {
+            uint16_t logo_width = logo->width();
+            uint16_t logo_height = logo->height();
+
+            // logo_width/height are for the stream0 resolution, other
+            // streams get a copy scaled to theirs
+            if (osd.logo_autoscale && cfg->stream0.height > 0 && stream_height != cfg->stream0.height)
+            {
+                logo_width = std::max(1, (logo_width * stream_height + cfg->stream0.height / 2) / cfg->stream0.height);
+                logo_height = std::max(1, (logo_height * stream_height + cfg->stream0.height / 2) / cfg->stream0.height);
+                LOG_DEBUG("Scaling OSD logo to " << logo_width << "x" << logo_height);
+            }
+
+            // The SDK only reads the picture, the read-only mapping can be
+            // handed over as is
+            osdLogo.data = const_cast<uint8_t *>(logo->scaled(logo_width, logo_height));
+
             osdLogo.rgnAttr.type = OSD_REG_PIC;
             osdLogo.rgnAttr.fmt = PIX_FMT_BGRA;
-            osdLogo.rgnAttr.data.picData.pData = imageData;
+            osdLogo.rgnAttr.data.picData.pData = osdLogo.data;
 
             // Logo rotation
-            uint16_t logo_width = osd.logo_width;
-            uint16_t logo_height = osd.logo_height;
             if (osd.logo_rotation)
             {
-                uint8_t *imageData = static_cast<uint8_t *>(osdLogo.rgnAttr.data.picData.pData);
-                rotateBGRAImage(imageData, logo_width,
-                                logo_height, osd.logo_rotation, false);
-                osdLogo.rgnAttr.data.picData.pData = imageData;
+                rotateBGRAImage(osdLogo.data, logo_width,
+                                logo_height, osd.logo_rotation, osdLogo.rotated);
+                osdLogo.rgnAttr.data.picData.pData = osdLogo.rotated.data();
             }
 
             set_pos(&osdLogo.rgnAttr, osd.pos_logo_x,
                     osd.pos_logo_y, logo_width, logo_height, stream_width, stream_height);
         }
-        else
-        {
-
-            LOG_ERROR("Invalid OSD logo dimensions. Imagesize=" << imageSize << ", " << osd.logo_width
-                                                                << "*" << osd.logo_height << "*4=" << (osd.logo_width * osd.logo_height * 4));
-        }
         IMP_OSD_SetRgnAttr(osdLogo.imp_rgn, &osdLogo.rgnAttr);
 
         IMPOSDGrpRgnAttr grpRgnAttr;
@@ -714,8 +808,96 @@ void OSD::init()
         IMP_OSD_SetGrpRgnAttr(osdLogo.imp_rgn, osdGrp, &grpRgnAttr);
     }
 
-    if(osd.start_delay)
-        startup_delay = (int)(osd.start_delay*1000)/THREAD_SLEEP;
+    // Widgets are sized from the font size
+    int unit = std::max(osd.font_size, 8) & ~1;
+
+    if (osd.motion_enabled)
+    {
+        if (osd.pos_motion_x == OSD_AUTO_VALUE)
+        {
+            // use cfg->set to set noSave, so auto values will not written to config
+            cfg->set<int>(getConfigPath("pos_motion_x").c_str(), -autoOffset, true);
+        }
+        if (osd.pos_motion_y == OSD_AUTO_VALUE)
+        {
+            cfg->set<int>(getConfigPath("pos_motion_y").c_str(), 2 * autoOffset + unit * 2, true);
+        }
+
+        // Red dot with the font stroke colour as outline, hidden until motion
+        create_widget(&osdMotion, unit, unit, osd.pos_motion_x, osd.pos_motion_y, 5);
+        osd.regions.motion = osdMotion.imp_rgn;
+
+        static const uint8_t red[4] = {0x20, 0x20, 0xE0, 0xFF};
+        float radius = unit / 2.0f;
+        float inner = radius - std::max(1, (int)osd.font_stroke);
+        for (int y = 0; y < unit; ++y)
+        {
+            for (int x = 0; x < unit; ++x)
+            {
+                float dx = x + 0.5f - radius;
+                float dy = y + 0.5f - radius;
+                float d = sqrtf(dx * dx + dy * dy);
+                if (d <= inner)
+                    memcpy(&osdMotion.canvas[(y * unit + x) * 4], red, 4);
+                else if (d <= radius)
+                    memcpy(&osdMotion.canvas[(y * unit + x) * 4], BGRA_STROKE, 4);
+            }
+        }
+        IMP_OSD_UpdateRgnAttrData(osdMotion.imp_rgn, osdMotion.rgnAttrData);
+        IMP_OSD_ShowRgn(osdMotion.imp_rgn, osdGrp, 0);
+        motionShown = false;
+    }
+
+    if (osd.bitrate_graph_enabled)
+    {
+        if (osd.pos_bitrate_graph_x == OSD_AUTO_VALUE)
+        {
+            cfg->set<int>(getConfigPath("pos_bitrate_graph_x").c_str(), autoOffset, true);
+        }
+        if (osd.pos_bitrate_graph_y == OSD_AUTO_VALUE)
+        {
+            cfg->set<int>(getConfigPath("pos_bitrate_graph_y").c_str(), -autoOffset, true);
+        }
+
+        create_widget(&osdBitrate, unit * 4, unit, osd.pos_bitrate_graph_x, osd.pos_bitrate_graph_y, 6);
+        osd.regions.bitrate_graph = osdBitrate.imp_rgn;
+        bitrateHistory.assign(unit * 2, 0);
+        bitrateBars.assign(unit * 2, 255);
+        bitrateHead = 0;
+        draw_bitrate_graph();
+    }
+
+    if (osd.audio_meter_enabled)
+    {
+        int meterHeight = std::max(unit / 3, 4) & ~1;
+        if (osd.pos_audio_meter_x == OSD_AUTO_VALUE)
+        {
+            cfg->set<int>(getConfigPath("pos_audio_meter_x").c_str(), autoOffset, true);
+        }
+        if (osd.pos_audio_meter_y == OSD_AUTO_VALUE)
+        {
+            int above = osd.bitrate_graph_enabled ? unit + autoOffset : 0;
+            cfg->set<int>(getConfigPath("pos_audio_meter_y").c_str(), -(autoOffset + above), true);
+        }
+
+        create_widget(&osdAudio, unit * 4, meterHeight, osd.pos_audio_meter_x, osd.pos_audio_meter_y, 7);
+        osd.regions.audio_meter = osdAudio.imp_rgn;
+
+        // Green up to -18 dBFS, yellow to -6 dBFS, red above
+        static const uint8_t green[4] = {0x40, 0xC0, 0x40, 0xFF};
+        static const uint8_t yellow[4] = {0x20, 0xD0, 0xE0, 0xFF};
+        static const uint8_t red[4] = {0x30, 0x30, 0xE0, 0xFF};
+        int width = unit * 4;
+        audioMeterLit.resize(width * 4);
+        for (int x = 0; x < width; ++x)
+        {
+            const uint8_t *color = x < width * 42 / 60 ? green : x < width * 54 / 60 ? yellow : red;
+            memcpy(&audioMeterLit[x * 4], color, 4);
+        }
+        draw_audio_meter(0);
+    }
+
+    start_time = std::chrono::steady_clock::now() + std::chrono::milliseconds(osd.start_delay);
 
     //start();
 }
@@ -771,147 +953,231 @@ int OSD::exit()
     IMP_OSD_DestroyRgn(osdUptm.imp_rgn);
     IMP_OSD_DestroyRgn(osdLogo.imp_rgn);
 
+    destroy_widget(&osdMotion);
+    destroy_widget(&osdBitrate);
+    destroy_widget(&osdAudio);
+
     ret = IMP_OSD_DestroyGroup(osdGrp);
     LOG_DEBUG_OR_ERROR(ret, "IMP_OSD_DestroyGroup(" << osdGrp << ")");
 
-    // cleanup osd image data
-    free(osdTime.data);
-    free(osdUser.data);
-    free(osdUptm.data);
-    free(osdLogo.data);
+    // release the logo mapping, text items draw into their own buffers
+    osdLogo.data = nullptr;
+    osdLogo.rotated.clear();
+    logo.reset();
 
     sft_freefont(sft->font);
     return 0;
 }
 
-void OSD::updateDisplayEverySecond()
+void OSD::updateDisplay(const struct tm *ltime)
 {
-    gettimeofday(&tm, NULL);
+    // Every item is offered its new text; set_text() skips the ones whose
+    // text did not change, so only dirty items reach the SDK
 
-    current = time(nullptr);
-    ltime = localtime(&current);
-
-    // Check if we have moved to a new second
-    if (ltime->tm_sec != last_updated_second)
+    // Format and update system time
+    if (osd.time_enabled)
     {
-        flag |= 7;
-        // Update the last second tracker
-        last_updated_second = ltime->tm_sec;
+        strftime(timeFormatted, sizeof(timeFormatted), osd.time_format, ltime);
+
+        set_text(&osdTime, nullptr, timeFormatted,
+                 osd.pos_time_x, osd.pos_time_y, osd.time_rotation);
     }
-    else
+
+    // Format and update user text
+    if (osd.user_text_enabled)
     {
-        // The flag ensures that only 1 OSD object is updated
-        // on calling OSD::updateDisplayEverySecond()
-        // this should relieve the system
-        if (flag != 0)
+        std::string user_text = osd.user_text_format;
+
+        if (strstr(osd.user_text_format, "%hostname") != nullptr)
         {
+            replace(user_text, "%hostname", hostname);
+        }
 
-            // Format and update system time
-            if ((flag & 1) && osd.time_enabled)
-            {
-                strftime(timeFormatted, sizeof(timeFormatted), osd.time_format, ltime);
+        if (strstr(osd.user_text_format, "%ipaddress") != nullptr)
+        {
+            replace(user_text, "%ipaddress", ip);
+        }
 
-                set_text(&osdTime, nullptr, timeFormatted,
-                         osd.pos_time_x, osd.pos_time_y, osd.time_rotation);
+        if (strstr(osd.user_text_format, "%fps") != nullptr)
+        {
+            char fps[4];
+            snprintf(fps, 4, "%3d", osd.stats.fps);
+            replace(user_text, "%fps", fps);
+        }
 
-                flag ^= 1;
-                return;
-            }
+        if (strstr(osd.user_text_format, "%bps") != nullptr)
+        {
+            char bps[8];
+            snprintf(bps, 8, "%5d", osd.stats.bps);
+            replace(user_text, "%bps", bps);
+        }
 
-            // Format and update user text
-            if ((flag & 2) && osd.user_text_enabled)
-            {
-                std::string user_text = osd.user_text_format;
-
-                if (strstr(osd.user_text_format, "%hostname") != nullptr)
-                {
-                    replace(user_text, "%hostname", hostname);
-                }
-
-                if (strstr(osd.user_text_format, "%ipaddress") != nullptr)
-                {
-                    replace(user_text, "%ipaddress", ip);
-                }
-
-                if (strstr(osd.user_text_format, "%fps") != nullptr)
-                {
-                    char fps[4];
-                    snprintf(fps, 4, "%3d", osd.stats.fps);
-                    replace(user_text, "%fps", fps);
-                }
-
-                if (strstr(osd.user_text_format, "%bps") != nullptr)
-                {
-                    char bps[8];
-                    snprintf(bps, 8, "%5d", osd.stats.bps);
-                    replace(user_text, "%bps", bps);
-                }
-
-                set_text(&osdUser, nullptr, user_text.c_str(),
-                         osd.pos_user_text_x, osd.pos_user_text_y, osd.user_text_rotation);
-
-                user_text.clear();
-
-                flag ^= 2;
-                return;
-            }
+        set_text(&osdUser, nullptr, user_text.c_str(),
+                 osd.pos_user_text_x, osd.pos_user_text_y, osd.user_text_rotation);
+    }
 
-            // Format and update uptime
-            if ((flag & 4) && osd.uptime_enabled)
-            {
-                unsigned long currentUptime = getSystemUptime();
-                unsigned long days = currentUptime / 86400;
-                unsigned long hours = (currentUptime % 86400) / 3600;
-                unsigned long minutes = (currentUptime % 3600) / 60;
-                //unsigned long seconds = currentUptime % 60;
+    // Format and update uptime
+    if (osd.uptime_enabled)
+    {
+        unsigned long currentUptime = getSystemUptime();
+        unsigned long days = currentUptime / 86400;
+        unsigned long hours = (currentUptime % 86400) / 3600;
+        unsigned long minutes = (currentUptime % 3600) / 60;
+        //unsigned long seconds = currentUptime % 60;
+
+        snprintf(uptimeFormatted, sizeof(uptimeFormatted), osd.uptime_format, days, hours, minutes);
+
+        set_text(&osdUptm, nullptr, uptimeFormatted,
+                 osd.pos_uptime_x, osd.pos_uptime_y, osd.uptime_rotation);
+    }
 
-                snprintf(uptimeFormatted, sizeof(uptimeFormatted), osd.uptime_format, days, hours, minutes);
+    updateWidgets(true);
+}
 
-                set_text(&osdUptm, nullptr, uptimeFormatted,
-                         osd.pos_uptime_x, osd.pos_uptime_y, osd.uptime_rotation);
+// Wakes the OSD thread from its timer wait; lives for the whole process
+static int osd_wake_fd = eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK);
 
-                flag ^= 4;
-                return;
-            }
+void OSD::wake_thread()
+{
+    if (osd_wake_fd >= 0)
+    {
+        uint64_t one = 1;
+        if (write(osd_wake_fd, &one, sizeof(one)) < 0)
+        {
+            LOG_DEBUG("OSD wakeup failed: " << strerror(errno));
         }
     }
 }
 
+static int64_t timespec_ns(const struct timespec &ts)
+{
+    return (int64_t)ts.tv_sec * 1000000000LL + ts.tv_nsec;
+}
+
 void *OSD::thread_entry(void *arg) {
     LOG_DEBUG("start osd update thread.");
 
+    // Texts for second N are rendered this long before N begins, so the new
+    // bitmap is in place for the first frame of that second
+    constexpr int64_t RENDER_LEAD_NS = 30000000;
+    constexpr int64_t NS_PER_SEC = 1000000000LL;
+    // Motion marker and audio meter sampling
+    constexpr int64_t WIDGET_INTERVAL_NS = 250000000;
+
+    // Absolute wall clock timer; a clock change (NTP, timezone) cancels the
+    // wait and the next boundary is recomputed
+    int tfd = timerfd_create(CLOCK_REALTIME, TFD_CLOEXEC);
+    if (tfd < 0)
+    {
+        LOG_ERROR("timerfd_create() failed: " << strerror(errno));
+        return 0;
+    }
+
+    uint64_t drain;
+    while (read(osd_wake_fd, &drain, sizeof(drain)) > 0)
+    {
+    }
+
     global_osd_thread_signal = true;
     while (global_osd_thread_signal) {
+        struct timespec now;
+        clock_gettime(CLOCK_REALTIME, &now);
+        auto steadyNow = std::chrono::steady_clock::now();
+
+        // Next second to render: the one after the current, unless we are
+        // already inside its lead window (just rendered it)
+        time_t nextSecond = now.tv_sec + 1;
+        if (now.tv_nsec >= NS_PER_SEC - RENDER_LEAD_NS)
+            nextSecond++;
+        int64_t wakeNs = (int64_t)nextSecond * NS_PER_SEC - RENDER_LEAD_NS;
+
+        // An OSD still waiting for its start delay may need us earlier, live
+        // widgets are sampled in between seconds
+        for (auto v : global_video)
+        {
+            if (v == nullptr || !v->active || v->imp_encoder->osd == nullptr)
+                continue;
+
+            OSD *osd = v->imp_encoder->osd;
+            if (!osd->is_started)
+            {
+                int64_t delayNs = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                                      osd->start_time - steadyNow).count();
+                wakeNs = std::min(wakeNs, timespec_ns(now) + std::max<int64_t>(delayNs, 0));
+            }
+            else if (osd->has_live_widgets())
+            {
+                wakeNs = std::min(wakeNs, (timespec_ns(now) / WIDGET_INTERVAL_NS + 1) * WIDGET_INTERVAL_NS);
+            }
+        }
+
+        struct itimerspec its = {};
+        its.it_value.tv_sec = wakeNs / NS_PER_SEC;
+        its.it_value.tv_nsec = wakeNs % NS_PER_SEC;
+        if (its.it_value.tv_sec == 0 && its.it_value.tv_nsec == 0)
+            its.it_value.tv_nsec = 1;
+        if (timerfd_settime(tfd, TFD_TIMER_ABSTIME | TFD_TIMER_CANCEL_ON_SET, &its, nullptr) < 0)
+        {
+            LOG_ERROR("timerfd_settime() failed: " << strerror(errno));
+            break;
+        }
+
+        struct pollfd fds[2] = {{tfd, POLLIN, 0}, {osd_wake_fd, POLLIN, 0}};
+        if (poll(fds, osd_wake_fd >= 0 ? 2 : 1, -1) < 0 && errno != EINTR)
+        {
+            LOG_ERROR("poll() failed: " << strerror(errno));
+            break;
+        }
+        uint64_t expirations;
+        if (read(tfd, &expirations, sizeof(expirations)) < 0 && errno == ECANCELED)
+        {
+            LOG_DEBUG("wall clock changed, realigning OSD updates");
+        }
+        while (osd_wake_fd >= 0 && read(osd_wake_fd, &drain, sizeof(drain)) > 0)
+        {
+        }
+
+        if (!global_osd_thread_signal)
+            break;
+
+        clock_gettime(CLOCK_REALTIME, &now);
+        steadyNow = std::chrono::steady_clock::now();
+
+        // Render second N during its lead window, otherwise whatever the
+        // clock says now (start delay expired, woken early)
+        time_t renderSecond = now.tv_sec;
+        bool tick = timespec_ns(now) >= (int64_t)nextSecond * NS_PER_SEC - RENDER_LEAD_NS;
+        if (tick && now.tv_sec < nextSecond)
+            renderSecond = nextSecond;
+        struct tm ltime;
+        localtime_r(&renderSecond, &ltime);
+
+        // One batch for all streams
         for (auto v : global_video)
         {
-            if (v != nullptr)
+            if (v == nullptr || !v->active || v->imp_encoder->osd == nullptr)
+                continue;
+
+            OSD *osd = v->imp_encoder->osd;
+            if (!osd->is_started)
+            {
+                if (steadyNow < osd->start_time)
+                    continue;
+                osd->start();
+                osd->updateDisplay(&ltime);
+            }
+            else if (tick)
+            {
+                osd->updateDisplay(&ltime);
+            }
+            else
             {
-                if (v->active)
-                {
-                    if ((v->imp_encoder->osd != nullptr))
-                    {
-                        if (v->imp_encoder->osd->is_started)
-                        {
-                            v->imp_encoder->osd->updateDisplayEverySecond();
-                        }
-                        else
-                        {
-                            if (v->imp_encoder->osd->startup_delay)
-                            {
-                                v->imp_encoder->osd->startup_delay--;
-                            }
-                            else
-                            {
-                                v->imp_encoder->osd->start();
-                            }
-                        }
-                    }
-                }
+                osd->updateWidgets(false);
             }
         }
-        usleep(THREAD_SLEEP);
     }
 
+    close(tfd);
     LOG_DEBUG("exit osd update thread.");
     return 0;
 }
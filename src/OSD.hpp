@@ -2,7 +2,11 @@
 #define OSD_hpp
 
 //#include <map>
+#include <chrono>
 #include <memory>
+#include <string>
+#include <unordered_set>
+#include <vector>
 #include "Config.hpp"
 #include <imp/imp_osd.h>
 #include <imp/imp_encoder.h>
@@ -11,12 +15,25 @@
 #include <arpa/inet.h>
 #include <sys/sysinfo.h>
 #include "schrift.h"
+#include "GlyphAtlas.hpp"
+#include "OSDLogo.hpp"
 
 #if defined(PLATFORM_T31) || defined(PLATFORM_C100) || defined(PLATFORM_T40) || defined(PLATFORM_T41)
 #define IMPEncoderCHNAttr IMPEncoderChnAttr
 #define IMPEncoderCHNStat IMPEncoderChnStat
 #endif
 
+// A glyph placed on a text line; x, y is the top left of its outline cell
+struct OSDGlyph
+{
+    uint32_t codepoint;
+    int x;
+    int y;
+    int width;
+
+    bool operator==(const OSDGlyph &o) const { return codepoint == o.codepoint && x == o.x; }
+};
+
 struct OSDItem
 {
     IMPRgnHandle imp_rgn;
@@ -25,16 +42,17 @@ struct OSDItem
     uint16_t height;
     IMPOSDRgnAttr rgnAttr;
     IMPOSDRgnAttrData *rgnAttrData;
-};
 
-struct Glyph {
-    int width;
-    int height;
-    std::vector<uint8_t> bitmap;
-    int advance;
-    int xmin;
-    int ymin;
-    SFT_Glyph glyph;
+    // Text items keep their last bitmap and layout, so an update only
+    // redraws the glyphs that changed. The SDK copies the region data on
+    // update, so both buffers are reused in place.
+    std::string text;
+    int angle;
+    std::vector<OSDGlyph> layout;
+    std::vector<uint8_t> canvas; // unrotated
+    uint16_t canvasWidth;
+    uint16_t canvasHeight;
+    std::vector<uint8_t> rotated;
 };
 
 class OSD
@@ -49,40 +67,71 @@ public:
     int exit();
     int start();
 
-    void updateDisplayEverySecond();
+    void updateDisplay(const struct tm *ltime);
+    // Sample the live widgets; the bitrate graph advances on secondTick only
+    void updateWidgets(bool secondTick);
+    // Widgets that want sampling more often than once a second
+    bool has_live_widgets() const
+    {
+        return (osd.motion_enabled && osdMotion.data) || (osd.audio_meter_enabled && osdAudio.data);
+    }
     static void *thread_entry(void *arg);
+    // Wake the OSD thread, e.g. after clearing global_osd_thread_signal
+    static void wake_thread();
 
-    void rotateBGRAImage(uint8_t *&inputImage, uint16_t &width, uint16_t &height, int angle, bool del);
+    void rotateBGRAImage(const uint8_t *inputImage, uint16_t &width, uint16_t &height, int angle, std::vector<uint8_t> &output);
     static void set_pos(IMPOSDRgnAttr *rgnAttr, int x, int y, uint16_t width, uint16_t height, const uint16_t max_width, const uint16_t max_height);
     static uint16_t get_abs_pos(const uint16_t max,const uint16_t size,const int pos);
-    int startup_delay{0};
+    std::chrono::steady_clock::time_point start_time;
     bool is_started = false;
 
 private:
 
     // libschrift
     //std::vector<uint8_t> fontData;
-    std::unordered_map<char, Glyph> glyphs;
-    SFT *sft;
+    GlyphAtlas glyphs;
+    SFT *sft = nullptr;
     int load_font();
     int libschrift_init();
-    int renderGlyph(const char* characters);
-    void drawOutline(uint8_t* image, const Glyph& g, int x, int y, int outlineSize, int WIDTH, int HEIGHT);
+    const GlyphAtlas::Cell *renderGlyph(uint32_t codepoint);
+    const GlyphAtlas::Cell *getGlyph(uint32_t codepoint);
+    std::vector<uint8_t> glyphCoverage;
+    std::unordered_set<uint32_t> failedGlyphs;
+    // Rendered glyph memory per OSD, least recently used glyphs go first
+    static constexpr size_t GLYPH_CACHE_BYTES = 256 * 1024;
     int calculateTextSize(const char* text, uint16_t& width, uint16_t& height, int outlineSize);
-    int drawText(uint8_t* image, const char* text, int WIDTH, int HEIGHT, int outlineSize);
+    void layoutText(const char* text, std::vector<OSDGlyph>& layout, int outlineSize);
+    void drawGlyphs(uint8_t* image, const std::vector<OSDGlyph>& layout, int WIDTH, int HEIGHT, int clipBegin, int clipEnd);
+    std::vector<OSDGlyph> layoutScratch;
     uint8_t BGRA_STROKE[4];
     uint8_t BGRA_TEXT[4];
 
     _osd &osd;
-    int last_updated_second;
 
 
     OSDItem osdTime{};
     OSDItem osdUser{};
     OSDItem osdUptm{};
     OSDItem osdLogo{};
+    std::shared_ptr<OSDLogo> logo; // shared with the other streams
 
     void set_text(OSDItem *osdItem, IMPOSDRgnAttr *rgnAttr, const char *text, int posX, int posY, int angle);
+    void update_region(OSDItem *osdItem, IMPOSDRgnAttr *irgnAttr, uint16_t item_width, uint16_t item_height, int posX, int posY);
+
+    // Widgets: fixed size regions, redrawn only when what they show changes
+    OSDItem osdMotion{};
+    OSDItem osdBitrate{};
+    OSDItem osdAudio{};
+    bool motionShown = false;
+    std::vector<uint32_t> bitrateHistory; // ring, one sample per second
+    size_t bitrateHead = 0;
+    std::vector<uint8_t> bitrateBars;     // bar heights on screen
+    int audioMeterLength = -1;            // lit pixels on screen
+    std::vector<uint8_t> audioMeterLit;   // one fully lit row
+    void create_widget(OSDItem *item, uint16_t width, uint16_t height, int posX, int posY, int layer);
+    void destroy_widget(OSDItem *item);
+    void draw_bitrate_graph();
+    void draw_audio_meter(int length);
     std::string getConfigPath(const char *itemName);
 
     IMPEncoderCHNAttr channelAttributes;
@@ -98,15 +147,11 @@ private:
     uint16_t stream_width;
     uint16_t stream_height;
 
-    time_t current;
-    struct tm *ltime;
-    struct timeval tm;
-
-    char timeFormatted[32];
-    char uptimeFormatted[32];
+    // Room for localized (UTF-8) month and day names
+    char timeFormatted[128];
+    char uptimeFormatted[64];
     char fps[4];
     char bps[8];
-    uint8_t flag{0};
 };
 
 #endif
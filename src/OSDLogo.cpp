@@ -0,0 +1,157 @@
+#include "OSDLogo.hpp"
+#include "Logger.hpp"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#define MODULE "OSDLogo"
+
+namespace {
+
+// OSD regions cannot be larger than a frame
+constexpr int MAX_DIMENSION = 4096;
+
+std::mutex registryMutex;
+std::map<std::string, std::weak_ptr<OSDLogo>> registry;
+
+} // namespace
+
+std::shared_ptr<OSDLogo> OSDLogo::load(const char *path, int width, int height)
+{
+    if (width <= 0 || height <= 0 || width > MAX_DIMENSION || height > MAX_DIMENSION)
+    {
+        LOG_ERROR("Invalid OSD logo dimensions " << width << "x" << height);
+        return nullptr;
+    }
+
+    std::string key = std::string(path) + "@" + std::to_string(width) + "x" + std::to_string(height);
+
+    std::lock_guard<std::mutex> lock(registryMutex);
+    if (auto logo = registry[key].lock())
+        return logo;
+
+    int fd = open(path, O_RDONLY | O_CLOEXEC);
+    if (fd < 0)
+    {
+        LOG_ERROR("Failed to open the OSD logo " << path << ": " << strerror(errno));
+        return nullptr;
+    }
+
+    struct stat st;
+    if (fstat(fd, &st) != 0 || !S_ISREG(st.st_mode))
+    {
+        LOG_ERROR("OSD logo " << path << " is not a regular file");
+        close(fd);
+        return nullptr;
+    }
+
+    size_t expected = (size_t) width * height * 4;
+    if ((size_t) st.st_size != expected)
+    {
+        LOG_ERROR("Invalid OSD logo dimensions. Imagesize=" << st.st_size << ", " << width
+                  << "*" << height << "*4=" << expected);
+        close(fd);
+        return nullptr;
+    }
+
+    void *mapped = mmap(nullptr, expected, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (mapped == MAP_FAILED)
+    {
+        LOG_ERROR("Failed to map the OSD logo " << path << ": " << strerror(errno));
+        return nullptr;
+    }
+
+    std::shared_ptr<OSDLogo> logo(new OSDLogo());
+    logo->pixels = static_cast<const uint8_t *>(mapped);
+    logo->mappedBytes = expected;
+    logo->imageWidth = width;
+    logo->imageHeight = height;
+    registry[key] = logo;
+
+    LOG_DEBUG("Mapped OSD logo " << path << " (" << width << "x" << height << ")");
+    return logo;
+}
+
+OSDLogo::~OSDLogo()
+{
+    if (pixels)
+        munmap(const_cast<uint8_t *>(pixels), mappedBytes);
+}
+
+const uint8_t *OSDLogo::scaled(uint16_t width, uint16_t height)
+{
+    if (width == imageWidth && height == imageHeight)
+        return pixels;
+    if (width == 0 || height == 0)
+        return nullptr;
+
+    std::lock_guard<std::mutex> lock(scaledMutex);
+    std::vector<uint8_t> &out = scaledCopies[{width, height}];
+    if (!out.empty())
+        return out.data();
+
+    // Bilinear, 16.16 fixed point, sampling at pixel centres. Colour is
+    // weighted by alpha so transparent pixels do not bleed into the edges.
+    out.resize((size_t) width * height * 4);
+    const int64_t stepX = ((int64_t) imageWidth << 16) / width;
+    const int64_t stepY = ((int64_t) imageHeight << 16) / height;
+    const int maxX = imageWidth - 1;
+    const int maxY = imageHeight - 1;
+
+    for (int y = 0; y < height; ++y)
+    {
+        int64_t fy = std::max<int64_t>((y * stepY) + stepY / 2 - 32768, 0);
+        int y0 = std::min((int) (fy >> 16), maxY);
+        int y1 = std::min(y0 + 1, maxY);
+        uint32_t wy = (fy & 0xFFFF) >> 8;
+
+        for (int x = 0; x < width; ++x)
+        {
+            int64_t fx = std::max<int64_t>((x * stepX) + stepX / 2 - 32768, 0);
+            int x0 = std::min((int) (fx >> 16), maxX);
+            int x1 = std::min(x0 + 1, maxX);
+            uint32_t wx = (fx & 0xFFFF) >> 8;
+
+            const uint8_t *p[4] = {
+                pixels + ((size_t) y0 * imageWidth + x0) * 4,
+                pixels + ((size_t) y0 * imageWidth + x1) * 4,
+                pixels + ((size_t) y1 * imageWidth + x0) * 4,
+                pixels + ((size_t) y1 * imageWidth + x1) * 4,
+            };
+            const uint32_t w[4] = {
+                (256 - wx) * (256 - wy),
+                wx * (256 - wy),
+                (256 - wx) * wy,
+                wx * wy,
+            };
+
+            uint64_t alpha = 0;
+            uint64_t color[3] = {0, 0, 0};
+            for (int i = 0; i < 4; ++i)
+            {
+                uint64_t wa = (uint64_t) w[i] * p[i][3];
+                alpha += wa;
+                for (int c = 0; c < 3; ++c)
+                    color[c] += wa * p[i][c];
+            }
+
+            uint8_t *dst = &out[((size_t) y * width + x) * 4];
+            if (alpha == 0)
+            {
+                std::memset(dst, 0, 4);
+                continue;
+            }
+            for (int c = 0; c < 3; ++c)
+                dst[c] = (uint8_t) ((color[c] + alpha / 2) / alpha);
+            dst[3] = (uint8_t) ((alpha + 32768) >> 16);
+        }
+    }
+
+    return out.data();
+}
@@ -0,0 +1,53 @@
+#ifndef OSD_LOGO_HPP
+#define OSD_LOGO_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <utility>
+#include <vector>
+
+/* OSD logo image, raw BGRA.
+ *
+ * The file is mapped read-only instead of read into a heap copy, and the
+ * mapping is shared by every OSD showing the same file with the same
+ * dimensions; it is unmapped when the last of them lets go. The file size
+ * must be exactly width * height * 4.
+ *
+ * Scaled copies for other stream resolutions are made on first request and
+ * kept with the image, so streams of equal size share those as well.
+ */
+class OSDLogo
+{
+public:
+    // Map 'path', or return the mapping already open for it. Null when the
+    // file cannot be mapped or does not match the dimensions.
+    static std::shared_ptr<OSDLogo> load(const char *path, int width, int height);
+
+    ~OSDLogo();
+
+    const uint8_t *data() const { return pixels; }
+    uint16_t width() const { return imageWidth; }
+    uint16_t height() const { return imageHeight; }
+
+    // The image resampled to width x height, the original when equal
+    const uint8_t *scaled(uint16_t width, uint16_t height);
+
+private:
+    OSDLogo() = default;
+    OSDLogo(const OSDLogo &) = delete;
+    OSDLogo &operator=(const OSDLogo &) = delete;
+
+    const uint8_t *pixels = nullptr;
+    size_t mappedBytes = 0;
+    uint16_t imageWidth = 0;
+    uint16_t imageHeight = 0;
+
+    std::mutex scaledMutex;
+    std::map<std::pair<uint16_t, uint16_t>, std::vector<uint8_t>> scaledCopies;
+};
+
+#endif // OSD_LOGO_HPP
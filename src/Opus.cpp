@@ -1,14 +1,17 @@
 #include "Config.hpp"
 #include "Logger.hpp"
 #include "Opus.hpp"
+#include <algorithm>
 #include <atomic>
+#include <chrono>
 #include "RTSPStatus.hpp"
+#include "globals.hpp"
 
 namespace { std::atomic<uint32_t> g_opusMismatches{0}; }
 
-Opus* Opus::createNew(int sampleRate, int numChn)
+Opus* Opus::createNew(int sampleRate, int numChn, int audioChn)
 {
-    return new Opus(sampleRate, numChn);
+    return new Opus(sampleRate, numChn, audioChn);
 }
 
 Opus::~Opus()
@@ -35,8 +38,12 @@ int Opus::open()
         LOG_ERROR("Failed to set bitrate (" << bitrate << ") for Opus encoder: " << opus_strerror(opusError));
     }
 
-    // Highest complexity for quality (CPU usage is negligible at 1ch/48k on this SoC)
-    opus_encoder_ctl(encoder, OPUS_SET_COMPLEXITY(10));
+    // Start at the highest complexity for quality, adaptComplexity() backs off
+    // if encoding gets close to the frame budget on a loaded SoC
+    complexity = MAX_COMPLEXITY;
+    encodeAvgUs = 0;
+    framesSinceAdjust = 0;
+    opus_encoder_ctl(encoder, OPUS_SET_COMPLEXITY(complexity));
     // Make VBR explicit (better quality at target rate)
     opus_encoder_ctl(encoder, OPUS_SET_VBR(1));
     // Hint fullband capability
@@ -44,6 +51,30 @@ int Opus::open()
     // Content is typically music/ambience on cams; this helps tuning psychoacoustics
     opus_encoder_ctl(encoder, OPUS_SET_SIGNAL(OPUS_SIGNAL_MUSIC));
 
+    frameDurationMs = cfg->audio.opus_frame_duration;
+    dtx = cfg->audio.opus_dtx;
+    fec = cfg->audio.opus_fec;
+    dtxFrames = 0;
+
+    // Discontinuous transmission: only comfort noise updates during silence
+    opus_encoder_ctl(encoder, OPUS_SET_DTX(dtx ? 1 : 0));
+
+    // In-band FEC carries a low bitrate copy of the previous frame. The
+    // redundancy is driven by the expected loss, which starts at zero and is
+    // raised from RTCP receiver reports in updatePacketLoss().
+    opus_encoder_ctl(encoder, OPUS_SET_INBAND_FEC(fec ? 1 : 0));
+    lossPercent = -1;
+    updatePacketLoss();
+
+    // One Opus packet per RTP packet; long packets at high bitrates no longer
+    // fit a single datagram and get fragmented by the IP layer
+    int packetBytes = cfg->audio.input_bitrate * frameDurationMs / 8;
+    if (packetBytes > 1200)
+    {
+        LOG_WARN("Opus " << frameDurationMs << "ms packets at " << cfg->audio.input_bitrate
+                 << "kbps average " << packetBytes << " bytes, consider shorter packets");
+    }
+
     opusError = opus_encoder_ctl(encoder, OPUS_GET_BITRATE(&bitrate));
     if (opusError != OPUS_OK)
     {
@@ -51,7 +82,8 @@ int Opus::open()
         return -1;
     }
 
-    LOG_INFO("Encoder bitrate: " << bitrate);
+    LOG_INFO("Encoder bitrate: " << bitrate << ", frame " << frameDurationMs << "ms"
+             << (dtx ? ", DTX" : "") << (fec ? ", FEC" : ""));
 
     return 0;
 }
@@ -76,12 +108,12 @@ int Opus::encode(IMPAudioFrame *data, unsigned char *outbuf, int *outLen)
     if (frame_count < 10) {
         LOG_DEBUG("Opus encode frame " << frame_count << ": len=" << data->len
                  << " bytes, samples_per_ch=" << samples_per_channel
-                 << " (20ms at " << sampleRate << "Hz)");
+                 << " (" << frameDurationMs << "ms at " << sampleRate << "Hz)");
         frame_count++;
     }
 
-    // Calculate expected samples for 20ms at current sample rate
-    int expected_samples = sampleRate * 0.020;
+    // Calculate expected samples for the configured packet duration
+    int expected_samples = sampleRate * frameDurationMs / 1000;
     if (samples_per_channel != expected_samples) {
         uint64_t cnt = ++g_opusMismatches;
         // Expose metric (single audio channel assumed as audio0)
@@ -91,25 +123,32 @@ int Opus::encode(IMPAudioFrame *data, unsigned char *outbuf, int *outLen)
             if (cnt <= 10 || (cnt % 100) == 0) {
                 LOG_WARN("Opus underfilled frame: got " << samples_per_channel
                          << ", expected " << expected_samples
-                         << " (20ms@" << sampleRate << "Hz) — dropping to preserve framing");
+                         << " (" << frameDurationMs << "ms@" << sampleRate << "Hz) — dropping to preserve framing");
             }
             return -1; // let upstream accumulate more
         } else {
             if (cnt <= 10 || (cnt % 100) == 0) {
                 LOG_WARN("Opus oversized frame: got " << samples_per_channel
                          << ", expected " << expected_samples
-                         << " (20ms@" << sampleRate << "Hz) — dropping unexpected size");
+                         << " (" << frameDurationMs << "ms@" << sampleRate << "Hz) — dropping unexpected size");
             }
             return -1; // unexpected; do not encode mis-sized frame
         }
     }
 
+    if (fec)
+        updatePacketLoss();
+
+    auto t0 = std::chrono::steady_clock::now();
     opus_int32 bytesEncoded = opus_encode(
         encoder,
         reinterpret_cast<const opus_int16*>(data->virAddr),
         samples_per_channel,
         reinterpret_cast<unsigned char*>(outbuf),
-        1024);
+        MAX_PACKET_BYTES);
+    adaptComplexity(std::chrono::duration_cast<std::chrono::microseconds>(
+                        std::chrono::steady_clock::now() - t0).count(),
+                    samples_per_channel);
 
     if (bytesEncoded < 0)
     {
@@ -117,7 +156,70 @@ int Opus::encode(IMPAudioFrame *data, unsigned char *outbuf, int *outLen)
         return -1;
     }
 
+    // With DTX a packet of one or two bytes means "still silent". Nothing
+    // needs to go on the wire; the receiver sees the timestamp gap and
+    // conceals it.
+    if (dtx && bytesEncoded <= 2)
+    {
+        if ((++dtxFrames % 250) == 1)
+            RTSPStatus::writeCustomParameter("audio" + std::to_string(audioChn), "opus_dtx_frames",
+                                             std::to_string(dtxFrames));
+        *outLen = 0;
+        return 0;
+    }
+
     *outLen = bytesEncoded;
 
     return 0;
 }
+
+void Opus::updatePacketLoss()
+{
+    if (!fec)
+        return;
+
+    int loss = global_audio[audioChn] ? global_audio[audioChn]->rtcpLossPercent() : 0;
+    // libopus only distinguishes a handful of LBRR levels, ignore jitter
+    loss = std::min(loss, 30);
+    if (loss == lossPercent)
+        return;
+
+    if (opus_encoder_ctl(encoder, OPUS_SET_PACKET_LOSS_PERC(loss)) == OPUS_OK)
+    {
+        LOG_DEBUG("Opus expected packet loss " << lossPercent << "% -> " << loss << "%");
+        lossPercent = loss;
+        RTSPStatus::writeCustomParameter("audio" + std::to_string(audioChn), "opus_fec_loss_percent",
+                                         std::to_string(loss));
+    }
+}
+
+void Opus::adaptComplexity(int64_t encodeUs, int samplesPerChannel)
+{
+    // Exponential average over ~16 frames
+    encodeAvgUs = encodeAvgUs ? encodeAvgUs + (encodeUs - encodeAvgUs) / 16 : encodeUs;
+
+    // Re-evaluate about once per second of audio
+    if (++framesSinceAdjust < 50)
+        return;
+    framesSinceAdjust = 0;
+
+    int64_t budgetUs = (int64_t) samplesPerChannel * 1000000 / sampleRate;
+    int next = complexity;
+    if (encodeAvgUs > budgetUs / 2 && complexity > MIN_COMPLEXITY)
+    {
+        next = complexity - 1;
+    }
+    else if (encodeAvgUs < budgetUs / 4 && complexity < MAX_COMPLEXITY)
+    {
+        next = complexity + 1;
+    }
+
+    if (next != complexity && opus_encoder_ctl(encoder, OPUS_SET_COMPLEXITY(next)) == OPUS_OK)
+    {
+        LOG_INFO("Opus complexity " << complexity << " -> " << next << " (avg encode "
+                 << encodeAvgUs << "us, budget " << budgetUs << "us)");
+        complexity = next;
+        RTSPStatus::writeCustomParameter("audio" + std::to_string(audioChn), "opus_complexity",
+                                         std::to_string(complexity));
+    }
+}
@@ -7,9 +7,11 @@
 class Opus : public IMPAudioEncoder
 {
 public:
-    static Opus* createNew(int sampleRate, int numChn);
+    // 'audioChn' selects the global_audio entry the RTCP packet loss is read from
+    static Opus* createNew(int sampleRate, int numChn, int audioChn);
 
-    Opus(int sampleRate, int numChn) : sampleRate(sampleRate), numChn(numChn)
+    Opus(int sampleRate, int numChn, int audioChn)
+        : sampleRate(sampleRate), numChn(numChn), audioChn(audioChn)
     {
     };
 
@@ -19,10 +21,32 @@ public:
     int encode(IMPAudioFrame *data, unsigned char *outbuf, int *outLen) override;
     int close() override;
 
+    // Upper bound for one encoded packet, as recommended by libopus
+    static constexpr int MAX_PACKET_BYTES = 4000;
+
 private:
+    void adaptComplexity(int64_t encodeUs, int samplesPerChannel);
+    void updatePacketLoss();
+
     int sampleRate;
     int numChn;
+    int audioChn;
+    int frameDurationMs = 20;
+    bool dtx = false;
+    bool fec = false;
     OpusEncoder* encoder;
+
+    // Loss percentage currently applied to the encoder (FEC redundancy)
+    int lossPercent = -1;
+    uint32_t dtxFrames = 0;
+
+    // Encode-time driven complexity control
+    int complexity = MAX_COMPLEXITY;
+    int64_t encodeAvgUs = 0;
+    int framesSinceAdjust = 0;
+
+    static constexpr int MAX_COMPLEXITY = 10;
+    static constexpr int MIN_COMPLEXITY = 2;
 };
 
 #endif // OPUS_ENCODER_HPP
@@ -0,0 +1,46 @@
+#include "OpusSink.hpp"
+
+OpusSink* OpusSink::createNew(UsageEnvironment& env, Groupsock* RTPgs,
+                              u_int8_t rtpPayloadFormat, unsigned numChannels,
+                              unsigned packetDurationMs)
+{
+    return new OpusSink(env, RTPgs, rtpPayloadFormat, numChannels, packetDurationMs);
+}
+
+OpusSink::OpusSink(UsageEnvironment& env, Groupsock* RTPgs,
+                   u_int8_t rtpPayloadFormat, unsigned numChannels,
+                   unsigned packetDurationMs)
+    // RFC 7587: the RTP clock is always 48 kHz, one Opus packet per RTP packet
+    : SimpleRTPSink(env, RTPgs, rtpPayloadFormat, 48000, "audio", "OPUS",
+                    numChannels, False, True),
+      packetDurationUs((int64_t)packetDurationMs * 1000)
+{
+}
+
+OpusSink::~OpusSink()
+{
+}
+
+void OpusSink::doSpecialFrameHandling(unsigned fragmentationOffset,
+                                      unsigned char* frameStart,
+                                      unsigned numBytesInFrame,
+                                      struct timeval framePresentationTime,
+                                      unsigned numRemainingBytes)
+{
+    if (fragmentationOffset == 0)
+    {
+        if (havePresentationTime)
+        {
+            int64_t gapUs = (int64_t)(framePresentationTime.tv_sec - lastPresentationTime.tv_sec) * 1000000
+                            + (framePresentationTime.tv_usec - lastPresentationTime.tv_usec);
+            // Packets suppressed by DTX leave a hole in the timeline
+            if (gapUs > packetDurationUs * 3 / 2)
+                setMarkerBit();
+        }
+        lastPresentationTime = framePresentationTime;
+        havePresentationTime = true;
+    }
+
+    SimpleRTPSink::doSpecialFrameHandling(fragmentationOffset, frameStart, numBytesInFrame,
+                                          framePresentationTime, numRemainingBytes);
+}
@@ -0,0 +1,38 @@
+#ifndef OPUS_SINK_HPP
+#define OPUS_SINK_HPP
+
+#include <liveMedia.hh>
+#include <cstdint>
+
+/* RFC 7587 Opus sink.
+ *
+ * Identical to SimpleRTPSink, except that it marks the first packet after a
+ * DTX gap (a presentation time jump of more than one packet) with the RTP
+ * marker bit, so receivers can reset their jitter buffers at the start of a
+ * talkspurt instead of treating the gap as loss.
+ */
+class OpusSink : public SimpleRTPSink {
+public:
+    static OpusSink* createNew(UsageEnvironment& env, Groupsock* RTPgs,
+                               u_int8_t rtpPayloadFormat, unsigned numChannels,
+                               unsigned packetDurationMs);
+
+protected:
+    OpusSink(UsageEnvironment& env, Groupsock* RTPgs,
+             u_int8_t rtpPayloadFormat, unsigned numChannels,
+             unsigned packetDurationMs);
+    virtual ~OpusSink();
+
+    virtual void doSpecialFrameHandling(unsigned fragmentationOffset,
+                                        unsigned char* frameStart,
+                                        unsigned numBytesInFrame,
+                                        struct timeval framePresentationTime,
+                                        unsigned numRemainingBytes);
+
+private:
+    int64_t packetDurationUs;
+    struct timeval lastPresentationTime;
+    bool havePresentationTime = false;
+};
+
+#endif // OPUS_SINK_HPP
@@ -0,0 +1,56 @@
+#include "PcmConvert.hpp"
+
+#include <cstring>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#elif defined(__ARM_NEON)
+#include <arm_neon.h>
+#elif defined(__mips_msa)
+#include <msa.h>
+#endif
+
+namespace PcmConvert {
+
+static inline void monoToStereo16Scalar(const int16_t *in, int16_t *out, size_t samples)
+{
+    for (size_t i = 0; i < samples; i++)
+    {
+        // Both halves carry the same sample, so the result is endian independent
+        uint32_t pair = (uint16_t) in[i];
+        pair |= pair << 16;
+        std::memcpy(out + 2 * i, &pair, sizeof(pair));
+    }
+}
+
+void monoToStereo16(const int16_t *in, int16_t *out, size_t samples)
+{
+    size_t i = 0;
+
+#if defined(__SSE2__)
+    for (; i + 8 <= samples; i += 8)
+    {
+        __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i *>(in + i));
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(out + 2 * i), _mm_unpacklo_epi16(v, v));
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(out + 2 * i + 8), _mm_unpackhi_epi16(v, v));
+    }
+#elif defined(__ARM_NEON)
+    for (; i + 8 <= samples; i += 8)
+    {
+        int16x8_t v = vld1q_s16(in + i);
+        int16x8x2_t lr = {{v, v}};
+        vst2q_s16(out + 2 * i, lr);
+    }
+#elif defined(__mips_msa)
+    for (; i + 8 <= samples; i += 8)
+    {
+        v8i16 v = (v8i16) __msa_ld_h(const_cast<int16_t *>(in + i), 0);
+        __msa_st_h(__msa_ilvr_h(v, v), out + 2 * i, 0);
+        __msa_st_h(__msa_ilvl_h(v, v), out + 2 * i + 8, 0);
+    }
+#endif
+
+    monoToStereo16Scalar(in + i, out + 2 * i, samples - i);
+}
+
+} // namespace PcmConvert
@@ -0,0 +1,18 @@
+#ifndef PCM_CONVERT_HPP
+#define PCM_CONVERT_HPP
+
+#include <cstddef>
+#include <cstdint>
+
+namespace PcmConvert {
+
+/* Duplicate each 16-bit mono sample into an interleaved L/R pair.
+ * 'out' must hold 2 * samples elements and must not overlap 'in'.
+ * Uses SSE2/NEON/MSA when the target provides it, otherwise a scalar
+ * loop that writes both channels with a single 32-bit store.
+ */
+void monoToStereo16(const int16_t *in, int16_t *out, size_t samples);
+
+} // namespace PcmConvert
+
+#endif // PCM_CONVERT_HPP
@@ -0,0 +1,47 @@
+#include "PcmMixer.hpp"
+
+#include <algorithm>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#elif defined(__ARM_NEON)
+#include <arm_neon.h>
+#elif defined(__mips_msa)
+#include <msa.h>
+#endif
+
+namespace PcmMixer {
+
+void addSaturate16(int16_t *dst, const int16_t *src, size_t samples)
+{
+    size_t i = 0;
+
+#if defined(__SSE2__)
+    for (; i + 8 <= samples; i += 8)
+    {
+        __m128i a = _mm_loadu_si128(reinterpret_cast<const __m128i *>(dst + i));
+        __m128i b = _mm_loadu_si128(reinterpret_cast<const __m128i *>(src + i));
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(dst + i), _mm_adds_epi16(a, b));
+    }
+#elif defined(__ARM_NEON)
+    for (; i + 8 <= samples; i += 8)
+    {
+        vst1q_s16(dst + i, vqaddq_s16(vld1q_s16(dst + i), vld1q_s16(src + i)));
+    }
+#elif defined(__mips_msa)
+    for (; i + 8 <= samples; i += 8)
+    {
+        v8i16 a = (v8i16) __msa_ld_h(dst + i, 0);
+        v8i16 b = (v8i16) __msa_ld_h(const_cast<int16_t *>(src + i), 0);
+        __msa_st_h(__msa_adds_s_h(a, b), dst + i, 0);
+    }
+#endif
+
+    for (; i < samples; i++)
+    {
+        int32_t sum = (int32_t) dst[i] + src[i];
+        dst[i] = (int16_t) std::clamp<int32_t>(sum, INT16_MIN, INT16_MAX);
+    }
+}
+
+} // namespace PcmMixer
@@ -0,0 +1,17 @@
+#ifndef PCM_MIXER_HPP
+#define PCM_MIXER_HPP
+
+#include <cstddef>
+#include <cstdint>
+
+namespace PcmMixer {
+
+/* dst[i] = saturate16(dst[i] + src[i]) for 'samples' 16-bit samples.
+ * SSE2/NEON/MSA when available, scalar otherwise (MSA on T40/T41, see
+ * MSA_SOURCES in the Makefile).
+ */
+void addSaturate16(int16_t *dst, const int16_t *src, size_t samples);
+
+} // namespace PcmMixer
+
+#endif // PCM_MIXER_HPP
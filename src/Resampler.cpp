@@ -0,0 +1,143 @@
+#include "Resampler.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <numeric>
+
+namespace {
+
+// Zero crossings of the sinc on each side of the centre tap
+constexpr unsigned ZERO_CROSSINGS = 8;
+// Keep the pass band a little below Nyquist of the lower rate
+constexpr double CUTOFF_GUARD = 0.92;
+
+double sinc(double x)
+{
+    if (std::fabs(x) < 1e-9)
+        return 1.0;
+    return std::sin(M_PI * x) / (M_PI * x);
+}
+
+} // namespace
+
+bool Resampler::configure(int inputRate, int outputRate)
+{
+    if (inputRate <= 0 || outputRate <= 0)
+        return false;
+
+    if (inputRate == inRate && outputRate == outRate)
+    {
+        reset();
+        return true;
+    }
+
+    unsigned g = std::gcd((unsigned) inputRate, (unsigned) outputRate);
+    up = outputRate / g;
+    down = inputRate / g;
+    inRate = inputRate;
+    outRate = outputRate;
+
+    // Cutoff in cycles per upsampled sample, below both Nyquist frequencies
+    unsigned widest = std::max(up, down);
+    double fc = 0.5 * CUTOFF_GUARD / widest;
+    taps = (2 * ZERO_CROSSINGS * widest + up - 1) / up;
+    taps += taps & 1;
+
+    size_t length = (size_t) taps * up;
+    double centre = (length - 1) / 2.0;
+    std::vector<double> proto(length);
+    for (size_t n = 0; n < length; n++)
+    {
+        double w = 0.42 - 0.5 * std::cos(2.0 * M_PI * n / (length - 1))
+                   + 0.08 * std::cos(4.0 * M_PI * n / (length - 1));
+        // Gain of 'up' makes up for the zeros stuffed between input samples
+        proto[n] = up * 2.0 * fc * sinc(2.0 * fc * (n - centre)) * w;
+    }
+
+    // Split into phases. Phase p uses h[p + k*L] on x[base - k]; the taps are
+    // stored reversed so process() walks input and coefficients forward.
+    coeffs.assign((size_t) up * taps, 0);
+    double worstSum = 0.0;
+    for (unsigned p = 0; p < up; p++)
+    {
+        double sum = 0.0;
+        for (unsigned k = 0; k < taps; k++)
+        {
+            sum += std::fabs(proto[p + (size_t) k * up]);
+        }
+        worstSum = std::max(worstSum, sum);
+    }
+    // The int32 accumulator holds 32767 * sum|c|, keep that below 2^31
+    double scale = 32768.0 * std::min(1.0, 1.99 / worstSum);
+    for (unsigned p = 0; p < up; p++)
+    {
+        for (unsigned k = 0; k < taps; k++)
+        {
+            long q = std::lround(proto[p + (size_t) k * up] * scale);
+            coeffs[(size_t) p * taps + (taps - 1 - k)] = (int16_t) std::clamp(q, -32768L, 32767L);
+        }
+    }
+
+    reset();
+    return true;
+}
+
+void Resampler::reset()
+{
+    size_t history = taps ? taps - 1 : 0;
+    work.assign(history, 0);
+    nextIndex = history;
+    nextPhase = 0;
+    output.clear();
+}
+
+const std::vector<int16_t> &Resampler::process(const int16_t *input, size_t samples)
+{
+    output.clear();
+    if (taps == 0 || samples == 0)
+        return output;
+
+    const size_t history = taps - 1;
+    work.resize(history + samples);
+    std::memcpy(work.data() + history, input, samples * sizeof(int16_t));
+
+    const size_t available = work.size();
+    output.reserve(samples * up / down + 2);
+
+    // Integer and fractional input step per output sample, avoids a
+    // (64-bit, on MIPS32 a library call) division per sample
+    const size_t stepIndex = down / up;
+    const unsigned stepPhase = down % up;
+
+    while (nextIndex < available)
+    {
+        const int16_t *x = work.data() + nextIndex - history;
+        const int16_t *c = coeffs.data() + (size_t) nextPhase * taps;
+
+        // Two independent sums keep in-order pipelines busy; taps is even
+        int32_t acc0 = 1 << 14, acc1 = 0; // round to nearest
+        for (unsigned k = 0; k < taps; k += 2)
+        {
+            acc0 += (int32_t) x[k] * c[k];
+            acc1 += (int32_t) x[k + 1] * c[k + 1];
+        }
+        int32_t acc = (acc0 + acc1) >> 15;
+        output.push_back((int16_t) std::clamp<int32_t>(acc, INT16_MIN, INT16_MAX));
+
+        nextIndex += stepIndex;
+        nextPhase += stepPhase;
+        if (nextPhase >= up)
+        {
+            nextPhase -= up;
+            nextIndex++;
+        }
+    }
+
+    // Carry the last taps-1 inputs over to the next block
+    std::memmove(work.data(), work.data() + available - history, history * sizeof(int16_t));
+    work.resize(history);
+    nextIndex -= available - history;
+
+    return output;
+}
@@ -0,0 +1,50 @@
+#ifndef RESAMPLER_HPP
+#define RESAMPLER_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+/* Fixed-point polyphase resampler for 16-bit mono PCM.
+ *
+ * The ratio is reduced to L/M (upsample by L, decimate by M) and a
+ * Blackman-windowed sinc low-pass is split into L phases of Q15
+ * coefficients when the rates are set. Per sample the work is one
+ * int32 multiply-accumulate per tap, so it suits FPU-less SoCs.
+ *
+ * Filter history and the fractional output position are carried across
+ * process() calls, so a stream split into frames resamples exactly like the
+ * unsplit stream. The output buffer is owned by the resampler and reused.
+ */
+class Resampler
+{
+public:
+    Resampler() = default;
+
+    // Build the phase table, returns false for unsupported rates.
+    bool configure(int inputRate, int outputRate);
+    // Drop filter history, e.g. at the start of a new stream.
+    void reset();
+
+    int inputRate() const { return inRate; }
+    int outputRate() const { return outRate; }
+
+    // Resample one block; the returned buffer is valid until the next call.
+    const std::vector<int16_t> &process(const int16_t *input, size_t samples);
+
+private:
+    int inRate = 0;
+    int outRate = 0;
+    unsigned up = 1;     // L
+    unsigned down = 1;   // M
+    unsigned taps = 0;   // per phase
+
+    std::vector<int16_t> coeffs;   // [phase][tap], taps reversed for a forward walk
+    std::vector<int16_t> work;     // history + current block
+    std::vector<int16_t> output;
+    // Position of the next output: work index plus phase in 1/L samples
+    size_t nextIndex = 0;
+    unsigned nextPhase = 0;
+};
+
+#endif // RESAMPLER_HPP
@@ -1,75 +1,132 @@
+#ifndef RING_BUFFER_HPP
+#define RING_BUFFER_HPP
+
+#include <algorithm>
 #include <cstddef>
-#include <cstdint>
 #include <cstring>
-#include <stdexcept>
+#include <memory>
+#include <span>
+#include <type_traits>
+
+enum class RingStatus
+{
+    Ok,
+    Overflow,   // not enough free space, nothing was written
+    Underflow   // not enough stored elements, nothing was read
+};
 
+/* FIFO of trivially copyable elements.
+ *
+ * The capacity is rounded up to a power of two so the wrap is a mask instead
+ * of a modulo. Besides copy-in/copy-out it exposes the stored and free regions
+ * as (at most) two spans, so callers can read or fill the buffer in place and
+ * then consume()/commit() what they used. Nothing here throws; failures are
+ * reported through RingStatus and leave the buffer untouched.
+ *
+ * Not thread safe: head and tail are plain counters, so a buffer shared
+ * between threads needs external synchronisation around every call.
+ */
+template <typename T>
 class RingBuffer
 {
+    static_assert(std::is_trivially_copyable_v<T>, "RingBuffer requires trivially copyable elements");
+
 public:
-    RingBuffer(size_t capacity)
-        : buffer(new uint8_t[capacity]), capacity(capacity), head(0), tail(0), size(0)
-    {}
+    // A region of the buffer split at the physical wrap point
+    template <typename U>
+    struct Regions
+    {
+        std::span<U> first;
+        std::span<U> second;
+
+        size_t size() const { return first.size() + second.size(); }
+    };
+
+    explicit RingBuffer(size_t minCapacity)
+    {
+        size_t cap = 1;
+        while (cap < minCapacity)
+            cap <<= 1;
+
+        buffer.reset(new T[cap]);
+        capacity_ = cap;
+        mask = cap - 1;
+    }
+
+    RingStatus push(const T *data, size_t count)
+    {
+        if (count > space())
+            return RingStatus::Overflow;
+
+        Regions<T> dst = reserve(count);
+        std::memcpy(dst.first.data(), data, dst.first.size() * sizeof(T));
+        std::memcpy(dst.second.data(), data + dst.first.size(), dst.second.size() * sizeof(T));
+        commit(count);
+        return RingStatus::Ok;
+    }
+
+    RingStatus fetch(T *output, size_t count)
+    {
+        if (count > size())
+            return RingStatus::Underflow;
+
+        Regions<const T> src = peek(count);
+        std::memcpy(output, src.first.data(), src.first.size() * sizeof(T));
+        std::memcpy(output + src.first.size(), src.second.data(), src.second.size() * sizeof(T));
+        consume(count);
+        return RingStatus::Ok;
+    }
+
+    // Up to 'count' of the oldest stored elements, without removing them.
+    Regions<const T> peek(size_t count) const
+    {
+        count = std::min(count, size());
+        size_t pos = head & mask;
+        size_t first = std::min(count, capacity_ - pos);
+        return {{buffer.get() + pos, first}, {buffer.get(), count - first}};
+    }
 
-    ~RingBuffer()
+    // Remove elements previously obtained through peek().
+    RingStatus consume(size_t count)
     {
-        delete[] buffer;
+        if (count > size())
+            return RingStatus::Underflow;
+        head += count;
+        return RingStatus::Ok;
     }
 
-    void push(const uint8_t* data, size_t dataSize)
+    // Up to 'count' free slots to be filled in place and published with commit().
+    Regions<T> reserve(size_t count)
     {
-        if (dataSize > capacity - size)
-        {
-            throw std::overflow_error("Ring buffer overflow");
-        }
-
-        size_t spaceAtEnd = capacity - tail;
-        if (dataSize <= spaceAtEnd)
-        {
-            // If we can fit the data without wrapping
-            std::memcpy(buffer + tail, data, dataSize);
-        }
-        else
-        {
-            // If the data wraps around the buffer
-            std::memcpy(buffer + tail, data, spaceAtEnd);
-            std::memcpy(buffer, data + spaceAtEnd, dataSize - spaceAtEnd);
-        }
-
-        tail = (tail + dataSize) % capacity;
-        size += dataSize;
+        count = std::min(count, space());
+        size_t pos = tail & mask;
+        size_t first = std::min(count, capacity_ - pos);
+        return {{buffer.get() + pos, first}, {buffer.get(), count - first}};
     }
 
-    void fetch(uint8_t* output, size_t count)
+    RingStatus commit(size_t count)
     {
-        if (count > size)
-        {
-            throw std::underflow_error("Ring buffer underflow");
-        }
-
-        size_t spaceAtEnd = capacity - head;
-        if (count <= spaceAtEnd)
-        {
-            // If the data can be copied without wrapping
-            std::memcpy(output, buffer + head, count);
-        }
-        else
-        {
-            // If the data wraps around the buffer
-            std::memcpy(output, buffer + head, spaceAtEnd);
-            std::memcpy(output + spaceAtEnd, buffer, count - spaceAtEnd);
-        }
-
-        head = (head + count) % capacity;
-        size -= count;
+        if (count > space())
+            return RingStatus::Overflow;
+        tail += count;
+        return RingStatus::Ok;
     }
 
-    bool isEmpty() const { return size == 0; }
-    size_t getSize() const { return size; }
+    void clear() { head = tail = 0; }
+
+    bool isEmpty() const { return head == tail; }
+    size_t getSize() const { return size(); }
+    size_t size() const { return tail - head; }
+    size_t space() const { return capacity_ - size(); }
+    size_t capacity() const { return capacity_; }
 
 private:
-    uint8_t* buffer;
-    size_t capacity;
-    size_t head;
-    size_t tail;
-    size_t size;
+    std::unique_ptr<T[]> buffer;
+    size_t capacity_ = 0;
+    size_t mask = 0;
+    // Free-running counters, only masked on access
+    size_t head = 0;
+    size_t tail = 0;
 };
+
+#endif // RING_BUFFER_HPP
@@ -0,0 +1,83 @@
+#ifndef SAMPLE_RING_HPP
+#define SAMPLE_RING_HPP
+
+#include <algorithm>
+#include <cstddef>
+#include <cstring>
+#include <memory>
+
+/* Fixed-capacity sample FIFO with a mirrored backing store.
+ *
+ * The capacity is rounded up to a power of two and every element is written
+ * twice, at (pos) and (pos + capacity). Any window of up to capacity elements
+ * that starts at the read position is therefore contiguous in memory and can
+ * be handed to an encoder directly, without shifting the remaining samples.
+ */
+template <typename T>
+class SampleRing
+{
+public:
+    SampleRing() = default;
+    explicit SampleRing(size_t minCapacity) { reset(minCapacity); }
+
+    void reset(size_t minCapacity)
+    {
+        size_t cap = 1;
+        while (cap < minCapacity)
+            cap <<= 1;
+
+        if (cap != capacity_ || !buffer)
+        {
+            buffer.reset(new T[cap * 2]);
+            capacity_ = cap;
+            mask = cap - 1;
+        }
+        clear();
+    }
+
+    void clear() { head = tail = 0; }
+
+    size_t capacity() const { return capacity_; }
+    size_t size() const { return tail - head; }
+    size_t space() const { return capacity_ - size(); }
+    bool empty() const { return head == tail; }
+
+    // Append up to space() elements, returns the number actually stored.
+    size_t push(const T *data, size_t count)
+    {
+        count = std::min(count, space());
+        size_t pos = tail & mask;
+        size_t first = std::min(count, capacity_ - pos);
+
+        std::memcpy(buffer.get() + pos, data, first * sizeof(T));
+        std::memcpy(buffer.get() + pos + capacity_, data, first * sizeof(T));
+        if (count > first)
+        {
+            std::memcpy(buffer.get(), data + first, (count - first) * sizeof(T));
+            std::memcpy(buffer.get() + capacity_, data + first, (count - first) * sizeof(T));
+        }
+
+        tail += count;
+        return count;
+    }
+
+    // Contiguous view of the oldest size() elements.
+    const T *peek() const { return buffer.get() + (head & mask); }
+
+    // Release up to size() elements from the front, returns the number released.
+    size_t consume(size_t count)
+    {
+        count = std::min(count, size());
+        head += count;
+        return count;
+    }
+
+private:
+    std::unique_ptr<T[]> buffer;
+    size_t capacity_ = 0;
+    size_t mask = 0;
+    size_t head = 0;
+    size_t tail = 0;
+};
+
+#endif // SAMPLE_RING_HPP
@@ -0,0 +1,65 @@
+#ifndef SPSC_QUEUE_HPP
+#define SPSC_QUEUE_HPP
+
+#include <atomic>
+#include <cstddef>
+#include <memory>
+
+/* Bounded lock-free single-producer/single-consumer queue of preallocated slots.
+ *
+ * The producer fills the slot returned by acquire() in place and makes it
+ * visible with publish(); the consumer reads front() and hands the slot back
+ * with pop(). Slots are reused, so element types owning buffers (vectors)
+ * keep their storage between frames and the steady state does not allocate.
+ */
+template <typename T>
+class SpscQueue
+{
+public:
+    explicit SpscQueue(size_t minSlots)
+    {
+        size_t n = 2;
+        while (n < minSlots)
+            n <<= 1;
+        slots.reset(new T[n]);
+        size_ = n;
+        mask = n - 1;
+    }
+
+    // Producer side: next free slot, or nullptr if the queue is full.
+    T *acquire()
+    {
+        size_t t = tail.load(std::memory_order_relaxed);
+        if (t - head.load(std::memory_order_acquire) >= size_)
+            return nullptr;
+        return &slots[t & mask];
+    }
+
+    void publish() { tail.store(tail.load(std::memory_order_relaxed) + 1, std::memory_order_release); }
+
+    // Consumer side: oldest published slot, or nullptr if the queue is empty.
+    T *front()
+    {
+        size_t h = head.load(std::memory_order_relaxed);
+        if (h == tail.load(std::memory_order_acquire))
+            return nullptr;
+        return &slots[h & mask];
+    }
+
+    void pop() { head.store(head.load(std::memory_order_relaxed) + 1, std::memory_order_release); }
+
+    size_t depth() const { return tail.load(std::memory_order_acquire) - head.load(std::memory_order_acquire); }
+    size_t slotCount() const { return size_; }
+
+    // Direct slot access for preallocation before the queue is in use.
+    T &slot(size_t i) { return slots[i & mask]; }
+
+private:
+    std::unique_ptr<T[]> slots;
+    size_t size_ = 0;
+    size_t mask = 0;
+    alignas(64) std::atomic<size_t> head{0};
+    alignas(64) std::atomic<size_t> tail{0};
+};
+
+#endif // SPSC_QUEUE_HPP
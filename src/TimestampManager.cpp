@@ -2,6 +2,7 @@
 #include "Logger.hpp"
 #include "IMPSystem.hpp"
 #include <time.h>
+#include <atomic>
 #include <map>
 #include <cstdlib>
 #include <chrono>
@@ -82,4 +83,24 @@ void TimestampManager::getTimestamp(struct timeval* tv) {
     }
 }
 
+int64_t TimestampManager::captureTimestampUs(int64_t hardwareUs) {
+    int64_t now = IMP_System_GetTimeStamp();
 
+    // A capture timestamp lies in the recent past; anything else comes from
+    // a frame captured before the timebase was set
+    if (hardwareUs > 0 && hardwareUs <= now + 100000 && now - hardwareUs < 5000000) {
+        return hardwareUs;
+    }
+
+    // Called from the audio and video threads
+    static std::atomic<int> fallback_count{0};
+    if (fallback_count++ < 10) {
+        LOG_WARN("Implausible capture timestamp " << hardwareUs << " (now " << now << "), using current time");
+    }
+    return now;
+}
+
+void TimestampManager::toTimeval(int64_t timestampUs, struct timeval* tv) {
+    tv->tv_sec = timestampUs / 1000000;
+    tv->tv_usec = timestampUs % 1000000;
+}
@@ -53,6 +53,22 @@ public:
      */
     void getTimestamp(struct timeval* tv);
 
+    /**
+     * Validate a hardware capture timestamp (IMPAudioFrame::timeStamp,
+     * IMPEncoderPack::timestamp). These share the IMP_System_GetTimeStamp()
+     * timebase, so they can be used as PTS directly.
+     *
+     * @param hardwareUs Timestamp reported by the SDK in microseconds
+     * @return hardwareUs, or the current time if it is zero or implausibly
+     *         far from now (e.g. before a timebase rebase)
+     */
+    int64_t captureTimestampUs(int64_t hardwareUs);
+
+    /**
+     * Convert a microsecond timestamp to a timeval.
+     */
+    static void toTimeval(int64_t timestampUs, struct timeval* tv);
+
     /**
      * Check if the timestamp manager has been initialized
      *
@@ -4,6 +4,8 @@
 #include "IMPEncoder.hpp"
 #include "IMPFramesource.hpp"
 #include "Logger.hpp"
+#include "Motion.hpp"
+#include "RTSPStatus.hpp"
 #include "WorkerUtils.hpp"
 #include "TimestampManager.hpp"
 #include "globals.hpp"
@@ -31,9 +33,34 @@ void VideoWorker::run()
     uint32_t error_count = 0; // Keep track of polling errors
     unsigned long long ms = 0;
     bool run_for_jpeg = false;
+    bool idle = false; // the encoder starts with the configured profile
+
+    // encoder ROIs following the areas with motion
+    bool motion_roi = strcmp(global_video[encChn]->stream->roi_qp_mode, "motion") == 0;
+    uint32_t area_seq = 0;
+    std::vector<PixelRect> areas;
+    int area_width = 0;
+    int area_height = 0;
 
     while (global_video[encChn]->running)
     {
+        /* live switch between the active and idle encoder profile, done here
+         * as this thread owns the encoder channel
+         */
+        bool want_idle = global_video[encChn]->idle && global_video[encChn]->stream->idle_enabled;
+        if (want_idle != idle)
+        {
+            idle = want_idle;
+            global_video[encChn]->imp_encoder->setIdle(idle);
+            RTSPStatus::writeCustomParameter(global_video[encChn]->name, "encoder_profile",
+                                             idle ? "idle" : "active");
+        }
+
+        if (motion_roi && Motion::activeAreas(area_seq, areas, area_width, area_height))
+        {
+            global_video[encChn]->imp_encoder->setROIAreas(areas, area_width, area_height);
+        }
+
         /* bool helper to check if this is the active jpeg channel and a jpeg is requested while
          * the channel is inactive
          */
@@ -56,12 +83,13 @@ void VideoWorker::run()
                 }
 
 
-                // SINGLE SOURCE OF TRUTH: Use TimestampManager (which uses IMP hardware timestamps)
+                // PTS is the encoder's capture timestamp, on the same timebase
+                // as the audio frames, so polling latency does not skew A/V
+                int64_t pack_timestamp = (stream.packCount > 0) ? stream.pack[0].timestamp : 0;
                 struct timeval monotonic_time;
-                TimestampManager::getInstance().getTimestamp(&monotonic_time);
+                TimestampManager::toTimeval(TimestampManager::getInstance().captureTimestampUs(pack_timestamp),
+                                            &monotonic_time);
 
-                // TIMESTAMP DEBUG: Log video frame processing (use first pack timestamp)
-                int64_t pack_timestamp = (stream.packCount > 0) ? stream.pack[0].timestamp : -1;
                 LOG_DEBUG("VIDEO_TIMESTAMP_1_PROCESS: pack_timestamp=" << pack_timestamp << " monotonic_time.tv_sec=" << monotonic_time.tv_sec << " monotonic_time.tv_usec=" << monotonic_time.tv_usec);
 
                 for (uint32_t i = 0; i < stream.packCount; ++i)
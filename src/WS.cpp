@@ -1,6 +1,7 @@
 #include "WS.hpp"
 #include <random>
 #include <set>
+#include <mutex>
 #include <fstream>
 #include <memory>
 #include <variant>
@@ -10,12 +11,15 @@
 #include <imp/imp_isp.h>
 #include <imp/imp_audio.h>
 #include "OSD.hpp"
+#include "EventBus.hpp"
+#include "Motion.hpp"
 #include "globals.hpp"
 #include <filesystem>
 #include <sys/inotify.h>
 
 #include <iomanip>
 #include <cerrno>
+#include <cmath>
 #include <cstring>
 #include <sys/socket.h>
 #include <unistd.h>
@@ -79,7 +83,10 @@ enum
     PNT_FLAG_HTTP_SEND_MESSAGE = 4096,
     PNT_FLAG_HTTP_RECEIVED_MESSAGE = 8192,
     PNT_FLAG_HTTP_SEND_PREVIEW = 16384,
-    PNT_FLAG_HTTP_SEND_INVALID = 32768
+    PNT_FLAG_HTTP_SEND_INVALID = 32768,
+
+    PNT_FLAG_WS_EVENTS = 65536,
+    PNT_FLAG_WS_SEND_HEATMAP = 131072
 };
 
 /* ROOT */
@@ -232,7 +239,18 @@ enum
     PNT_AUDIO_INPUT_FORMAT,
     PNT_AUDIO_INPUT_SAMPLE_RATE,
     PNT_AUDIO_OUTPUT_ENABLED,
-    PNT_AUDIO_OUTPUT_SAMPLE_RATE
+    PNT_AUDIO_OUTPUT_SAMPLE_RATE,
+    PNT_AUDIO_OPUS_DTX,
+    PNT_AUDIO_OPUS_FEC,
+    PNT_AUDIO_OPUS_FRAME_DURATION,
+    PNT_AUDIO_LEVEL_RMS_DBFS,
+    PNT_AUDIO_LEVEL_PEAK_DBFS,
+    PNT_AUDIO_VAD_ACTIVE,
+    PNT_AUDIO_OUTPUT_DIRECT,
+    PNT_AUDIO_OUTPUT_VOL,
+    PNT_AUDIO_OUTPUT_GAIN,
+    PNT_AUDIO_OUTPUT_JITTER_DELAY,
+    PNT_AUDIO_OUTPUT_JITTER_MAX_DELAY
 };
 
 static const char *const audio_keys[] = {
@@ -249,7 +267,18 @@ static const char *const audio_keys[] = {
     "input_format",
     "input_sample_rate",
     "output_enabled",
-    "output_sample_rate"};
+    "output_sample_rate",
+    "opus_dtx",
+    "opus_fec",
+    "opus_frame_duration",
+    "level_rms_dbfs",
+    "level_peak_dbfs",
+    "vad_active",
+    "output_direct",
+    "output_vol",
+    "output_gain",
+    "output_jitter_delay",
+    "output_jitter_max_delay"};
 #endif
 
 /* STREAM */
@@ -258,6 +287,7 @@ enum
     PNT_STREAM_ENABLED = 1,
     PNT_STREAM_AUDIO_ENABLED,
     PNT_STREAM_SCALE_ENABLED,
+    PNT_STREAM_IDLE_ENABLED,
     PNT_STREAM_RTSP_ENDPOINT,
     PNT_STREAM_RTSP_INFO,
     PNT_STREAM_FORMAT,
@@ -273,6 +303,12 @@ enum
     PNT_STREAM_SCALE_WIDTH,
     PNT_STREAM_SCALE_HEIGHT,
     PNT_STREAM_PROFILE,
+    PNT_STREAM_IDLE_FPS,
+    PNT_STREAM_IDLE_BITRATE,
+    PNT_STREAM_IDLE_GOP,
+    PNT_STREAM_ROI_QP_ACTIVE,
+    PNT_STREAM_ROI_QP_BACKGROUND,
+    PNT_STREAM_ROI_QP_MODE,
     PNT_STREAM_STATS,
     PNT_STREAM_OSD
 };
@@ -281,6 +317,7 @@ static const char *const stream_keys[] = {
     "enabled",
     "audio_enabled",
     "scale_enabled",
+    "idle_enabled",
     "rtsp_endpoint",
     "rtsp_info",
     "format",
@@ -296,6 +333,12 @@ static const char *const stream_keys[] = {
     "scale_width",
     "scale_height",
     "profile",
+    "idle_fps",
+    "idle_bitrate",
+    "idle_gop",
+    "roi_qp_active",
+    "roi_qp_background",
+    "roi_qp_mode",
     "stats",
     "osd"};
 
@@ -341,6 +384,12 @@ enum
     PNT_OSD_POS_UPTIME_X,
     PNT_OSD_POS_UPTIME_Y,
     PNT_OSD_UPTIME_ROTATION,
+    PNT_OSD_POS_MOTION_X,
+    PNT_OSD_POS_MOTION_Y,
+    PNT_OSD_POS_BITRATE_GRAPH_X,
+    PNT_OSD_POS_BITRATE_GRAPH_Y,
+    PNT_OSD_POS_AUDIO_METER_X,
+    PNT_OSD_POS_AUDIO_METER_Y,
 
     PNT_OSD_POS_LOGO_X,
     PNT_OSD_POS_LOGO_Y,
@@ -351,6 +400,10 @@ enum
     PNT_OSD_USER_TEXT_ENABLED,
     PNT_OSD_UPTIME_ENABLED,
     PNT_OSD_LOGO_ENABLED,
+    PNT_OSD_MOTION_ENABLED,
+    PNT_OSD_BITRATE_GRAPH_ENABLED,
+    PNT_OSD_AUDIO_METER_ENABLED,
+    PNT_OSD_LOGO_AUTOSCALE,
 
     PNT_OSD_FONT_PATH,
     PNT_OSD_TIME_FORMAT,
@@ -380,6 +433,12 @@ static const char *const osd_keys[] = {
     "pos_uptime_x",
     "pos_uptime_y",
     "uptime_rotation",
+    "pos_motion_x",
+    "pos_motion_y",
+    "pos_bitrate_graph_x",
+    "pos_bitrate_graph_y",
+    "pos_audio_meter_x",
+    "pos_audio_meter_y",
 
     "pos_logo_x",
     "pos_logo_y",
@@ -390,6 +449,10 @@ static const char *const osd_keys[] = {
     "user_text_enabled",
     "uptime_enabled",
     "logo_enabled",
+    "motion_enabled",
+    "bitrate_graph_enabled",
+    "audio_meter_enabled",
+    "logo_autoscale",
     "font_path",
     "time_format",
     "uptime_format",
@@ -417,9 +480,17 @@ enum
     PNT_MOTION_ROI_1_X,
     PNT_MOTION_ROI_1_Y,
     PNT_MOTION_ROI_COUNT,
+    PNT_MOTION_BLOCK_SIZE,
+    PNT_MOTION_BLOCK_THRESHOLD,
+    PNT_MOTION_BLOCK_MIN_COUNT,
+    PNT_MOTION_SCRIPT_MIN_INTERVAL,
+    PNT_MOTION_HEATMAP_HALF_LIFE,
     PNT_MOTION_ENABLED,
     PNT_MOTION_SCRIPT_PATH,
+    PNT_MOTION_DETECTOR,
     PNT_MOTION_ROIS,
+    PNT_MOTION_ROI_HITS,
+    PNT_MOTION_HEATMAP,
 };
 
 static const char *const motion_keys[] = {
@@ -438,9 +509,17 @@ static const char *const motion_keys[] = {
     "roi_1_x",
     "roi_1_y",
     "roi_count",
+    "block_size",
+    "block_threshold",
+    "block_min_count",
+    "script_min_interval",
+    "heatmap_half_life",
     "enabled",
     "script_path",
-    "rois"};
+    "detector",
+    "rois",
+    "roi_hits",
+    "heatmap"};
 
 /* INFO */
 enum
@@ -456,7 +535,9 @@ enum
 {
     PNT_RESTART_THREAD = 1,
     PNT_SAVE_CONFIG,
-    PNT_CAPTURE
+    PNT_CAPTURE,
+    PNT_EVENTS,
+    PNT_HEATMAP_IMAGE
 };
 
 enum
@@ -469,12 +550,23 @@ enum
 static const char *const action_keys[] = {
     "restart_thread",
     "save_config",
-    "capture"};
+    "capture",
+    "events",
+    "heatmap_image"};
 
 #pragma endregion keys_and_enums
 
 char token[WEBSOCKET_TOKEN_LENGTH + 1]{0};
 
+/* Motion/sound events for websocket sessions subscribed with
+ * {"action":{"events":true}}. The event bus thread queues them and wakes the
+ * lws service loop, which hands them to the sessions.
+ */
+static struct lws_context *ws_context = nullptr;
+static std::mutex ws_events_mutex;
+static std::vector<std::string> ws_events_pending;
+static std::set<struct lws *> ws_event_sessions; // lws service thread only
+
 struct snapshot_info
 {
     int r;             // current requests
@@ -1142,7 +1234,11 @@ signed char WS::audio_callback(struct lejp_ctx *ctx, char reason)
         else if (ctx->path_match == PNT_AUDIO_INPUT_NOISE_SUPPRESSION ||
                  ctx->path_match == PNT_AUDIO_INPUT_SAMPLE_RATE ||
                  ctx->path_match == PNT_AUDIO_INPUT_BITRATE ||
-                 ctx->path_match == PNT_AUDIO_OUTPUT_SAMPLE_RATE )
+                 ctx->path_match == PNT_AUDIO_OUTPUT_SAMPLE_RATE ||
+                 ctx->path_match == PNT_AUDIO_OUTPUT_VOL ||
+                 ctx->path_match == PNT_AUDIO_OUTPUT_GAIN ||
+                 ctx->path_match == PNT_AUDIO_OUTPUT_JITTER_DELAY ||
+                 ctx->path_match == PNT_AUDIO_OUTPUT_JITTER_MAX_DELAY )
         {
             if (reason == LEJPCB_VAL_NUM_INT)
             {
@@ -1197,6 +1293,9 @@ signed char WS::audio_callback(struct lejp_ctx *ctx, char reason)
             switch (ctx->path_match)
             {
             case PNT_AUDIO_OUTPUT_ENABLED:
+            case PNT_AUDIO_OPUS_DTX:
+            case PNT_AUDIO_OPUS_FEC:
+            case PNT_AUDIO_OUTPUT_DIRECT:
                 if (reason == LEJPCB_VAL_TRUE)
                 {
                     if (cfg->set<bool>(u_ctx->path, true))
@@ -1266,6 +1365,28 @@ signed char WS::audio_callback(struct lejp_ctx *ctx, char reason)
             add_json_str(u_ctx->message, pnt_ws_msg[PNT_WS_MSG_UNSUPPORTED]);
 #endif
                 break;
+            case PNT_AUDIO_OPUS_FRAME_DURATION:
+                // Packet duration is advertised in the SDP as well
+                if (reason == LEJPCB_VAL_NUM_INT)
+                {
+                    if (cfg->set<int>(u_ctx->path, atoi(ctx->buf)))
+                    {
+                        global_restart_audio = true;
+                        global_restart_rtsp = true;
+                    }
+                }
+                add_json_num(u_ctx->message, cfg->get<int>(u_ctx->path));
+                break;
+            // read-only capture levels, rounded to whole dB
+            case PNT_AUDIO_LEVEL_RMS_DBFS:
+                add_json_num(u_ctx->message, (int) std::lround(global_audio[u_ctx->value]->levelRmsDbfs.load()));
+                break;
+            case PNT_AUDIO_LEVEL_PEAK_DBFS:
+                add_json_num(u_ctx->message, (int) std::lround(global_audio[u_ctx->value]->levelPeakDbfs.load()));
+                break;
+            case PNT_AUDIO_VAD_ACTIVE:
+                add_json_bool(u_ctx->message, global_audio[u_ctx->value]->voiceActive.load());
+                break;
             case PNT_AUDIO_INPUT_FORMAT:
                 if (reason == LEJPCB_VAL_STR_END)
                     cfg->set<const char *>(u_ctx->path, strdup(ctx->buf));
@@ -1299,13 +1420,13 @@ signed char WS::stream_callback(struct lejp_ctx *ctx, char reason)
 
         u_ctx->flag |= PNT_FLAG_SEPARATOR;
 
-        if (ctx->path_match >= PNT_STREAM_GOP && ctx->path_match <= PNT_STREAM_PROFILE)
+        if (ctx->path_match >= PNT_STREAM_GOP && ctx->path_match <= PNT_STREAM_ROI_QP_BACKGROUND)
         { // integer values
             if (reason == LEJPCB_VAL_NUM_INT)
                 cfg->set<int>(u_ctx->path, atoi(ctx->buf));
             add_json_num(u_ctx->message, cfg->get<int>(u_ctx->path));
         }
-        else if(ctx->path_match >= PNT_STREAM_ENABLED && ctx->path_match <= PNT_STREAM_SCALE_ENABLED)
+        else if(ctx->path_match >= PNT_STREAM_ENABLED && ctx->path_match <= PNT_STREAM_IDLE_ENABLED)
         { // bool values
             if (reason == LEJPCB_VAL_TRUE)
             {
@@ -1352,6 +1473,11 @@ signed char WS::stream_callback(struct lejp_ctx *ctx, char reason)
                     cfg->set<const char *>(u_ctx->path, strdup(ctx->buf));
                 add_json_str(u_ctx->message, cfg->get<const char *>(u_ctx->path));
                 break;
+            case PNT_STREAM_ROI_QP_MODE:
+                if (reason == LEJPCB_VAL_STR_END)
+                    cfg->set<const char *>(u_ctx->path, strdup(ctx->buf));
+                add_json_str(u_ctx->message, cfg->get<const char *>(u_ctx->path));
+                break;
             case PNT_STREAM_STATS:
                 if (reason == LEJPCB_VAL_NULL)
                 {
@@ -1553,7 +1679,7 @@ signed char WS::osd_callback(struct lejp_ctx *ctx, char reason)
             add_json_num(u_ctx->message, cfg->get<int>(u_ctx->path));
         }
         // integer
-        else if (ctx->path_match >= PNT_OSD_FONT_SIZE && ctx->path_match <= PNT_OSD_UPTIME_ROTATION)
+        else if (ctx->path_match >= PNT_OSD_FONT_SIZE && ctx->path_match <= PNT_OSD_POS_AUDIO_METER_Y)
         {
             if (reason == LEJPCB_VAL_NUM_INT)
             {
@@ -1562,7 +1688,7 @@ signed char WS::osd_callback(struct lejp_ctx *ctx, char reason)
             add_json_num(u_ctx->message, cfg->get<int>(u_ctx->path));
         }
         // bool
-        else if (ctx->path_match >= PNT_OSD_ENABLED && ctx->path_match <= PNT_OSD_LOGO_ENABLED)
+        else if (ctx->path_match >= PNT_OSD_ENABLED && ctx->path_match <= PNT_OSD_LOGO_AUTOSCALE)
         {
             if (reason == LEJPCB_VAL_TRUE)
             {
@@ -1680,7 +1806,7 @@ signed char WS::motion_callback(struct lejp_ctx *ctx, char reason)
         u_ctx->flag |= PNT_FLAG_SEPARATOR;
 
         // integer
-        if (ctx->path_match >= PNT_MOTION_DEBOUNCE_TIME && ctx->path_match <= PNT_MOTION_ROI_COUNT)
+        if (ctx->path_match >= PNT_MOTION_DEBOUNCE_TIME && ctx->path_match <= PNT_MOTION_HEATMAP_HALF_LIFE)
         {
             if (reason == LEJPCB_VAL_NUM_INT)
             {
@@ -1702,7 +1828,7 @@ signed char WS::motion_callback(struct lejp_ctx *ctx, char reason)
             add_json_bool(u_ctx->message, cfg->get<bool>(u_ctx->path));
             // std::string
         }
-        else if (ctx->path_match == PNT_MOTION_SCRIPT_PATH)
+        else if (ctx->path_match == PNT_MOTION_SCRIPT_PATH || ctx->path_match == PNT_MOTION_DETECTOR)
         {
             if (reason == LEJPCB_VAL_STR_END)
             {
@@ -1722,6 +1848,21 @@ signed char WS::motion_callback(struct lejp_ctx *ctx, char reason)
             }
             add_json_str(u_ctx->message, cfg->get<std::string>(u_ctx->path).c_str());
         }
+        else if (ctx->path_match == PNT_MOTION_ROI_HITS)
+        {
+            // read only, frames with motion per region
+            u_ctx->message.append("[");
+            for (int i = 0; i < cfg->motion.roi_count && i < IMP_IVS_MOVE_MAX_ROI_CNT; i++)
+            {
+                append_session_msg(u_ctx->message, i ? ",%u" : "%u", Motion::regionHits[i].load());
+            }
+            u_ctx->message.append("]");
+        }
+        else if (ctx->path_match == PNT_MOTION_HEATMAP)
+        {
+            // read only, decaying motion activity per grid cell and region
+            u_ctx->message.append(Motion::heatmap.toJson(cfg->motion.roi_count));
+        }
         else
         {
             u_ctx->flag &= ~PNT_FLAG_SEPARATOR;
@@ -1761,8 +1902,11 @@ signed char WS::motion_roi_callback(struct lejp_ctx *ctx, char reason)
                 u_ctx->message.append(",");
 
             append_session_msg(
-                u_ctx->message, "[%d,%d,%d,%d]", cfg->motion.rois[i].p0_x, cfg->motion.rois[i].p0_y,
+                u_ctx->message, "[%d,%d,%d,%d", cfg->motion.rois[i].p0_x, cfg->motion.rois[i].p0_y,
                 cfg->motion.rois[i].p1_x, cfg->motion.rois[i].p1_y);
+            if (cfg->motion.rois[i].sensitivity >= 0)
+                append_session_msg(u_ctx->message, ",%d", cfg->motion.rois[i].sensitivity);
+            u_ctx->message.append("]");
             u_ctx->flag |= PNT_FLAG_SEPARATOR;
         }
         u_ctx->flag |= PNT_FLAG_SEPARATOR;
@@ -1784,6 +1928,7 @@ signed char WS::motion_roi_callback(struct lejp_ctx *ctx, char reason)
             {
                 u_ctx->flag |= PNT_FLAG_ROI_ENTRY; // entry array
                 u_ctx->vidx = 0;                   // entry array index
+                u_ctx->region.sensitivity = -1;
                 u_ctx->message.append("[");
             }
             // roi array is not open ! open it
@@ -1816,6 +1961,12 @@ signed char WS::motion_roi_callback(struct lejp_ctx *ctx, char reason)
                 {
                     u_ctx->region.p1_y = atoi(ctx->buf);
                 }
+                else if (u_ctx->vidx == 5)
+                {
+                    // optional per region sensitivity, 0-4
+                    int sense = atoi(ctx->buf);
+                    u_ctx->region.sensitivity = (sense >= 0 && sense <= 4) ? sense : -1;
+                }
             }
             break;
 
@@ -1830,6 +1981,8 @@ signed char WS::motion_roi_callback(struct lejp_ctx *ctx, char reason)
                 {
                     append_session_msg(
                         u_ctx->message, "%d,%d,%d,%d", u_ctx->region.p0_x, u_ctx->region.p0_y, u_ctx->region.p1_x, u_ctx->region.p1_y);
+                    if (u_ctx->region.sensitivity >= 0)
+                        append_session_msg(u_ctx->message, ",%d", u_ctx->region.sensitivity);
                 }
                 u_ctx->message.append("]");
 
@@ -1837,10 +1990,11 @@ signed char WS::motion_roi_callback(struct lejp_ctx *ctx, char reason)
                 u_ctx->flag |= PNT_FLAG_SEPARATOR;
 
                 // read up to 52 roi entries into u_ctx->region
-                if (u_ctx->midx <= 52)
+                if (u_ctx->midx < 52)
                 {
                     cfg->motion.rois[u_ctx->midx] =
-                        {u_ctx->region.p0_x, u_ctx->region.p0_y, u_ctx->region.p1_x, u_ctx->region.p1_y};
+                        {u_ctx->region.p0_x, u_ctx->region.p0_y, u_ctx->region.p1_x, u_ctx->region.p1_y,
+                         u_ctx->region.sensitivity};
                     u_ctx->midx++;
                 }
             }
@@ -1957,6 +2111,25 @@ signed char WS::action_callback(struct lejp_ctx *ctx, char reason)
             u_ctx->flag |= PNT_FLAG_WS_REQUEST_PREVIEW;
             add_json_str(u_ctx->message, pnt_ws_msg[PNT_WS_MSG_INITIATED]);
             break;
+        case PNT_EVENTS:
+            if (reason == LEJPCB_VAL_TRUE)
+            {
+                u_ctx->flag |= PNT_FLAG_WS_EVENTS;
+                ws_event_sessions.insert(u_ctx->wsi);
+            }
+            else if (reason == LEJPCB_VAL_FALSE)
+            {
+                u_ctx->flag &= ~PNT_FLAG_WS_EVENTS;
+                ws_event_sessions.erase(u_ctx->wsi);
+            }
+            add_json_bool(u_ctx->message, u_ctx->flag & PNT_FLAG_WS_EVENTS);
+            break;
+        case PNT_HEATMAP_IMAGE:
+            // the BGRA image follows as a binary message
+            u_ctx->flag |= PNT_FLAG_WS_SEND_HEATMAP;
+            append_session_msg(u_ctx->message, "{\"width\":%d,\"height\":%d,\"format\":\"bgra\"}",
+                               MotionHeatmap::COLS, MotionHeatmap::ROWS);
+            break;
         default:
             u_ctx->flag &= ~PNT_FLAG_SEPARATOR;
             break;
@@ -2318,11 +2491,49 @@ int WS::ws_callback(struct lws *wsi, enum lws_callback_reasons reason, void *use
             }
             u_ctx->flag &= ~(PNT_FLAG_WS_SEND_PREVIEW | PNT_FLAG_WS_PREVIEW_PENDING);
         }
+
+        // motion heatmap overlay, after the json answer announcing it
+        if (u_ctx->flag & PNT_FLAG_WS_SEND_HEATMAP)
+        {
+            u_ctx->flag &= ~PNT_FLAG_WS_SEND_HEATMAP;
+            std::vector<uint8_t> image = Motion::heatmap.toBGRA();
+            image.insert(image.begin(), LWS_PRE, 0);
+            lws_write(wsi, image.data() + LWS_PRE, image.size() - LWS_PRE, LWS_WRITE_BINARY);
+        }
         break;
 
+    case LWS_CALLBACK_EVENT_WAIT_CANCELLED:
+    {
+        // woken by the event bus, forward queued events to subscribers
+        std::vector<std::string> events;
+        {
+            std::lock_guard<std::mutex> lock(ws_events_mutex);
+            events.swap(ws_events_pending);
+        }
+        for (struct lws *session : ws_event_sessions)
+        {
+            user_ctx *s_ctx = (user_ctx *)lws_wsi_user(session);
+            for (const auto &event : events)
+            {
+                if (!s_ctx->tx_message.empty())
+                    s_ctx->tx_message.append(";");
+                s_ctx->tx_message.append("{\"event\":" + event + "}");
+            }
+            if (s_ctx->tx_message.size() > MAX_WS_TX_QUEUE_SIZE)
+            {
+                LOG_ERROR("WebSocket TX queue too large, clearing queue");
+                s_ctx->tx_message.clear();
+            }
+            lws_callback_on_writable(session);
+        }
+        break;
+    }
+
     case LWS_CALLBACK_CLOSED:
         LOG_DEBUG("LWS_CALLBACK_CLOSED ip:" << client_ip << " - WebSocket connection closed");
 
+        ws_event_sessions.erase(wsi);
+
         // cleanup delete possibly existing shedules for this session
         lws_sul_cancel(&u_ctx->sul);
 
@@ -2687,6 +2898,16 @@ void WS::start()
 
     LOG_INFO("Server started on port " << cfg->websocket.port);
 
+    ws_context = context;
+    EventBus::instance().subscribe([](const Event &event) {
+        {
+            std::lock_guard<std::mutex> lock(ws_events_mutex);
+            if (ws_events_pending.size() < 16)
+                ws_events_pending.push_back(EventBus::toJson(event));
+        }
+        lws_cancel_service(ws_context);
+    });
+
     while (true)
     {
         lws_service(context, 50);
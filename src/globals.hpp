@@ -1,9 +1,12 @@
 #ifndef GLOBALS_HPP
 #define GLOBALS_HPP
 
+#include <algorithm>
 #include <memory>
 #include <functional>
 #include <atomic>
+#include <mutex>
+#include <vector>
 #include "liveMedia.hh"
 
 #include "MsgChannel.hpp"
@@ -37,6 +40,10 @@ struct BackchannelFrame
     std::vector<uint8_t> payload;
     IMPBackchannelFormat format;
     unsigned int clientSessionId;
+    // RTP header fields of the packet, used for reordering and playout timing
+    bool hasRtpInfo = false;
+    uint16_t rtpSeq = 0;
+    uint32_t rtpTimestamp = 0;
 };
 
 struct jpeg_stream
@@ -90,6 +97,29 @@ struct audio_stream
     std::condition_variable should_grab_frames;
     std::binary_semaphore is_activated{0};
 
+    /* Packet loss (percent) from RTCP receiver reports, one entry per RTSP
+     * audio subsession of this channel (every video stream has its own).
+     * Each subsession registers its own counter for its lifetime and resets
+     * it when its last client leaves. The Opus encoder of the channel scales
+     * its in-band FEC to the worst of them.
+     */
+    std::mutex rtcpLossLock; // protects rtcpLossReports
+    std::vector<const std::atomic<int> *> rtcpLossReports;
+
+    int rtcpLossPercent()
+    {
+        std::lock_guard<std::mutex> lock(rtcpLossLock);
+        int loss = 0;
+        for (const std::atomic<int> *report : rtcpLossReports)
+            loss = std::max(loss, report->load(std::memory_order_relaxed));
+        return loss;
+    }
+
+    // Latest capture level (loudest channel) and voice activity, for WS
+    std::atomic<float> levelRmsDbfs{-96.0f};
+    std::atomic<float> levelPeakDbfs{-96.0f};
+    std::atomic<bool> voiceActive{false};
+
     StreamReplicator *streamReplicator = nullptr;
 
     audio_stream(int devId, int aiChn, int aeChn)
@@ -117,6 +147,9 @@ struct video_stream
     std::mutex onDataCallbackLock;     // protects onDataCallback from deallocation
     std::condition_variable should_grab_frames;
     std::binary_semaphore is_activated{0};
+    // Set by Motion while nothing moves, the worker switches the encoder to
+    // the idle profile when stream->idle_enabled
+    std::atomic<bool> idle{false};
 
     video_stream(int encChn, _stream *stream, const char *name)
         : encChn(encChn), stream(stream), name(name), running(false), idr(false), idr_fix(0), imp_encoder(nullptr), imp_framesource(nullptr),
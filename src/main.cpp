@@ -18,6 +18,7 @@
 #include "WorkerUtils.hpp"
 #include "IMPBackchannel.hpp"
 #include "TimestampManager.hpp"
+#include "EventConsumers.hpp"
 using namespace std::chrono;
 
 std::mutex mutex_main;
@@ -80,6 +81,7 @@ int main(int argc, const char *argv[])
     LOG_INFO("PRUDYNT-T Next-Gen Video Daemon: " << FULL_VERSION_STRING);
 
     pthread_t cw_thread;
+    pthread_t event_thread;
     pthread_t ws_thread;
     pthread_t osd_thread;
     pthread_t rtsp_thread;
@@ -121,6 +123,17 @@ int main(int argc, const char *argv[])
 #endif
 
     pthread_create(&cw_thread, nullptr, ConfigWatcher::thread_entry, nullptr);
+    pthread_create(&event_thread, nullptr, EventSocket::thread_entry, nullptr);
+
+    // Event scripts run on their own threads, never in the detector loops.
+    // The hooks live for the whole process.
+    new ScriptHook(EventSource::Motion, [] { return cfg->motion.script_path; },
+                   milliseconds(cfg->motion.script_min_interval));
+#if defined(AUDIO_SUPPORT)
+    // sound_event_cooldown already limits how often sound events start
+    new ScriptHook(EventSource::Sound, [] { return cfg->audio.sound_event_script; },
+                   milliseconds(0));
+#endif
     pthread_create(&ws_thread, nullptr, WS::run, &ws);
 
     while (true)
@@ -247,6 +260,7 @@ int main(int argc, const char *argv[])
             if (global_osd_thread_signal)
             {
                 global_osd_thread_signal = false;
+                OSD::wake_thread();
                 int ret = pthread_join(osd_thread, NULL);
                 LOG_DEBUG_OR_ERROR(ret, "join osd thread");
             }
@@ -0,0 +1,61 @@
+#include "AudioLevel.hpp"
+#include "check.hpp"
+#include "signal.hpp"
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdlib>
+#include <vector>
+
+/* AudioLevel::measure16 against a plain per sample loop, and the whole
+ * AudioLevelMeter::process per captured frame. The last column is the share
+ * of one core the meter takes at that frame rate.
+ */
+
+static void scalar(const int16_t *in, size_t samples, PcmEnergy &acc)
+{
+    for (size_t i = 0; i < samples; i++)
+    {
+        int32_t s = in[i];
+        acc.sumSquares[i & 1] += (uint64_t) (s * s);
+        acc.peak[i & 1] = std::max(acc.peak[i & 1], std::abs(s));
+        acc.count[i & 1]++;
+    }
+}
+
+static void run(int rate, int channels, size_t frameMs)
+{
+    size_t samples = (size_t) rate * frameMs / 1000 * channels;
+    printf("%d Hz, %d channel(s), %zu ms frames (%zu samples)\n", rate, channels, frameMs, samples);
+
+    std::vector<int16_t> in = tone(440, rate * channels, samples, 12000.0);
+    const int iterations = 200000;
+
+    double a = bench("scalar loop", iterations, [&] {
+        PcmEnergy e;
+        scalar(in.data(), samples, e);
+        keep(e);
+    });
+    double b = bench("AudioLevel::measure16", iterations, [&] {
+        PcmEnergy e;
+        AudioLevel::measure16(in.data(), samples, e);
+        keep(e);
+    });
+
+    AudioLevelMeter meter;
+    meter.reset(rate, channels, 9);
+    double c = bench("AudioLevelMeter::process", iterations, [&] {
+        keep(meter.process(in.data(), samples));
+    });
+
+    printf("  speedup %.2fx, meter %.4f%% of a core\n", a / b, 100.0 * c / (frameMs * 1e6));
+}
+
+int main()
+{
+    run(16000, 1, 20);
+    run(16000, 1, 10);
+    run(48000, 1, 20);
+    run(48000, 2, 20);
+    return 0;
+}
@@ -0,0 +1,132 @@
+#include "BlockMotion.hpp"
+#include "check.hpp"
+
+#include <cstdint>
+#include <cstdlib>
+#include <vector>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+/* BlockMotionDetector per frame, and its kernels against plain loops. The
+ * previous background blend, which only rounded up, is timed as well to
+ * show what rounding towards cur in both directions costs.
+ */
+
+static void sadScalar(const uint8_t *cur, const uint8_t *ref, size_t groups, uint32_t *sums)
+{
+    for (size_t g = 0; g < groups; g++)
+    {
+        uint32_t sad = 0;
+        for (int i = 0; i < 8; i++)
+            sad += std::abs(cur[g * 8 + i] - ref[g * 8 + i]);
+        sums[g] += sad;
+    }
+}
+
+static void blendScalar(uint8_t *bg, const uint8_t *cur, size_t n)
+{
+    for (size_t i = 0; i < n; i++)
+    {
+        unsigned b = bg[i];
+        unsigned c = cur[i];
+        unsigned up = c > b;
+        bg[i] = (uint8_t) ((b + ((b + ((b + c + up) >> 1) + up) >> 1) + up) >> 1);
+    }
+}
+
+// The previous blendBackground, rounding up only
+static void blendRoundUp(uint8_t *bg, const uint8_t *cur, size_t n)
+{
+    size_t i = 0;
+#if defined(__SSE2__)
+    for (; i + 16 <= n; i += 16)
+    {
+        __m128i b = _mm_loadu_si128(reinterpret_cast<const __m128i *>(bg + i));
+        __m128i c = _mm_loadu_si128(reinterpret_cast<const __m128i *>(cur + i));
+        __m128i r = _mm_avg_epu8(b, _mm_avg_epu8(b, _mm_avg_epu8(b, c)));
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(bg + i), r);
+    }
+#endif
+    for (; i < n; i++)
+    {
+        unsigned b = bg[i];
+        bg[i] = (uint8_t) ((b + ((b + ((b + cur[i] + 1) >> 1) + 1) >> 1) + 1) >> 1);
+    }
+}
+
+static void kernels(size_t width)
+{
+    printf("kernels, one %zu pixel row\n", width);
+
+    std::vector<uint8_t> cur(width), bg(width);
+    for (size_t i = 0; i < width; i++)
+    {
+        cur[i] = (uint8_t) (i * 7);
+        bg[i] = (uint8_t) (i * 13);
+    }
+    std::vector<uint32_t> sums(width / 8);
+    const int iterations = 100000;
+
+    double a = bench("accumulateSad8 scalar loop", iterations, [&] {
+        sadScalar(cur.data(), bg.data(), width / 8, sums.data());
+        keep(sums[0]);
+    });
+    double b = bench("BlockMotion::accumulateSad8", iterations, [&] {
+        BlockMotion::accumulateSad8(cur.data(), bg.data(), width / 8, sums.data());
+        keep(sums[0]);
+    });
+    printf("  speedup %.2fx\n", a / b);
+
+    // alternate the direction so both roundings are exercised
+    a = bench("blendBackground scalar loop", iterations, [&] {
+        blendScalar(bg.data(), cur.data(), width);
+        blendScalar(cur.data(), bg.data(), width);
+        keep(bg[0]);
+    });
+    double up = bench("previous blend (round up only)", iterations, [&] {
+        blendRoundUp(bg.data(), cur.data(), width);
+        blendRoundUp(cur.data(), bg.data(), width);
+        keep(bg[0]);
+    });
+    b = bench("BlockMotion::blendBackground", iterations, [&] {
+        BlockMotion::blendBackground(bg.data(), cur.data(), width);
+        BlockMotion::blendBackground(cur.data(), bg.data(), width);
+        keep(bg[0]);
+    });
+    printf("  speedup %.2fx vs scalar, %.2fx the time of round up only\n", a / b, b / up);
+}
+
+static void frames(int width, int height, int blockSize)
+{
+    printf("BlockMotionDetector::process, %dx%d, %d px blocks\n", width, height, blockSize);
+
+    // two NV12 frames with a moving pattern
+    std::vector<uint8_t> a((size_t) width * height * 3 / 2), b(a.size());
+    for (size_t i = 0; i < a.size(); i++)
+    {
+        a[i] = (uint8_t) ((i * 31) >> 4);
+        b[i] = (uint8_t) ((i * 31 + 100) >> 4);
+    }
+
+    BlockMotionDetector detector;
+    detector.reset(width, height, blockSize);
+    detector.process(a.data(), width);
+
+    int n = 0;
+    bench("per frame", 500, [&] {
+        detector.process((n++ & 1) ? a.data() : b.data(), width);
+        keep(detector.activity()[0]);
+    });
+}
+
+int main()
+{
+    kernels(640);
+    kernels(1920);
+    frames(640, 360, 16);
+    frames(640, 360, 8);
+    frames(1920, 1080, 16);
+    return 0;
+}
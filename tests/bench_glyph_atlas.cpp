@@ -0,0 +1,81 @@
+#include "GlyphAtlas.hpp"
+#include "check.hpp"
+#include "glyphs.hpp"
+
+#include <algorithm>
+#include <cstdint>
+#include <map>
+#include <vector>
+
+/* The set_text render path, before and after the glyph atlas: size the
+ * canvas, allocate and clear it, draw the text. Before, every glyph stamps
+ * its outline pixel by pixel through setPixel; after, GlyphAtlas::blit
+ * copies the pre-rendered runs. Synthetic glyphs at OSD font sizes.
+ */
+
+static const uint8_t TEXT[4] = {0xff, 0xff, 0xff, 0x00};
+static const uint8_t STROKE[4] = {0x00, 0x00, 0x00, 0xff};
+static const char *TIMESTAMP = "2026-10-18 12:34:56";
+
+static void run(int fontSize, int stroke)
+{
+    std::map<char, TestGlyph> glyphs;
+    std::map<char, LegacyGlyph> legacy;
+    GlyphAtlas atlas;
+    atlas.reset(TEXT, STROKE, stroke, 1 << 20);
+    for (const char *c = "0123456789-: "; *c; c++)
+    {
+        glyphs[*c] = makeGlyph((unsigned char) *c, fontSize);
+        legacy[*c] = legacyGlyph(glyphs[*c], TEXT);
+        atlas.add((unsigned char) *c, glyphs[*c].coverage.data(), glyphs[*c].width, glyphs[*c].height,
+                  glyphs[*c].advance, glyphs[*c].xmin, glyphs[*c].ymin);
+    }
+
+    // OSD::calculateTextSize
+    int width = 0, height = 0;
+    for (const char *c = TIMESTAMP; *c; c++)
+    {
+        width += glyphs[*c].advance + stroke * 2;
+        height = std::max(height, glyphs[*c].height);
+    }
+    width += 1 + stroke;
+    width += width % 2;
+    height += fontSize;
+    printf("font %d, stroke %d, %dx%d\n", fontSize, stroke, width, height);
+
+    std::vector<uint8_t> canvas;
+    const int iterations = 2000;
+
+    double before = bench("setPixel outline + text", iterations, [&] {
+        canvas.assign((size_t) width * height * 4, 0);
+        legacyDrawText(canvas.data(), TIMESTAMP, legacy, fontSize, STROKE, width, height, stroke);
+        keep(canvas[0]);
+    });
+    double after = bench("GlyphAtlas::blit", iterations, [&] {
+        canvas.assign((size_t) width * height * 4, 0);
+        atlas.beginUpdate();
+        int penX = 1;
+        for (const char *c = TIMESTAMP; *c; c++)
+        {
+            const GlyphAtlas::Cell *g = atlas.find((unsigned char) *c);
+            int x = penX + g->xmin + stroke;
+            int y = 1 + fontSize + g->ymin;
+            atlas.blit(*g, canvas.data(), x - stroke, y - stroke, width, height);
+            penX += g->advance + stroke * 2;
+        }
+        keep(canvas[0]);
+    });
+    printf("  speedup %.2fx\n", before / after);
+}
+
+int main()
+{
+    // font_size and font_stroke combinations in use
+    run(18, 1);
+    run(18, 2);
+    run(24, 1);
+    run(24, 3);
+    run(36, 2);
+    run(48, 4);
+    return 0;
+}
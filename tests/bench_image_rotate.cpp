@@ -0,0 +1,114 @@
+#include "ImageRotate.hpp"
+#include "check.hpp"
+
+#include <climits>
+#include <cmath>
+#include <cstdint>
+#include <vector>
+
+/* ImageRotate::rotateBGRA against the OSD rotation it replaced, at OSD item
+ * and logo sizes.
+ */
+
+// The previous OSD::rotateBGRAImage, unchanged apart from the name
+static void legacyRotate(const uint8_t *inputImage, uint16_t &width, uint16_t &height, int angle, std::vector<uint8_t> &output)
+{
+    double angleRad = angle * (M_PI / 180.0);
+
+    int originalCorners[4][2] = {
+        {0, 0},
+        {width, 0},
+        {0, height},
+        {width, height}};
+
+    int minX = INT_MAX;
+    int maxX = INT_MIN;
+    int minY = INT_MAX;
+    int maxY = INT_MIN;
+
+    for (auto &originalCorner : originalCorners)
+    {
+        int x = originalCorner[0];
+        int y = originalCorner[1];
+
+        int newX = static_cast<int>(x * cos(angleRad) - y * sin(angleRad));
+        int newY = static_cast<int>(x * sin(angleRad) + y * cos(angleRad));
+
+        if (newX < minX)
+            minX = newX;
+        if (newX > maxX)
+            maxX = newX;
+        if (newY < minY)
+            minY = newY;
+        if (newY > maxY)
+            maxY = newY;
+    }
+
+    int newWidth = maxX - minX + 1;
+    int newHeight = maxY - minY + 1;
+
+    int centerX = width / 2;
+    int centerY = height / 2;
+
+    int newCenterX = newWidth / 2;
+    int newCenterY = newHeight / 2;
+
+    output.assign(newWidth * newHeight * 4, 0);
+    uint8_t *rotatedImage = output.data();
+
+    for (int y = 0; y < newHeight; ++y)
+    {
+        for (int x = 0; x < newWidth; ++x)
+        {
+            int newX = x - newCenterX;
+            int newY = y - newCenterY;
+
+            int origX = static_cast<int>(newX * cos(angleRad) + newY * sin(angleRad)) + centerX;
+            int origY = static_cast<int>(-newX * sin(angleRad) + newY * cos(angleRad)) + centerY;
+
+            if (origX >= 0 && origX < width && origY >= 0 && origY < height)
+            {
+                for (int c = 0; c < 4; ++c)
+                {
+                    rotatedImage[(y * newWidth + x) * 4 + c] = inputImage[(origY * width + origX) * 4 + c];
+                }
+            }
+        }
+    }
+
+    width = newWidth;
+    height = newHeight;
+}
+
+static void run(int width, int height, int angle)
+{
+    printf("%dx%d, %d degrees\n", width, height, angle);
+
+    std::vector<uint8_t> input(width * height * 4, 0x7f), output;
+    const int iterations = 2000;
+
+    double a = bench("legacy (double per pixel)", iterations, [&] {
+        uint16_t w = width, h = height;
+        legacyRotate(input.data(), w, h, angle, output);
+        keep(output[0]);
+    });
+    double b = bench("ImageRotate::rotateBGRA", iterations, [&] {
+        uint16_t w = width, h = height;
+        ImageRotate::rotateBGRA(input.data(), w, h, angle, output);
+        keep(output[0]);
+    });
+    printf("  speedup %.2fx\n", a / b);
+}
+
+int main()
+{
+    // timestamp and uptime sized items, logos
+    run(242, 30, 90);
+    run(242, 30, 180);
+    run(664, 82, 90);
+    run(664, 82, 270);
+    run(200, 200, 180);
+    run(392, 41, 30);
+    run(664, 82, 45);
+    return 0;
+}
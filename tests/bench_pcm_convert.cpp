@@ -0,0 +1,67 @@
+#include "PcmConvert.hpp"
+#include "check.hpp"
+
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+/* PcmConvert::monoToStereo16 against the per-sample memcpy loop it replaced
+ * in AudioWorker (minus its per-frame new/delete) and a plain indexed loop.
+ */
+
+static void legacy(const uint8_t *in, uint8_t *out, size_t len, size_t sampleSize)
+{
+    size_t samples = len / sampleSize;
+    for (size_t i = 0; i < samples; i++)
+    {
+        const uint8_t *mono = in + i * sampleSize;
+        uint8_t *left = out + i * sampleSize * 2;
+        uint8_t *right = left + sampleSize;
+        memcpy(left, mono, sampleSize);
+        memcpy(right, mono, sampleSize);
+    }
+}
+
+static void indexed(const int16_t *in, int16_t *out, size_t samples)
+{
+    for (size_t i = 0; i < samples; i++)
+    {
+        out[2 * i] = in[i];
+        out[2 * i + 1] = in[i];
+    }
+}
+
+static void run(size_t samples, const char *what)
+{
+    printf("%zu samples (%s)\n", samples, what);
+
+    std::vector<int16_t> in(samples, 123), out(2 * samples);
+    const int iterations = 200000;
+
+    // runtime sample size, as the old code took it from the frame
+    volatile size_t sampleSize = sizeof(int16_t);
+    double a = bench("legacy memcpy per sample", iterations, [&] {
+        legacy(reinterpret_cast<const uint8_t *>(in.data()), reinterpret_cast<uint8_t *>(out.data()),
+               samples * sizeof(int16_t), sampleSize);
+        keep(out[0]);
+    });
+    double b = bench("indexed loop", iterations, [&] {
+        indexed(in.data(), out.data(), samples);
+        keep(out[0]);
+    });
+    double c = bench("PcmConvert::monoToStereo16", iterations, [&] {
+        PcmConvert::monoToStereo16(in.data(), out.data(), samples);
+        keep(out[0]);
+    });
+
+    printf("  speedup %.2fx vs legacy, %.2fx vs indexed\n", a / c, b / c);
+}
+
+int main()
+{
+    run(160, "10 ms at 16 kHz");
+    run(320, "20 ms at 16 kHz");
+    run(960, "20 ms at 48 kHz");
+    run(963, "odd tail");
+    return 0;
+}
@@ -0,0 +1,130 @@
+#include "RingBuffer.hpp"
+#include "check.hpp"
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <stdexcept>
+#include <vector>
+
+/* RingBuffer<int16_t> against the byte buffer it replaced, with the audio
+ * reframer's access pattern: capture frames in, encoder frames out.
+ */
+
+// The previous src/RingBuffer.hpp, unchanged apart from the name
+class LegacyRingBuffer
+{
+public:
+    LegacyRingBuffer(size_t capacity)
+        : buffer(new uint8_t[capacity]), capacity(capacity), head(0), tail(0), size(0)
+    {}
+
+    ~LegacyRingBuffer()
+    {
+        delete[] buffer;
+    }
+
+    void push(const uint8_t* data, size_t dataSize)
+    {
+        if (dataSize > capacity - size)
+        {
+            throw std::overflow_error("Ring buffer overflow");
+        }
+
+        size_t spaceAtEnd = capacity - tail;
+        if (dataSize <= spaceAtEnd)
+        {
+            std::memcpy(buffer + tail, data, dataSize);
+        }
+        else
+        {
+            std::memcpy(buffer + tail, data, spaceAtEnd);
+            std::memcpy(buffer, data + spaceAtEnd, dataSize - spaceAtEnd);
+        }
+
+        tail = (tail + dataSize) % capacity;
+        size += dataSize;
+    }
+
+    void fetch(uint8_t* output, size_t count)
+    {
+        if (count > size)
+        {
+            throw std::underflow_error("Ring buffer underflow");
+        }
+
+        size_t spaceAtEnd = capacity - head;
+        if (count <= spaceAtEnd)
+        {
+            std::memcpy(output, buffer + head, count);
+        }
+        else
+        {
+            std::memcpy(output, buffer + head, spaceAtEnd);
+            std::memcpy(output + spaceAtEnd, buffer, count - spaceAtEnd);
+        }
+
+        head = (head + count) % capacity;
+        size -= count;
+    }
+
+    bool isEmpty() const { return size == 0; }
+    size_t getSize() const { return size; }
+
+private:
+    uint8_t* buffer;
+    size_t capacity;
+    size_t head;
+    size_t tail;
+    size_t size;
+};
+
+static void run(unsigned inSamples, unsigned outSamples)
+{
+    printf("%u samples in, %u out\n", inSamples, outSamples);
+
+    // Same sizing as AudioReframer, in samples
+    size_t samples = 2 * std::max(inSamples, outSamples);
+    std::vector<int16_t> in(inSamples, 1), out(outSamples);
+    const int iterations = 200000;
+
+    LegacyRingBuffer legacy(samples * sizeof(int16_t));
+    double a = bench("legacy (bytes, modulo, throws)", iterations, [&] {
+        legacy.push(reinterpret_cast<const uint8_t*>(in.data()), inSamples * sizeof(int16_t));
+        while (legacy.getSize() >= outSamples * sizeof(int16_t))
+            legacy.fetch(reinterpret_cast<uint8_t*>(out.data()), outSamples * sizeof(int16_t));
+        keep(out[0]);
+    });
+
+    RingBuffer<int16_t> ring(samples);
+    double b = bench("RingBuffer<int16_t>", iterations, [&] {
+        ring.push(in.data(), inSamples);
+        while (ring.size() >= outSamples)
+            ring.fetch(out.data(), outSamples);
+        keep(out[0]);
+    });
+
+    RingBuffer<int16_t> inPlace(samples);
+    double c = bench("RingBuffer<int16_t> peek/consume", iterations, [&] {
+        inPlace.push(in.data(), inSamples);
+        while (inPlace.size() >= outSamples)
+        {
+            auto src = inPlace.peek(outSamples);
+            keep(src.first[0]);
+            inPlace.consume(outSamples);
+        }
+    });
+
+    printf("  speedup %.2fx (copy), %.2fx (in place)\n", a / b, a / c);
+}
+
+int main()
+{
+    // 16 kHz capture frames (10 ms) to Opus 20 ms, AAC 1024 and G.711 frames
+    run(160, 320);
+    run(160, 1024);
+    run(160, 160);
+    // 48 kHz to AAC
+    run(480, 1024);
+    return 0;
+}
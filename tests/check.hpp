@@ -0,0 +1,65 @@
+#ifndef TESTS_CHECK_HPP
+#define TESTS_CHECK_HPP
+
+#include <chrono>
+#include <cstdio>
+
+/* Minimal helpers shared by the host tests and benchmarks.
+ *
+ * CHECK() reports a failed condition and keeps going, so one run lists every
+ * broken case; a test's main() returns checkResult(). bench() times a
+ * callable over a number of iterations and prints nanoseconds per iteration.
+ */
+
+inline int &checkFailures()
+{
+    static int failures = 0;
+    return failures;
+}
+
+#define CHECK(cond)                                                          \
+    do                                                                       \
+    {                                                                        \
+        if (!(cond))                                                         \
+        {                                                                    \
+            fprintf(stderr, "%s:%d: CHECK(%s) failed\n", __FILE__, __LINE__, \
+                    #cond);                                                  \
+            checkFailures()++;                                               \
+        }                                                                    \
+    } while (0)
+
+inline int checkResult(const char *name)
+{
+    if (checkFailures())
+        fprintf(stderr, "%s: %d check(s) failed\n", name, checkFailures());
+    else
+        printf("%s: ok\n", name);
+    return checkFailures() ? 1 : 0;
+}
+
+// Keep the optimizer from discarding a benchmarked result
+template <typename T>
+inline void keep(const T &value)
+{
+    asm volatile("" : : "r,m"(value) : "memory");
+}
+
+// Runs fn() 'iterations' times after a short warm up, prints and returns
+// the time per iteration in ns
+template <typename F>
+inline double bench(const char *name, int iterations, F &&fn)
+{
+    for (int i = 0; i < iterations / 10 + 1; i++)
+        fn();
+
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < iterations; i++)
+        fn();
+    auto elapsed = std::chrono::steady_clock::now() - start;
+
+    double ns = std::chrono::duration<double, std::nano>(elapsed).count() / iterations;
+    printf("  %-40s %12.1f ns/iter\n", name, ns);
+    return ns;
+}
+
+#endif // TESTS_CHECK_HPP
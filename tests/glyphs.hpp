@@ -0,0 +1,177 @@
+#ifndef TESTS_GLYPHS_HPP
+#define TESTS_GLYPHS_HPP
+
+#include <cstdint>
+#include <cstring>
+#include <map>
+#include <vector>
+
+/* Synthetic OSD glyphs and the per pixel text drawing GlyphAtlas replaced,
+ * for the glyph atlas test and benchmark.
+ */
+
+struct TestGlyph
+{
+    int width;
+    int height;
+    int advance;
+    int xmin;
+    int ymin;
+    std::vector<uint8_t> coverage;
+};
+
+// A glyph of roughly 'fontSize' pixels: an antialiased ring with a bar and
+// a few specks, shaped by the codepoint. Its bitmap is wider than the
+// advance and starts left of the pen (xmin < 0) for some codepoints, so
+// neighbouring glyphs and their outlines overlap.
+inline TestGlyph makeGlyph(uint32_t codepoint, int fontSize)
+{
+    TestGlyph g;
+    g.width = fontSize / 2 + (int) (codepoint % 5);
+    g.height = fontSize * 3 / 4 - (int) (codepoint % 3);
+    g.advance = g.width - 1 - (int) (codepoint % 2);
+    g.xmin = (codepoint % 4 == 0) ? -1 : 0;
+    g.ymin = -g.height - (int) (codepoint % 3);
+    g.coverage.assign((size_t) g.width * g.height, 0);
+
+    double cx = (g.width - 1) / 2.0, cy = (g.height - 1) / 2.0;
+    double rx = g.width / 2.0 - 0.5, ry = g.height / 2.0 - 0.5;
+    uint32_t seed = codepoint * 2654435761u;
+    for (int y = 0; y < g.height; y++)
+    {
+        for (int x = 0; x < g.width; x++)
+        {
+            double dx = (x - cx) / rx, dy = (y - cy) / ry;
+            double d = dx * dx + dy * dy;
+            int v = 0;
+            if (d > 0.55 && d < 1.0)
+                v = 255;
+            else if (d >= 1.0 && d < 1.15)
+                v = 90; // antialiased edge
+            if (y == g.height / 2 + (int) (codepoint % 3) - 1)
+                v = 255;
+
+            seed = seed * 1664525 + 1013904223;
+            if (v == 0 && (seed >> 24) < 6)
+                v = 1 + (int) ((seed >> 8) & 0x7f);
+            g.coverage[(size_t) y * g.width + x] = (uint8_t) v;
+        }
+    }
+    return g;
+}
+
+/* The drawing before the atlas: every glyph stamps its outline through the
+ * bounds checked setPixel for each disc offset, then its text pixels. Kept
+ * as it was apart from taking the glyphs and colours as parameters.
+ */
+struct LegacyGlyph
+{
+    int width;
+    int height;
+    std::vector<uint8_t> bitmap;
+    int advance;
+    int xmin;
+    int ymin;
+};
+
+inline LegacyGlyph legacyGlyph(const TestGlyph &t, const uint8_t *text)
+{
+    LegacyGlyph g;
+    g.width = t.width;
+    g.height = t.height;
+    g.advance = t.advance;
+    g.xmin = t.xmin;
+    g.ymin = t.ymin;
+    g.bitmap.assign((size_t) g.width * g.height * 4, 0);
+    for (int y = 0; y < g.height; ++y)
+    {
+        for (int x = 0; x < g.width; ++x)
+        {
+            int pixelIndex = y * g.width + x;
+            uint8_t alpha = t.coverage[pixelIndex];
+            if (alpha > 0)
+            {
+                g.bitmap[pixelIndex * 4] = text[0];
+                g.bitmap[pixelIndex * 4 + 1] = text[1];
+                g.bitmap[pixelIndex * 4 + 2] = text[2];
+                g.bitmap[pixelIndex * 4 + 3] = alpha;
+            }
+        }
+    }
+    return g;
+}
+
+inline void legacySetPixel(uint8_t *image, int x, int y, const uint8_t *color, int WIDTH, int HEIGHT)
+{
+    if (x >= 0 && x < WIDTH && y >= 0 && y < HEIGHT)
+    {
+        int index = (y * WIDTH + x) * 4;
+        image[index] = color[0];     // B
+        image[index + 1] = color[1]; // G
+        image[index + 2] = color[2]; // R
+        image[index + 3] = color[3]; // A
+    }
+}
+
+inline void legacyDrawOutline(uint8_t *image, const LegacyGlyph &g, int x, int y, int outlineSize,
+                              const uint8_t *stroke, int WIDTH, int HEIGHT)
+{
+    for (int j = -outlineSize; j <= outlineSize; ++j)
+    {
+        for (int i = -outlineSize; i <= outlineSize; ++i)
+        {
+            if (i * i + j * j <= outlineSize * outlineSize)
+            { // Use circular distance
+                for (int h = 0; h < g.height; ++h)
+                {
+                    for (int w = 0; w < g.width; ++w)
+                    {
+                        int srcIndex = (h * g.width + w) * 4;
+                        if (g.bitmap[srcIndex + 3] > 0)
+                        { // Check alpha value
+                            legacySetPixel(image, x + w + i, y + h + j, stroke, WIDTH, HEIGHT);
+                        }
+                    }
+                }
+            }
+        }
+    }
+}
+
+inline void legacyDrawText(uint8_t *image, const char *text, const std::map<char, LegacyGlyph> &glyphs,
+                           int yScale, const uint8_t *stroke, int WIDTH, int HEIGHT, int outlineSize)
+{
+    int penX = 1;
+    int penY = 1;
+
+    while (*text)
+    {
+        auto it = glyphs.find(*text);
+        if (it != glyphs.end())
+        {
+            const LegacyGlyph &g = it->second;
+
+            int x = penX + g.xmin + outlineSize;
+            int y = penY + (yScale + g.ymin);
+
+            legacyDrawOutline(image, g, x, y, outlineSize, stroke, WIDTH, HEIGHT);
+
+            for (int j = 0; j < g.height; ++j)
+            {
+                for (int i = 0; i < g.width; ++i)
+                {
+                    int srcIndex = (j * g.width + i) * 4;
+                    if (g.bitmap[srcIndex + 3] > 0)
+                    { // Check alpha value
+                        legacySetPixel(image, x + i, y + j, &g.bitmap[srcIndex], WIDTH, HEIGHT);
+                    }
+                }
+            }
+
+            penX += g.advance + (outlineSize * 2);
+        }
+        ++text;
+    }
+}
+
+#endif // TESTS_GLYPHS_HPP
@@ -0,0 +1,213 @@
+#ifndef TESTS_MSA_MSA_H
+#define TESTS_MSA_MSA_H
+
+/* Host stand-in for the MIPS MSA <msa.h>, so the __mips_msa kernels can be
+ * checked against the scalar loops without a MIPS toolchain. Every intrinsic
+ * the sources use is implemented lane by lane from the MSA specification,
+ * with the same vector types and argument types as GCC's msa.h (loads and
+ * stores take a plain void *). Little endian, like the Ingenic SoCs.
+ *
+ * This only checks what the kernels compute; that they build for the
+ * target is up to the cross compiler.
+ */
+
+#include <cstdint>
+#include <cstring>
+
+typedef signed char v16i8 __attribute__((vector_size(16), aligned(16)));
+typedef unsigned char v16u8 __attribute__((vector_size(16), aligned(16)));
+typedef short v8i16 __attribute__((vector_size(16), aligned(16)));
+typedef unsigned short v8u16 __attribute__((vector_size(16), aligned(16)));
+typedef int v4i32 __attribute__((vector_size(16), aligned(16)));
+typedef unsigned int v4u32 __attribute__((vector_size(16), aligned(16)));
+typedef long long v2i64 __attribute__((vector_size(16), aligned(16)));
+typedef unsigned long long v2u64 __attribute__((vector_size(16), aligned(16)));
+
+// Loads and stores, unaligned; the offset is in bytes
+
+inline v16i8 __msa_ld_b(void *p, int offset)
+{
+    v16i8 r;
+    std::memcpy(&r, (uint8_t *) p + offset, sizeof(r));
+    return r;
+}
+
+inline v8i16 __msa_ld_h(void *p, int offset)
+{
+    v8i16 r;
+    std::memcpy(&r, (uint8_t *) p + offset, sizeof(r));
+    return r;
+}
+
+inline void __msa_st_b(v16i8 v, void *p, int offset) { std::memcpy((uint8_t *) p + offset, &v, sizeof(v)); }
+inline void __msa_st_h(v8i16 v, void *p, int offset) { std::memcpy((uint8_t *) p + offset, &v, sizeof(v)); }
+inline void __msa_st_d(v2i64 v, void *p, int offset) { std::memcpy((uint8_t *) p + offset, &v, sizeof(v)); }
+
+// Immediates and element access
+
+inline v8i16 __msa_ldi_h(int imm)
+{
+    v8i16 r;
+    for (int i = 0; i < 8; i++)
+        r[i] = (short) imm;
+    return r;
+}
+
+inline v2i64 __msa_ldi_d(int imm)
+{
+    v2i64 r = {imm, imm};
+    return r;
+}
+
+inline v4i32 __msa_fill_w(int value)
+{
+    v4i32 r = {value, value, value, value};
+    return r;
+}
+
+// copy_s.w; copy_u.w and the .d forms only exist on MIPS64
+inline int __msa_copy_s_w(v4i32 v, int lane) { return v[lane]; }
+
+// Bitwise
+
+inline v16u8 __msa_and_v(v16u8 a, v16u8 b) { return a & b; }
+inline v16u8 __msa_xor_v(v16u8 a, v16u8 b) { return a ^ b; }
+
+// wd = (ws & wt) | (wd & ~wt): ws where the mask bit is set
+inline v16u8 __msa_bmnz_v(v16u8 wd, v16u8 ws, v16u8 wt) { return (ws & wt) | (wd & ~wt); }
+
+// Byte arithmetic
+
+inline v16u8 __msa_asub_u_b(v16u8 a, v16u8 b)
+{
+    v16u8 r;
+    for (int i = 0; i < 16; i++)
+        r[i] = a[i] > b[i] ? a[i] - b[i] : b[i] - a[i];
+    return r;
+}
+
+inline v16u8 __msa_ave_u_b(v16u8 a, v16u8 b)
+{
+    v16u8 r;
+    for (int i = 0; i < 16; i++)
+        r[i] = (unsigned char) ((a[i] + b[i]) >> 1);
+    return r;
+}
+
+inline v16u8 __msa_aver_u_b(v16u8 a, v16u8 b)
+{
+    v16u8 r;
+    for (int i = 0; i < 16; i++)
+        r[i] = (unsigned char) ((a[i] + b[i] + 1) >> 1);
+    return r;
+}
+
+inline v16i8 __msa_cle_u_b(v16u8 a, v16u8 b)
+{
+    v16i8 r;
+    for (int i = 0; i < 16; i++)
+        r[i] = a[i] <= b[i] ? -1 : 0;
+    return r;
+}
+
+// Halfword arithmetic
+
+// |a| + |b|, wrapping: |-32768| is 0x8000
+inline v8i16 __msa_add_a_h(v8i16 a, v8i16 b)
+{
+    v8i16 r;
+    for (int i = 0; i < 8; i++)
+    {
+        unsigned x = a[i] < 0 ? 0u - (unsigned) a[i] : (unsigned) a[i];
+        unsigned y = b[i] < 0 ? 0u - (unsigned) b[i] : (unsigned) b[i];
+        r[i] = (short) (uint16_t) (x + y);
+    }
+    return r;
+}
+
+inline v8i16 __msa_adds_s_h(v8i16 a, v8i16 b)
+{
+    v8i16 r;
+    for (int i = 0; i < 8; i++)
+    {
+        int s = a[i] + b[i];
+        r[i] = (short) (s > INT16_MAX ? INT16_MAX : s < INT16_MIN ? INT16_MIN : s);
+    }
+    return r;
+}
+
+inline v8i16 __msa_max_s_h(v8i16 a, v8i16 b)
+{
+    v8i16 r;
+    for (int i = 0; i < 8; i++)
+        r[i] = a[i] > b[i] ? a[i] : b[i];
+    return r;
+}
+
+inline v8i16 __msa_min_s_h(v8i16 a, v8i16 b)
+{
+    v8i16 r;
+    for (int i = 0; i < 8; i++)
+        r[i] = a[i] < b[i] ? a[i] : b[i];
+    return r;
+}
+
+// Interleave the right (low) or left (high) halves, wt in the even lanes
+inline v8i16 __msa_ilvr_h(v8i16 ws, v8i16 wt)
+{
+    v8i16 r;
+    for (int i = 0; i < 4; i++)
+    {
+        r[2 * i] = wt[i];
+        r[2 * i + 1] = ws[i];
+    }
+    return r;
+}
+
+inline v8i16 __msa_ilvl_h(v8i16 ws, v8i16 wt)
+{
+    v8i16 r;
+    for (int i = 0; i < 4; i++)
+    {
+        r[2 * i] = wt[i + 4];
+        r[2 * i + 1] = ws[i + 4];
+    }
+    return r;
+}
+
+// Widening: hadd adds the odd lanes of ws to the even lanes of wt, dotp
+// sums the products of each pair of lanes
+
+inline v8u16 __msa_hadd_u_h(v16u8 ws, v16u8 wt)
+{
+    v8u16 r;
+    for (int i = 0; i < 8; i++)
+        r[i] = (unsigned short) (ws[2 * i + 1] + wt[2 * i]);
+    return r;
+}
+
+inline v4u32 __msa_hadd_u_w(v8u16 ws, v8u16 wt)
+{
+    v4u32 r;
+    for (int i = 0; i < 4; i++)
+        r[i] = (unsigned) ws[2 * i + 1] + wt[2 * i];
+    return r;
+}
+
+inline v2u64 __msa_hadd_u_d(v4u32 ws, v4u32 wt)
+{
+    v2u64 r;
+    for (int i = 0; i < 2; i++)
+        r[i] = (unsigned long long) ws[2 * i + 1] + wt[2 * i];
+    return r;
+}
+
+inline v4u32 __msa_dotp_u_w(v8u16 ws, v8u16 wt)
+{
+    v4u32 r;
+    for (int i = 0; i < 4; i++)
+        r[i] = (unsigned) ws[2 * i] * wt[2 * i] + (unsigned) ws[2 * i + 1] * wt[2 * i + 1];
+    return r;
+}
+
+#endif // TESTS_MSA_MSA_H
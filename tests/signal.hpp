@@ -0,0 +1,67 @@
+#ifndef TESTS_SIGNAL_HPP
+#define TESTS_SIGNAL_HPP
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+/* Test signals and measurements for the audio tests and benchmarks. */
+
+inline std::vector<int16_t> tone(double freq, int rate, size_t samples, double amplitude)
+{
+    std::vector<int16_t> out(samples);
+    for (size_t i = 0; i < samples; i++)
+        out[i] = (int16_t) std::lround(amplitude * std::sin(2.0 * M_PI * freq * i / rate));
+    return out;
+}
+
+inline double rms(const int16_t *x, size_t n)
+{
+    double sum = 0.0;
+    for (size_t i = 0; i < n; i++)
+        sum += (double) x[i] * x[i];
+    return n ? std::sqrt(sum / n) : 0.0;
+}
+
+inline double dB(double ratio)
+{
+    return 20.0 * std::log10(std::max(ratio, 1e-12));
+}
+
+// Least squares fit of a sine at 'freq' (any phase); returns the fitted
+// amplitude and the RMS of what is left over
+struct ToneFit
+{
+    double amplitude;
+    double residual;
+};
+
+inline ToneFit fitTone(const int16_t *x, size_t n, double freq, int rate)
+{
+    double ss = 0, cc = 0, sc = 0, xs = 0, xc = 0;
+    for (size_t i = 0; i < n; i++)
+    {
+        double s = std::sin(2.0 * M_PI * freq * i / rate);
+        double c = std::cos(2.0 * M_PI * freq * i / rate);
+        ss += s * s;
+        cc += c * c;
+        sc += s * c;
+        xs += x[i] * s;
+        xc += x[i] * c;
+    }
+    double det = ss * cc - sc * sc;
+    double a = (xs * cc - xc * sc) / det;
+    double b = (xc * ss - xs * sc) / det;
+
+    double err = 0.0;
+    for (size_t i = 0; i < n; i++)
+    {
+        double fit = a * std::sin(2.0 * M_PI * freq * i / rate) + b * std::cos(2.0 * M_PI * freq * i / rate);
+        err += (x[i] - fit) * (x[i] - fit);
+    }
+    return {std::hypot(a, b), n ? std::sqrt(err / n) : 0.0};
+}
+
+#endif // TESTS_SIGNAL_HPP
@@ -0,0 +1,170 @@
+#include "AudioLevel.hpp"
+#include "check.hpp"
+#include "signal.hpp"
+
+#include <cmath>
+#include <cstdint>
+#include <vector>
+
+// Straightforward reference the kernel must match
+static PcmEnergy reference(const int16_t *in, size_t samples)
+{
+    PcmEnergy e;
+    for (size_t i = 0; i < samples; i++)
+    {
+        int64_t s = in[i];
+        e.sumSquares[i & 1] += (uint64_t) (s * s);
+        e.peak[i & 1] = std::max<int32_t>(e.peak[i & 1], (int32_t) std::llabs(s));
+        e.count[i & 1]++;
+    }
+    return e;
+}
+
+static bool same(const PcmEnergy &a, const PcmEnergy &b)
+{
+    for (int p = 0; p < 2; p++)
+    {
+        if (a.sumSquares[p] != b.sumSquares[p] || a.peak[p] != b.peak[p] || a.count[p] != b.count[p])
+            return false;
+    }
+    return true;
+}
+
+static void testLengthsAndAlignment()
+{
+    std::vector<int16_t> in(300);
+    uint32_t seed = 3;
+    for (auto &v : in)
+    {
+        seed = seed * 1664525 + 1013904223;
+        v = (int16_t) (seed >> 16);
+    }
+    in[5] = INT16_MIN;
+    in[8] = INT16_MAX;
+
+    // every tail length around the 8 and 16 sample vectors, misaligned
+    for (size_t samples = 0; samples <= 70; samples++)
+    {
+        for (size_t offset = 0; offset < 3; offset++)
+        {
+            PcmEnergy got;
+            AudioLevel::measure16(in.data() + offset, samples, got);
+            CHECK(same(got, reference(in.data() + offset, samples)));
+        }
+    }
+
+    // accumulates on top of what is already there; parity restarts with
+    // each call, so blocks of interleaved stereo must hold whole frames
+    PcmEnergy got;
+    AudioLevel::measure16(in.data(), 38, got);
+    AudioLevel::measure16(in.data() + 38, 262, got);
+    CHECK(same(got, reference(in.data(), 300)));
+}
+
+static void testExtremes()
+{
+    // full scale negative: every square is 2^30, peak 32768
+    for (size_t samples : {1, 7, 8, 16, 33, 4800})
+    {
+        std::vector<int16_t> in(samples, INT16_MIN);
+        PcmEnergy got;
+        AudioLevel::measure16(in.data(), samples, got);
+        CHECK(same(got, reference(in.data(), samples)));
+        CHECK(got.peak[0] == 32768);
+        CHECK(got.sumSquares[0] == (uint64_t) ((samples + 1) / 2) << 30);
+    }
+
+    // full scale square wave, the even lane high and the odd lane low
+    std::vector<int16_t> square(4801);
+    for (size_t i = 0; i < square.size(); i++)
+        square[i] = (i & 1) ? INT16_MIN : INT16_MAX;
+    PcmEnergy sq;
+    AudioLevel::measure16(square.data(), square.size(), sq);
+    CHECK(same(sq, reference(square.data(), square.size())));
+    CHECK(sq.peak[0] == 32767 && sq.peak[1] == 32768);
+
+    // silence
+    std::vector<int16_t> silence(4799, 0);
+    PcmEnergy quiet;
+    AudioLevel::measure16(silence.data(), silence.size(), quiet);
+    CHECK(quiet.sumSquares[0] == 0 && quiet.sumSquares[1] == 0);
+    CHECK(quiet.peak[0] == 0 && quiet.peak[1] == 0);
+    CHECK(quiet.count[0] == 2400 && quiet.count[1] == 2399);
+
+    // ten seconds of full scale at 48 kHz does not overflow the sums
+    std::vector<int16_t> loud(48000 * 10, INT16_MIN);
+    PcmEnergy big;
+    AudioLevel::measure16(loud.data(), loud.size(), big);
+    CHECK(big.sumSquares[0] == (uint64_t) 240000 << 30 && big.sumSquares[1] == (uint64_t) 240000 << 30);
+}
+
+static void testMeter()
+{
+    AudioLevelMeter meter;
+
+    // full scale square: 0 dBFS RMS and peak; a window closes on the first
+    // frame that reaches 250 ms
+    meter.reset(16000, 1, 9);
+    std::vector<int16_t> square(320);
+    for (size_t i = 0; i < square.size(); i++)
+        square[i] = (i & 1) ? -32768 : 32767;
+    int windows = 0;
+    for (int frame = 0; frame < 26; frame++)
+        windows += meter.process(square.data(), square.size());
+    CHECK(windows == 2);
+    CHECK(std::fabs(meter.rmsDbfs(0)) < 0.01f);
+    CHECK(std::fabs(meter.peakDbfs(0)) < 0.01f);
+
+    // a -20 dBFS sine: -23 dBFS RMS, -20 dBFS peak
+    std::vector<int16_t> sine = tone(1000, 16000, 4000, 3276.8);
+    meter.reset(16000, 1, 9);
+    CHECK(meter.process(sine.data(), sine.size()));
+    CHECK(std::fabs(meter.rmsDbfs(0) - (-20.0f - 3.01f)) < 0.05f);
+    CHECK(std::fabs(meter.peakDbfs(0) - (-20.0f)) < 0.05f);
+
+    // silence reads as the floor
+    std::vector<int16_t> silence(4000, 0);
+    meter.reset(16000, 1, 9);
+    CHECK(meter.process(silence.data(), silence.size()));
+    CHECK(meter.rmsDbfs(0) == AudioLevelMeter::SILENCE_DBFS);
+    CHECK(meter.peakDbfs(0) == AudioLevelMeter::SILENCE_DBFS);
+
+    // stereo: left loud, right silent
+    std::vector<int16_t> stereo(2 * 4000, 0);
+    for (size_t i = 0; i < 4000; i++)
+        stereo[2 * i] = sine[i];
+    meter.reset(16000, 2, 9);
+    CHECK(meter.process(stereo.data(), stereo.size()));
+    CHECK(std::fabs(meter.rmsDbfs(0) - (-23.01f)) < 0.05f);
+    CHECK(meter.rmsDbfs(1) == AudioLevelMeter::SILENCE_DBFS);
+
+    // VAD: quiet noise floor, then speech level switches it on after two
+    // loud frames and off after the hangover
+    meter.reset(16000, 1, 9, 250, 300);
+    std::vector<int16_t> noise = tone(200, 16000, 320, 30.0);
+    std::vector<int16_t> speech = tone(300, 16000, 320, 8000.0);
+    for (int i = 0; i < 50; i++)
+        meter.process(noise.data(), noise.size());
+    CHECK(!meter.voiceActive());
+    meter.process(speech.data(), speech.size());
+    CHECK(!meter.voiceActive());
+    meter.process(speech.data(), speech.size());
+    CHECK(meter.voiceActive() && meter.takeVadChange());
+    CHECK(!meter.takeVadChange());
+    int frames = 0;
+    while (meter.voiceActive() && frames < 100)
+    {
+        meter.process(noise.data(), noise.size());
+        frames++;
+    }
+    CHECK(frames == 300 / 20);
+    CHECK(meter.takeVadChange());
+}
+
+int main()
+{
+    testLengthsAndAlignment();
+    testExtremes();
+    testMeter();
+    return checkResult("test_audio_level");
+}
@@ -0,0 +1,266 @@
+#include "BlockMotion.hpp"
+#include "check.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include <vector>
+
+/* BlockMotion kernels and BlockMotionDetector on synthetic NV12 frames. */
+
+// Block threshold of a region at sensitivity 4 with the default
+// motion.block_threshold (20) and motion.sensitivity (1)
+static constexpr int SENSITIVE_THRESHOLD = 20 * (1 + 1) / (1 + 4);
+
+// NV12 frame with padded rows; the detector only reads the Y plane
+struct Nv12Frame
+{
+    int width;
+    int height;
+    int stride;
+    std::vector<uint8_t> data;
+
+    Nv12Frame(int w, int h, int s) : width(w), height(h), stride(s), data((size_t) s * h * 3 / 2, 128) {}
+
+    uint8_t *y(int row) { return &data[(size_t) row * stride]; }
+};
+
+static uint32_t rng = 12345;
+static int noise(int amplitude)
+{
+    rng = rng * 1664525 + 1013904223;
+    return (int) ((rng >> 16) % (2 * amplitude + 1)) - amplitude;
+}
+
+// Uniform scene at 'level' with +-'jitter' sensor noise, plus an optional
+// bright square
+static void render(Nv12Frame &frame, int level, int jitter, int squareX = -1, int squareY = -1, int squareSize = 0)
+{
+    for (int row = 0; row < frame.height; row++)
+    {
+        uint8_t *y = frame.y(row);
+        for (int x = 0; x < frame.width; x++)
+        {
+            int v = level + (jitter ? noise(jitter) : 0);
+            if (squareX >= 0 && x >= squareX && x < squareX + squareSize && row >= squareY && row < squareY + squareSize)
+                v = 240;
+            y[x] = (uint8_t) std::clamp(v, 0, 255);
+        }
+        // stride padding that must be ignored
+        std::fill(y + frame.width, y + frame.stride, 0xee);
+    }
+}
+
+static int maxActivity(const BlockMotionDetector &detector)
+{
+    const auto &grid = detector.activity();
+    return *std::max_element(grid.begin(), grid.end());
+}
+
+// Every average rounded towards cur
+static uint8_t referenceBlend(int b, int c)
+{
+    double target = b + (c - b) / 8.0;
+    int r = (c > b) ? (int) std::ceil(target) : (int) std::floor(target);
+    return (uint8_t) r;
+}
+
+static void testBlendKernel()
+{
+    // every (bg, cur) pair, in lengths that leave SIMD tails
+    std::vector<uint8_t> bg(256 * 256), cur(256 * 256);
+    for (int b = 0; b < 256; b++)
+    {
+        for (int c = 0; c < 256; c++)
+        {
+            bg[b * 256 + c] = (uint8_t) b;
+            cur[b * 256 + c] = (uint8_t) c;
+        }
+    }
+    const size_t lengths[] = {bg.size(), 17, 31, 3};
+    for (size_t length : lengths)
+    {
+        std::vector<uint8_t> out(bg.begin(), bg.begin() + length);
+        BlockMotion::blendBackground(out.data(), cur.data(), length);
+
+        int wrong = 0;
+        for (size_t i = 0; i < length; i++)
+        {
+            int b = bg[i], c = cur[i], r = out[i];
+            // moves towards cur by at least one level, by about 1/8 of the gap
+            if (c != b && (r == b || std::abs(r - c) >= std::abs(b - c)))
+                wrong++;
+            if (c == b && r != b)
+                wrong++;
+            if (std::abs(r - referenceBlend(b, c)) > 1)
+                wrong++;
+        }
+        CHECK(wrong == 0);
+    }
+
+    // brightening and darkening are mirror images
+    std::vector<uint8_t> nbg(bg.size()), ncur(cur.size()), out(bg);
+    for (size_t i = 0; i < bg.size(); i++)
+    {
+        nbg[i] = 255 - bg[i];
+        ncur[i] = 255 - cur[i];
+    }
+    BlockMotion::blendBackground(out.data(), cur.data(), out.size());
+    BlockMotion::blendBackground(nbg.data(), ncur.data(), nbg.size());
+    int asymmetric = 0;
+    for (size_t i = 0; i < out.size(); i++)
+        asymmetric += out[i] != 255 - nbg[i];
+    CHECK(asymmetric == 0);
+}
+
+// The background must settle exactly on a static scene, from above and below
+static void testBlendConverges()
+{
+    const int pairs[][2] = {{120, 100}, {200, 0}, {100, 120}, {0, 255}, {255, 0}, {101, 100}};
+    for (auto &pair : pairs)
+    {
+        uint8_t bg[19], cur[19];
+        std::fill(bg, bg + 19, (uint8_t) pair[0]);
+        std::fill(cur, cur + 19, (uint8_t) pair[1]);
+
+        int frames = 0;
+        while (frames < 100 && !std::all_of(bg, bg + 19, [&](uint8_t v) { return v == pair[1]; }))
+        {
+            BlockMotion::blendBackground(bg, cur, 19);
+            frames++;
+        }
+        CHECK(frames < 100);
+        CHECK(bg[0] == pair[1] && bg[16] == pair[1] && bg[18] == pair[1]);
+    }
+}
+
+static void testSadKernel()
+{
+    std::vector<uint8_t> a(8 * 41), b(8 * 41);
+    for (size_t i = 0; i < a.size(); i++)
+    {
+        a[i] = (uint8_t) (noise(127) + 128);
+        b[i] = (uint8_t) (noise(127) + 128);
+    }
+    a[0] = 0;
+    b[0] = 255;
+
+    const size_t groupCounts[] = {41, 40, 1};
+    for (size_t groups : groupCounts)
+    {
+        std::vector<uint32_t> sums(groups, 7);
+        BlockMotion::accumulateSad8(a.data(), b.data(), groups, sums.data());
+        for (size_t g = 0; g < groups; g++)
+        {
+            uint32_t expect = 7;
+            for (int i = 0; i < 8; i++)
+                expect += std::abs(a[g * 8 + i] - b[g * 8 + i]);
+            CHECK(sums[g] == expect);
+        }
+    }
+}
+
+// The scene steps darker (lights dimming, a cloud) and then stays: after a
+// few seconds no block may stay active, even at the lowest threshold in use
+static void testStepDarker()
+{
+    const int steps[][2] = {{120, 100}, {200, 40}, {100, 120}};
+    for (auto &step : steps)
+    {
+        Nv12Frame frame(320, 180, 336);
+        BlockMotionDetector detector;
+        detector.reset(frame.width, frame.height, 16);
+
+        render(frame, step[0], 1);
+        CHECK(!detector.process(frame.y(0), frame.stride));
+        for (int i = 0; i < 10; i++)
+        {
+            render(frame, step[0], 1);
+            CHECK(detector.process(frame.y(0), frame.stride));
+        }
+        CHECK(maxActivity(detector) < SENSITIVE_THRESHOLD);
+
+        render(frame, step[1], 1);
+        detector.process(frame.y(0), frame.stride);
+        CHECK(detector.countActive(SENSITIVE_THRESHOLD, 0, 0, frame.width, frame.height) ==
+              detector.gridWidth() * detector.gridHeight());
+
+        // 3 s at 20 fps
+        for (int i = 0; i < 60; i++)
+        {
+            render(frame, step[1], 1);
+            detector.process(frame.y(0), frame.stride);
+        }
+        // only the +-1 noise is left
+        CHECK(maxActivity(detector) <= 1);
+        CHECK(detector.countActive(SENSITIVE_THRESHOLD, 0, 0, frame.width, frame.height) == 0);
+    }
+}
+
+// A bright square moving over a static, noisy scene
+static void testMovingObject()
+{
+    Nv12Frame frame(320, 180, 320);
+    BlockMotionDetector detector;
+    detector.reset(frame.width, frame.height, 16);
+
+    for (int i = 0; i < 20; i++)
+    {
+        render(frame, 80, 2);
+        detector.process(frame.y(0), frame.stride);
+    }
+    CHECK(detector.countActive(SENSITIVE_THRESHOLD, 0, 0, frame.width, frame.height) == 0);
+
+    // 32 x 32 at (64..96, 48..80) is exactly 2 x 2 blocks
+    render(frame, 80, 2, 64, 48, 32);
+    detector.process(frame.y(0), frame.stride);
+    CHECK(detector.countActive(SENSITIVE_THRESHOLD, 0, 0, frame.width, frame.height) == 4);
+    CHECK(detector.countActive(SENSITIVE_THRESHOLD, 64, 48, 96, 80) == 4);
+    CHECK(detector.countActive(SENSITIVE_THRESHOLD, 160, 0, 320, 180) == 0);
+
+    int x0 = 0, y0 = 0, x1 = frame.width, y1 = frame.height;
+    CHECK(detector.activeBounds(SENSITIVE_THRESHOLD, x0, y0, x1, y1));
+    CHECK(x0 == 64 && y0 == 48 && x1 == 96 && y1 == 80);
+
+    // move it one block to the right: old and new position both differ
+    render(frame, 80, 2, 80, 48, 32);
+    detector.process(frame.y(0), frame.stride);
+    CHECK(detector.countActive(SENSITIVE_THRESHOLD, 0, 0, frame.width, frame.height) == 6);
+
+    // it leaves: after the background catches up nothing is active
+    for (int i = 0; i < 60; i++)
+    {
+        render(frame, 80, 2);
+        detector.process(frame.y(0), frame.stride);
+    }
+    CHECK(detector.countActive(SENSITIVE_THRESHOLD, 0, 0, frame.width, frame.height) == 0);
+}
+
+static void testGeometry()
+{
+    BlockMotionDetector detector;
+    detector.reset(330, 190, 32);
+    CHECK(detector.gridWidth() == 10 && detector.gridHeight() == 5);
+    detector.reset(330, 190, 12);
+    CHECK(detector.blockSize() == 16 && detector.gridWidth() == 20 && detector.gridHeight() == 11);
+
+    // only the pixels right/below the last full block change: nothing active
+    Nv12Frame frame(330, 190, 336);
+    render(frame, 50, 0);
+    detector.process(frame.y(0), frame.stride);
+    render(frame, 50, 0, 320, 176, 14);
+    CHECK(detector.process(frame.y(0), frame.stride));
+    CHECK(maxActivity(detector) == 0);
+}
+
+int main()
+{
+    testBlendKernel();
+    testBlendConverges();
+    testSadKernel();
+    testStepDarker();
+    testMovingObject();
+    testGeometry();
+    return checkResult("test_block_motion");
+}
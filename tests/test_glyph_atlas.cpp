@@ -0,0 +1,219 @@
+#include "GlyphAtlas.hpp"
+#include "check.hpp"
+#include "glyphs.hpp"
+
+#include <algorithm>
+#include <cstdint>
+#include <map>
+#include <string>
+#include <vector>
+
+/* GlyphAtlas against the per pixel outline and text drawing it replaced,
+ * and its LRU eviction.
+ */
+
+static const uint8_t TEXT[4] = {0x20, 0xf0, 0xe0, 0x00};
+static const uint8_t STROKE[4] = {0x10, 0x11, 0x12, 0xff};
+
+struct Layout
+{
+    int width;
+    int height;
+};
+
+// Canvas size as OSD::calculateTextSize computes it
+static Layout measure(const char *text, const std::map<char, TestGlyph> &glyphs, int yScale, int outlineSize)
+{
+    int width = 0, height = 0;
+    for (const char *c = text; *c; c++)
+    {
+        auto it = glyphs.find(*c);
+        if (it == glyphs.end())
+            continue;
+        width += it->second.advance + outlineSize * 2;
+        height = std::max(height, it->second.height);
+    }
+    width += 1 + outlineSize;
+    width += width % 2;
+    return {width, height + yScale};
+}
+
+// OSD::drawText on the atlas
+static void atlasDrawText(GlyphAtlas &atlas, uint8_t *image, const char *text, int yScale, int width,
+                          int height, int outlineSize, int clipBegin = 0, int clipEnd = INT_MAX)
+{
+    int penX = 1;
+    int penY = 1;
+    for (; *text; text++)
+    {
+        const GlyphAtlas::Cell *g = atlas.find((unsigned char) *text);
+        if (!g)
+            continue;
+        int x = penX + g->xmin + outlineSize;
+        int y = penY + (yScale + g->ymin);
+        atlas.blit(*g, image, x - outlineSize, y - outlineSize, width, height, clipBegin, clipEnd);
+        penX += g->advance + outlineSize * 2;
+    }
+}
+
+static void addGlyph(GlyphAtlas &atlas, uint32_t codepoint, const TestGlyph &g)
+{
+    atlas.add(codepoint, g.coverage.data(), g.width, g.height, g.advance, g.xmin, g.ymin);
+}
+
+// Same bytes as the old drawing, for every stroke width in use and text
+// where outlines overlap the neighbouring glyphs and the canvas edges
+static void testMatchesLegacy()
+{
+    const char *texts[] = {"2026-10-18 12:34:56", "Uptime: 3d 04:05", "WMW%&@#", "i.l:1", "x"};
+    const int fontSizes[] = {12, 18, 24, 36};
+
+    for (int fontSize : fontSizes)
+    {
+        std::map<char, TestGlyph> glyphs;
+        for (int c = 32; c < 127; c++)
+            glyphs[(char) c] = makeGlyph(c, fontSize);
+        // a glyph without coverage, like the space
+        glyphs[' '].coverage.assign(glyphs[' '].coverage.size(), 0);
+
+        for (int stroke = 0; stroke <= 4; stroke++)
+        {
+            GlyphAtlas atlas;
+            atlas.reset(TEXT, STROKE, stroke, 1 << 24);
+            std::map<char, LegacyGlyph> legacy;
+            for (auto &entry : glyphs)
+            {
+                addGlyph(atlas, (unsigned char) entry.first, entry.second);
+                legacy[entry.first] = legacyGlyph(entry.second, TEXT);
+            }
+
+            for (const char *text : texts)
+            {
+                Layout size = measure(text, glyphs, fontSize, stroke);
+                std::vector<uint8_t> expect((size_t) size.width * size.height * 4, 0);
+                std::vector<uint8_t> got(expect);
+
+                legacyDrawText(expect.data(), text, legacy, fontSize, STROKE, size.width, size.height, stroke);
+                atlas.beginUpdate();
+                atlasDrawText(atlas, got.data(), text, fontSize, size.width, size.height, stroke);
+                CHECK(got == expect);
+
+                // Redrawing a column range over a cleared band gives the
+                // same columns as the full drawing
+                int clipBegin = size.width / 3, clipEnd = size.width / 2 + 3;
+                std::vector<uint8_t> band(got);
+                for (int y = 0; y < size.height; y++)
+                    std::fill(&band[((size_t) y * size.width + clipBegin) * 4],
+                              &band[((size_t) y * size.width + clipEnd) * 4], 0);
+                atlasDrawText(atlas, band.data(), text, fontSize, size.width, size.height, stroke, clipBegin,
+                              clipEnd);
+                CHECK(band == expect);
+            }
+        }
+    }
+}
+
+static std::vector<uint8_t> render(GlyphAtlas &atlas, uint32_t codepoint)
+{
+    const GlyphAtlas::Cell *cell = atlas.find(codepoint);
+    if (!cell)
+        return {};
+    std::vector<uint8_t> image((size_t) cell->cellWidth * cell->cellHeight * 4, 0);
+    atlas.blit(*cell, image.data(), 0, 0, cell->cellWidth, cell->cellHeight);
+    return image;
+}
+
+static void testEviction()
+{
+    const int stroke = 2;
+    std::map<uint32_t, TestGlyph> glyphs;
+    for (uint32_t c = 0x400; c < 0x440; c++)
+        glyphs[c] = makeGlyph(c, 24);
+
+    // Reference images from an atlas that never evicts
+    GlyphAtlas reference;
+    reference.reset(TEXT, STROKE, stroke, 1 << 24);
+    std::map<uint32_t, std::vector<uint8_t>> images;
+    for (auto &entry : glyphs)
+    {
+        addGlyph(reference, entry.first, entry.second);
+        images[entry.first] = render(reference, entry.first);
+    }
+    size_t perGlyph = reference.bytes() / reference.size();
+
+    // Room for about 16 glyphs
+    GlyphAtlas atlas;
+    size_t budget = perGlyph * 16;
+    atlas.reset(TEXT, STROKE, stroke, budget);
+
+    // An earlier text: 0x400..0x40b, with 0x401 and 0x402 used again later
+    atlas.beginUpdate();
+    for (uint32_t c = 0x400; c < 0x40c; c++)
+        addGlyph(atlas, c, glyphs[c]);
+    atlas.find(0x401);
+    atlas.find(0x402);
+    CHECK(atlas.evictions() == 0);
+
+    // The text being drawn now pins 0x400, 0x405 and 0x40b, then brings in
+    // enough new glyphs to go over the budget
+    atlas.beginUpdate();
+    const uint32_t pinned[] = {0x400, 0x405, 0x40b};
+    for (uint32_t c : pinned)
+        CHECK(atlas.find(c) != nullptr);
+    for (uint32_t c = 0x420; c < 0x428; c++)
+        addGlyph(atlas, c, glyphs[c]);
+
+    CHECK(atlas.evictions() > 0);
+    CHECK(atlas.bytes() <= budget);
+
+    // Pinned and just added glyphs survive eviction, and compaction keeps
+    // their pixels and spans intact
+    for (uint32_t c : pinned)
+        CHECK(render(atlas, c) == images[c]);
+    for (uint32_t c = 0x420; c < 0x428; c++)
+        CHECK(render(atlas, c) == images[c]);
+
+    // The least recently used go first: 0x403 and 0x404 before 0x401 and
+    // 0x402, which were used after them
+    CHECK(atlas.find(0x403) == nullptr);
+    CHECK(atlas.find(0x404) == nullptr);
+    size_t survivors = 0;
+    for (uint32_t c = 0x400; c < 0x40c; c++)
+    {
+        std::vector<uint8_t> image = render(atlas, c);
+        if (!image.empty())
+        {
+            CHECK(image == images[c]);
+            survivors++;
+        }
+    }
+    CHECK(survivors + atlas.evictions() == 12);
+    CHECK(atlas.size() == survivors + 8);
+
+    // A text that needs more glyphs than the budget holds: nothing it uses
+    // is dropped while it is drawn, the atlas grows past the budget instead
+    atlas.beginUpdate();
+    for (uint32_t c = 0x400; c < 0x440; c++)
+    {
+        if (!atlas.find(c))
+            addGlyph(atlas, c, glyphs[c]);
+    }
+    int missing = 0;
+    for (uint32_t c = 0x400; c < 0x440; c++)
+        missing += render(atlas, c) != images[c];
+    CHECK(missing == 0);
+    CHECK(atlas.size() == 0x40);
+
+    // and it shrinks back on the next text
+    atlas.beginUpdate();
+    addGlyph(atlas, 0x440, makeGlyph(0x440, 24));
+    CHECK(atlas.bytes() <= budget);
+    CHECK(atlas.find(0x440) != nullptr);
+}
+
+int main()
+{
+    testMatchesLegacy();
+    testEviction();
+    return checkResult("test_glyph_atlas");
+}
@@ -0,0 +1,225 @@
+#include "ImageRotate.hpp"
+#include "check.hpp"
+
+#include <algorithm>
+#include <climits>
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include <vector>
+
+/* Golden images for ImageRotate::rotateBGRA.
+ *
+ * Every test pixel encodes its 1-based source index (low byte in B, low byte
+ * xor 0x5a in G, high bits in R, opaque A), so a golden image can be written
+ * as a grid of source indices (0 = transparent) and a channel mix-up is
+ * caught too.
+ */
+
+static void setPixel(uint8_t *px, int index)
+{
+    px[0] = (uint8_t) index;
+    px[1] = (uint8_t) (index ^ 0x5a);
+    px[2] = (uint8_t) (0x80 | (index >> 8));
+    px[3] = 0xff;
+}
+
+static std::vector<uint8_t> makeImage(int width, int height)
+{
+    std::vector<uint8_t> image(width * height * 4);
+    for (int i = 0; i < width * height; i++)
+        setPixel(&image[i * 4], i + 1);
+    return image;
+}
+
+static std::vector<uint8_t> fromIndices(const std::vector<int> &indices)
+{
+    std::vector<uint8_t> image(indices.size() * 4, 0);
+    for (size_t i = 0; i < indices.size(); i++)
+    {
+        if (indices[i])
+            setPixel(&image[i * 4], indices[i]);
+    }
+    return image;
+}
+
+static void checkGolden(int width, int height, int angle, int expectWidth, int expectHeight,
+                        const std::vector<int> &expect)
+{
+    auto input = makeImage(width, height);
+    uint16_t w = width, h = height;
+    std::vector<uint8_t> output;
+    ImageRotate::rotateBGRA(input.data(), w, h, angle, output);
+
+    CHECK(w == expectWidth && h == expectHeight);
+    CHECK(output == fromIndices(expect));
+}
+
+static void testRightAngles()
+{
+    // 4 x 3 source:
+    //   1  2  3  4
+    //   5  6  7  8
+    //   9 10 11 12
+    checkGolden(4, 3, 0, 4, 3, {
+        1, 2, 3, 4,
+        5, 6, 7, 8,
+        9, 10, 11, 12,
+    });
+    checkGolden(4, 3, 90, 3, 4, {
+        9, 5, 1,
+        10, 6, 2,
+        11, 7, 3,
+        12, 8, 4,
+    });
+    checkGolden(4, 3, 180, 4, 3, {
+        12, 11, 10, 9,
+        8, 7, 6, 5,
+        4, 3, 2, 1,
+    });
+    checkGolden(4, 3, 270, 3, 4, {
+        4, 8, 12,
+        3, 7, 11,
+        2, 6, 10,
+        1, 5, 9,
+    });
+
+    // angles are taken modulo 360
+    checkGolden(4, 3, -90, 3, 4, {
+        4, 8, 12,
+        3, 7, 11,
+        2, 6, 10,
+        1, 5, 9,
+    });
+    checkGolden(4, 3, 450, 3, 4, {
+        9, 5, 1,
+        10, 6, 2,
+        11, 7, 3,
+        12, 8, 4,
+    });
+}
+
+static void testArbitraryAngle()
+{
+    // Nearest source pixel, truncated toward the centre, in the 5 x 5
+    // bounding box; corners the rotated image does not cover are transparent
+    checkGolden(4, 3, 45, 5, 5, {
+        5, 5, 2, 0, 0,
+        5, 6, 7, 3, 0,
+        10, 7, 7, 7, 4,
+        0, 11, 7, 8, 0,
+        0, 0, 12, 0, 0,
+    });
+}
+
+// Quarter turns are blocked over 16 x 16 tiles; sizes that are not a
+// multiple of the tile must round trip exactly
+static void testRoundTrips()
+{
+    const int sizes[][2] = {{1, 1}, {17, 5}, {242, 30}, {33, 47}};
+    for (auto &size : sizes)
+    {
+        auto input = makeImage(size[0], size[1]);
+        std::vector<uint8_t> a, b;
+
+        uint16_t w = size[0], h = size[1];
+        ImageRotate::rotateBGRA(input.data(), w, h, 90, a);
+        CHECK(w == size[1] && h == size[0]);
+        ImageRotate::rotateBGRA(a.data(), w, h, 270, b);
+        CHECK(w == size[0] && h == size[1]);
+        CHECK(b == input);
+
+        ImageRotate::rotateBGRA(input.data(), w, h, 180, a);
+        ImageRotate::rotateBGRA(a.data(), w, h, 180, b);
+        CHECK(b == input);
+
+        // four quarter turns
+        b = input;
+        for (int i = 0; i < 4; i++)
+        {
+            ImageRotate::rotateBGRA(b.data(), w, h, 90, a);
+            b.swap(a);
+        }
+        CHECK(w == size[0] && h == size[1]);
+        CHECK(b == input);
+    }
+}
+
+// The fixed point stepping against the per pixel floating point mapping it
+// replaced: same size, at least 98% identical pixels, and where they differ
+// (a coordinate right on an integer boundary) only by one source pixel
+static void testMatchesFloatingPoint()
+{
+    const int angles[] = {1, 15, 30, 45, 60, 135, 200, 315, 359};
+    const int width = 64, height = 24;
+    auto input = makeImage(width, height);
+
+    for (int angle : angles)
+    {
+        uint16_t w = width, h = height;
+        std::vector<uint8_t> output;
+        ImageRotate::rotateBGRA(input.data(), w, h, angle, output);
+
+        double a = angle * (M_PI / 180.0);
+        int corners[4][2] = {{0, 0}, {width, 0}, {0, height}, {width, height}};
+        int minX = INT_MAX, maxX = INT_MIN, minY = INT_MAX, maxY = INT_MIN;
+        for (auto &c : corners)
+        {
+            int x = (int) (c[0] * cos(a) - c[1] * sin(a));
+            int y = (int) (c[0] * sin(a) + c[1] * cos(a));
+            minX = std::min(minX, x);
+            maxX = std::max(maxX, x);
+            minY = std::min(minY, y);
+            maxY = std::max(maxY, y);
+        }
+        int newWidth = maxX - minX + 1, newHeight = maxY - minY + 1;
+        CHECK(w == newWidth && h == newHeight);
+        if (w != newWidth || h != newHeight)
+            continue;
+
+        int same = 0, far = 0;
+        for (int y = 0; y < newHeight; y++)
+        {
+            for (int x = 0; x < newWidth; x++)
+            {
+                int nx = x - newWidth / 2, ny = y - newHeight / 2;
+                int ox = (int) (nx * cos(a) + ny * sin(a)) + width / 2;
+                int oy = (int) (-nx * sin(a) + ny * cos(a)) + height / 2;
+                bool inside = ox >= 0 && ox < width && oy >= 0 && oy < height;
+
+                const uint8_t *px = &output[(y * newWidth + x) * 4];
+                int index = px[3] ? (px[0] | (px[2] & 0x7f) << 8) : 0;
+                if (index == (inside ? oy * width + ox + 1 : 0))
+                {
+                    same++;
+                    continue;
+                }
+
+                // off by one: a neighbouring pixel, or transparent against
+                // a pixel on the border
+                bool near;
+                if (index)
+                {
+                    int sx = (index - 1) % width, sy = (index - 1) / width;
+                    near = std::abs(sx - ox) <= 1 && std::abs(sy - oy) <= 1;
+                }
+                else
+                {
+                    near = ox >= -1 && ox <= width && oy >= -1 && oy <= height;
+                }
+                far += !near;
+            }
+        }
+        CHECK(far == 0);
+        CHECK(same >= newWidth * newHeight * 98 / 100);
+    }
+}
+
+int main()
+{
+    testRightAngles();
+    testArbitraryAngle();
+    testRoundTrips();
+    testMatchesFloatingPoint();
+    return checkResult("test_image_rotate");
+}
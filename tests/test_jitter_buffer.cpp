@@ -0,0 +1,287 @@
+#include "JitterBuffer.hpp"
+#include "check.hpp"
+
+#include <chrono>
+#include <cstdint>
+#include <vector>
+
+/* JitterBuffer on a simulated clock: 8 kHz RTP clock, 20 ms (160 tick)
+ * packets, 60 ms target delay unless a test says otherwise.
+ */
+
+using Clock = JitterBuffer::Clock;
+using Result = JitterBuffer::Result;
+using std::chrono::milliseconds;
+
+static constexpr unsigned RATE = 8000;
+static constexpr uint32_t TICKS = 160;
+static const Clock::time_point T0 = Clock::time_point() + std::chrono::hours(1);
+
+static Clock::time_point at(int ms)
+{
+    return T0 + milliseconds(ms);
+}
+
+// Payloads carry their sequence number, so the order can be checked
+static bool push(JitterBuffer &jb, uint16_t seq, uint32_t timestamp, int arrivalMs)
+{
+    std::vector<uint8_t> payload = {(uint8_t) (seq >> 8), (uint8_t) seq, 0xa5};
+    return jb.push(seq, timestamp, payload, at(arrivalMs));
+}
+
+static int seqOf(const std::vector<uint8_t> &payload)
+{
+    return payload.size() == 3 && payload[2] == 0xa5 ? (payload[0] << 8 | payload[1]) : -1;
+}
+
+// Pop once at 'ms': the sequence number of a packet, -1 for None, -2 for Lost
+static int popAt(JitterBuffer &jb, int ms)
+{
+    std::vector<uint8_t> payload;
+    Result r = jb.pop(at(ms), payload);
+    if (r == Result::Packet)
+        return seqOf(payload);
+    return r == Result::Lost ? -2 : -1;
+}
+
+// Packets are due a fixed offset from their RTP timestamp, not from their
+// arrival: the first plays 60 ms after it arrives, the others 20 ms apart
+static void testDueTime()
+{
+    JitterBuffer jb;
+    jb.configure(RATE, 60, 200);
+
+    CHECK(jb.nextDue() == Clock::time_point::max());
+    CHECK(push(jb, 100, 5000, 0));
+    CHECK(jb.nextDue() == at(60));
+    CHECK(popAt(jb, 59) == -1);
+    CHECK(popAt(jb, 60) == 100);
+
+    // early and late arrivals within the delay do not move the due time
+    CHECK(push(jb, 101, 5000 + TICKS, 5));
+    CHECK(push(jb, 102, 5000 + 2 * TICKS, 75));
+    CHECK(jb.nextDue() == at(80));
+    CHECK(popAt(jb, 79) == -1);
+    CHECK(popAt(jb, 80) == 101);
+    CHECK(popAt(jb, 99) == -1);
+    CHECK(popAt(jb, 100) == 102);
+    CHECK(jb.empty());
+    CHECK(jb.stats().lost == 0 && jb.stats().late == 0);
+}
+
+// Sequence numbers and timestamps both wrap: 65534, 65535, 0, 1, ...
+static void testWrap()
+{
+    JitterBuffer jb;
+    jb.configure(RATE, 60, 200);
+
+    const uint16_t first = 65530;
+    const uint32_t firstTs = 0xffffffffu - 2 * TICKS;
+    int popped = 0, expectSeq = first;
+    for (int i = 0; i < 14; i++)
+    {
+        uint16_t seq = (uint16_t) (first + i);
+        CHECK(push(jb, seq, firstTs + i * TICKS, i * 20));
+        int got;
+        while ((got = popAt(jb, i * 20)) != -1)
+        {
+            CHECK(got == (uint16_t) expectSeq);
+            expectSeq++;
+            popped++;
+        }
+    }
+    // the last three are still within the 60 ms delay
+    CHECK(popped == 11);
+    CHECK(jb.depth() == 3);
+    CHECK(jb.nextDue() == at(13 * 20 - 40 + 60));
+    while (popAt(jb, 1000) >= 0)
+        popped++;
+    CHECK(popped == 14);
+    CHECK(jb.stats().lost == 0 && jb.stats().reordered == 0 && jb.stats().late == 0);
+    CHECK(jb.stats().received == 14);
+
+    // across the wrap, late and reordered still work on the extended numbers
+    JitterBuffer jb2;
+    jb2.configure(RATE, 60, 200);
+    CHECK(push(jb2, 65535, 0, 0));
+    CHECK(push(jb2, 1, 2 * TICKS, 1));
+    CHECK(push(jb2, 0, TICKS, 2));
+    CHECK(jb2.stats().reordered == 1);
+    CHECK(popAt(jb2, 60) == 65535);
+    CHECK(popAt(jb2, 80) == 0);
+    CHECK(popAt(jb2, 100) == 1);
+    CHECK(!push(jb2, 65535, 0, 110));
+    CHECK(jb2.stats().late == 1 && jb2.stats().lost == 0);
+}
+
+// Packets swapped in the network come out in order if they arrive before
+// they are due
+static void testReorder()
+{
+    JitterBuffer jb;
+    jb.configure(RATE, 60, 200);
+
+    CHECK(push(jb, 10, 0, 0));
+    CHECK(push(jb, 12, 2 * TICKS, 20));
+    CHECK(push(jb, 14, 4 * TICKS, 30));
+    CHECK(push(jb, 11, TICKS, 40));
+    CHECK(push(jb, 13, 3 * TICKS, 50));
+    CHECK(jb.stats().reordered == 2);
+    CHECK(jb.depth() == 5);
+    CHECK(jb.depthMs() == 100);
+
+    for (int seq = 10; seq <= 14; seq++)
+        CHECK(popAt(jb, 60 + (seq - 10) * 20) == seq);
+    CHECK(jb.stats().lost == 0);
+
+    // a duplicate is dropped
+    CHECK(push(jb, 15, 5 * TICKS, 150));
+    CHECK(!push(jb, 15, 5 * TICKS, 151));
+    CHECK(jb.stats().duplicate == 1);
+    CHECK(jb.depth() == 1);
+}
+
+// A packet missing at its due time is concealed; when it shows up after
+// that it is late and dropped
+static void testLossAndLate()
+{
+    JitterBuffer jb;
+    jb.configure(RATE, 60, 200);
+
+    CHECK(push(jb, 1, 0, 0));
+    CHECK(push(jb, 2, TICKS, 20));
+    CHECK(push(jb, 4, 3 * TICKS, 60));
+    CHECK(popAt(jb, 60) == 1);
+    CHECK(popAt(jb, 80) == 2);
+    CHECK(popAt(jb, 99) == -1);
+    CHECK(popAt(jb, 100) == -2);
+    CHECK(jb.stats().lost == 1);
+
+    CHECK(!push(jb, 3, 2 * TICKS, 101));
+    CHECK(jb.stats().late == 1);
+    CHECK(popAt(jb, 120) == 4);
+    CHECK(jb.empty());
+
+    // Running dry: up to MAX_CONCEAL concealments, then playout stops and
+    // the tail of the talk spurt is not counted as lost
+    for (unsigned i = 0; i < JitterBuffer::MAX_CONCEAL; i++)
+        CHECK(popAt(jb, 140 + 20 * i) == -2);
+    CHECK(popAt(jb, 200) == -1);
+    CHECK(jb.stats().underruns == 1);
+    CHECK(jb.stats().lost == 1);
+    CHECK(jb.nextDue() == Clock::time_point::max());
+
+    // the next spurt re-buffers: due again 60 ms after it arrives
+    CHECK(push(jb, 8, 19 * TICKS, 500));
+    CHECK(popAt(jb, 559) == -1);
+    CHECK(popAt(jb, 560) == 8);
+    CHECK(jb.stats().lost == 1);
+
+    // while still playing, what was concealed before the next packet
+    // arrived was really lost
+    CHECK(popAt(jb, 580) == -2);
+    CHECK(push(jb, 10, 21 * TICKS, 585));
+    CHECK(jb.stats().lost == 2);
+    CHECK(popAt(jb, 600) == 10);
+
+    // a gap in the sequence numbers across a re-buffer is loss as well
+    for (unsigned i = 0; i < JitterBuffer::MAX_CONCEAL; i++)
+        CHECK(popAt(jb, 620 + 20 * i) == -2);
+    CHECK(popAt(jb, 680) == -1);
+    CHECK(jb.stats().underruns == 2 && jb.stats().lost == 2);
+    CHECK(push(jb, 20, 40 * TICKS, 1000));
+    CHECK(jb.stats().lost == 2 + (20 - 14));
+}
+
+// The ring holds 128 packets; anything further ahead pushes the oldest out
+static void testOverflow()
+{
+    JitterBuffer jb;
+    // a max delay long enough that only the ring size limits the depth
+    jb.configure(RATE, 60, 10000);
+
+    for (int seq = 0; seq < 200; seq++)
+        CHECK(push(jb, (uint16_t) (1000 + seq), seq * TICKS, 0));
+    CHECK(jb.depth() == JitterBuffer::CAPACITY);
+    CHECK(jb.stats().overflow == 200 - JitterBuffer::CAPACITY);
+    CHECK(jb.stats().lost == 0);
+
+    // the oldest kept packet plays at its own timestamp's due time
+    const int firstKept = 200 - (int) JitterBuffer::CAPACITY;
+    CHECK(jb.nextDue() == at(60 + firstKept * 20));
+    int expect = 1000 + firstKept, wrong = 0;
+    for (int i = 0; i < (int) JitterBuffer::CAPACITY; i++)
+        wrong += popAt(jb, 60 + (firstKept + i) * 20) != expect++;
+    CHECK(wrong == 0);
+    CHECK(jb.empty());
+
+    // A burst beyond the max delay is trimmed back to the target delay and
+    // the playout clock restarts there
+    JitterBuffer trimmed;
+    trimmed.configure(RATE, 60, 200);
+    for (int seq = 0; seq < 20; seq++)
+        CHECK(push(trimmed, (uint16_t) seq, seq * TICKS, 0));
+    CHECK(trimmed.stats().overflow > 0);
+    CHECK(trimmed.depthMs() <= 60 + 20);
+    CHECK(trimmed.depth() + trimmed.stats().overflow == 20);
+    CHECK(trimmed.nextDue() == at(0));
+    int oldest = 20 - (int) trimmed.depth();
+    CHECK(popAt(trimmed, 0) == oldest);
+}
+
+// On stop, drain() hands out everything still buffered, in order and
+// regardless of due time, skipping gaps
+static void testDrain()
+{
+    JitterBuffer jb;
+    jb.configure(RATE, 60, 200);
+
+    CHECK(push(jb, 7, 0, 0));
+    CHECK(push(jb, 9, 2 * TICKS, 1));
+    CHECK(push(jb, 8, TICKS, 2));
+    CHECK(push(jb, 11, 4 * TICKS, 3));
+
+    std::vector<uint8_t> payload;
+    const int expect[] = {7, 8, 9, 11};
+    for (int seq : expect)
+    {
+        CHECK(jb.drain(payload));
+        CHECK(seqOf(payload) == seq);
+    }
+    CHECK(!jb.drain(payload));
+    CHECK(jb.empty());
+    CHECK(popAt(jb, 1000) == -1);
+    CHECK(jb.nextDue() == Clock::time_point::max());
+
+    // draining an empty buffer is harmless
+    JitterBuffer idle;
+    idle.configure(RATE, 60, 200);
+    CHECK(!idle.drain(payload));
+}
+
+// A sender restart (large sequence jump) starts over instead of
+// concealing thousands of packets
+static void testResync()
+{
+    JitterBuffer jb;
+    jb.configure(RATE, 60, 200);
+
+    CHECK(push(jb, 100, 0, 0));
+    CHECK(popAt(jb, 60) == 100);
+    CHECK(push(jb, 30000, 777777, 70));
+    CHECK(jb.stats().lost == 0);
+    CHECK(popAt(jb, 129) == -1);
+    CHECK(popAt(jb, 130) == 30000);
+}
+
+int main()
+{
+    testDueTime();
+    testWrap();
+    testReorder();
+    testLossAndLate();
+    testOverflow();
+    testDrain();
+    testResync();
+    return checkResult("test_jitter_buffer");
+}
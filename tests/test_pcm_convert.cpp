@@ -0,0 +1,56 @@
+#include "PcmConvert.hpp"
+#include "check.hpp"
+
+#include <cstdint>
+#include <vector>
+
+// Straightforward reference the kernel must match
+static void reference(const int16_t *in, int16_t *out, size_t samples)
+{
+    for (size_t i = 0; i < samples; i++)
+    {
+        out[2 * i] = in[i];
+        out[2 * i + 1] = in[i];
+    }
+}
+
+static void testLengthsAndAlignment()
+{
+    std::vector<int16_t> in(80);
+    uint32_t seed = 1;
+    for (auto &v : in)
+    {
+        seed = seed * 1664525 + 1013904223;
+        v = (int16_t) (seed >> 16);
+    }
+    // full range extremes must survive the interleave unchanged
+    in[0] = INT16_MIN;
+    in[1] = INT16_MAX;
+    in[2] = -1;
+
+    // every tail length around the 8 sample vectors, and misaligned
+    // input and output pointers
+    for (size_t samples = 0; samples <= 67; samples++)
+    {
+        for (size_t inOffset = 0; inOffset < 3; inOffset++)
+        {
+            for (size_t outOffset = 0; outOffset < 3; outOffset++)
+            {
+                // guard elements either side catch out of bounds writes
+                std::vector<int16_t> expect(2 * samples + outOffset + 2, 0x5a5a);
+                std::vector<int16_t> got(expect);
+
+                reference(in.data() + inOffset, expect.data() + outOffset + 1, samples);
+                PcmConvert::monoToStereo16(in.data() + inOffset, got.data() + outOffset + 1, samples);
+
+                CHECK(got == expect);
+            }
+        }
+    }
+}
+
+int main()
+{
+    testLengthsAndAlignment();
+    return checkResult("test_pcm_convert");
+}
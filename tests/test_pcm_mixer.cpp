@@ -0,0 +1,117 @@
+#include "PcmMixer.hpp"
+#include "check.hpp"
+
+#include <climits>
+#include <cstdint>
+#include <vector>
+
+// Straightforward reference the kernel must match
+static int16_t reference(int16_t a, int16_t b)
+{
+    int32_t sum = (int32_t) a + b;
+    if (sum > INT16_MAX)
+        return INT16_MAX;
+    if (sum < INT16_MIN)
+        return INT16_MIN;
+    return (int16_t) sum;
+}
+
+// Sums just past either end saturate instead of wrapping, in every lane
+static void testSaturation()
+{
+    const int16_t pairs[][3] = {
+        {INT16_MAX, 1, INT16_MAX},         // INT16_MAX + 1
+        {INT16_MIN, -1, INT16_MIN},        // INT16_MIN - 1
+        {INT16_MAX, INT16_MAX, INT16_MAX},
+        {INT16_MIN, INT16_MIN, INT16_MIN},
+        {INT16_MAX, INT16_MIN, -1},
+        {INT16_MAX - 1, 1, INT16_MAX},     // exactly at the limit
+        {INT16_MIN + 1, -1, INT16_MIN},
+        {16384, 16384, INT16_MAX},
+        {-16384, -16385, INT16_MIN},
+        {1000, -3000, -2000},
+    };
+
+    for (auto &pair : pairs)
+    {
+        // 8 sample vectors and the scalar tail
+        for (size_t samples : {1, 8, 19})
+        {
+            std::vector<int16_t> dst(samples, pair[0]), src(samples, pair[1]);
+            PcmMixer::addSaturate16(dst.data(), src.data(), samples);
+            int wrong = 0;
+            for (int16_t v : dst)
+                wrong += v != pair[2];
+            CHECK(wrong == 0);
+        }
+    }
+}
+
+static void testLengthsAndAlignment()
+{
+    std::vector<int16_t> a(80), b(80);
+    uint32_t seed = 7;
+    for (size_t i = 0; i < a.size(); i++)
+    {
+        seed = seed * 1664525 + 1013904223;
+        a[i] = (int16_t) (seed >> 16);
+        seed = seed * 1664525 + 1013904223;
+        b[i] = (int16_t) (seed >> 16);
+    }
+
+    // every tail length around the 8 sample vectors, and misaligned
+    // buffers
+    for (size_t samples = 0; samples <= 67; samples++)
+    {
+        for (size_t dstOffset = 0; dstOffset < 3; dstOffset++)
+        {
+            for (size_t srcOffset = 0; srcOffset < 3; srcOffset++)
+            {
+                // guard elements either side catch out of bounds writes
+                std::vector<int16_t> expect(samples + dstOffset + 2, 0x5a5a);
+                for (size_t i = 0; i < samples; i++)
+                    expect[dstOffset + 1 + i] = a[i];
+                std::vector<int16_t> got(expect);
+
+                for (size_t i = 0; i < samples; i++)
+                    expect[dstOffset + 1 + i] = reference(a[i], b[srcOffset + i]);
+                PcmMixer::addSaturate16(got.data() + dstOffset + 1, b.data() + srcOffset, samples);
+
+                CHECK(got == expect);
+            }
+        }
+    }
+}
+
+// Four loud talkers summed into one block, as the backchannel mixes them
+static void testMixFour()
+{
+    const size_t samples = 160;
+    std::vector<int16_t> mix(samples, 0);
+    std::vector<int32_t> exact(samples, 0);
+    for (int talker = 0; talker < 4; talker++)
+    {
+        std::vector<int16_t> pcm(samples);
+        for (size_t i = 0; i < samples; i++)
+            pcm[i] = (int16_t) ((int) ((i * 977 + talker * 4099) % 65536) - 32768);
+
+        PcmMixer::addSaturate16(mix.data(), pcm.data(), samples);
+
+        // saturation is applied after every talker, not once at the end
+        for (size_t i = 0; i < samples; i++)
+            exact[i] = reference((int16_t) exact[i], pcm[i]);
+    }
+
+    int wrong = 0;
+    for (size_t i = 0; i < samples; i++)
+        wrong += mix[i] != exact[i];
+    CHECK(wrong == 0);
+}
+
+int main()
+{
+    testSaturation();
+    testLengthsAndAlignment();
+    testMixFour();
+    return checkResult("test_pcm_mixer");
+}
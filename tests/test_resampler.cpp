@@ -0,0 +1,142 @@
+#include "Resampler.hpp"
+#include "check.hpp"
+#include "signal.hpp"
+
+#include <cstdint>
+#include <vector>
+
+// Feed 'in' through the resampler in frames of 'frame' samples
+static std::vector<int16_t> run(Resampler &r, const std::vector<int16_t> &in, size_t frame)
+{
+    std::vector<int16_t> out;
+    for (size_t pos = 0; pos < in.size(); pos += frame)
+    {
+        const auto &block = r.process(in.data() + pos, std::min(frame, in.size() - pos));
+        out.insert(out.end(), block.begin(), block.end());
+    }
+    return out;
+}
+
+static void testConfigure()
+{
+    Resampler r;
+    CHECK(!r.configure(0, 16000));
+    CHECK(!r.configure(16000, -1));
+    CHECK(r.process(nullptr, 0).empty());
+
+    CHECK(r.configure(8000, 16000));
+    CHECK(r.inputRate() == 8000 && r.outputRate() == 16000);
+}
+
+static void testLengthAndFraming()
+{
+    const int rates[][2] = {{8000, 16000}, {16000, 8000}, {16000, 48000}, {48000, 16000}, {44100, 16000}};
+    for (auto &rate : rates)
+    {
+        auto in = tone(440, rate[0], rate[0], 8000);
+
+        Resampler whole;
+        CHECK(whole.configure(rate[0], rate[1]));
+        auto expect = run(whole, in, in.size());
+        CHECK(expect.size() == (size_t) rate[1]);
+
+        // frame boundaries, including odd and single sample frames, must not
+        // change a single output sample
+        const size_t frames[] = {1, 7, 160, 333, 960};
+        for (size_t frame : frames)
+        {
+            Resampler split;
+            CHECK(split.configure(rate[0], rate[1]));
+            CHECK(run(split, in, frame) == expect);
+        }
+
+        // reset() starts over from silence
+        whole.reset();
+        CHECK(run(whole, in, 160) == expect);
+    }
+}
+
+// Pass band: a 1 kHz tone comes out at the same level with little else
+static void testPassBand()
+{
+    const int rates[][2] = {{8000, 16000}, {8000, 48000}, {16000, 48000}, {48000, 16000}, {16000, 8000}};
+    for (auto &rate : rates)
+    {
+        Resampler r;
+        CHECK(r.configure(rate[0], rate[1]));
+        auto out = run(r, tone(1000, rate[0], rate[0], 16384), 160);
+
+        // skip the filter's start up
+        size_t skip = rate[1] / 10;
+        ToneFit fit = fitTone(out.data() + skip, out.size() - skip, 1000, rate[1]);
+        double snr = dB(fit.amplitude / std::sqrt(2.0) / fit.residual);
+        printf("  %5d -> %5d  1 kHz gain %+.2f dB  SNR %.1f dB\n", rate[0], rate[1],
+               dB(fit.amplitude / 16384), snr);
+        CHECK(std::fabs(dB(fit.amplitude / 16384)) < 0.1);
+        CHECK(snr > 80);
+
+        // still flat at the start of the transition band
+        double edge = 0.3 * std::min(rate[0], rate[1]);
+        CHECK(r.configure(rate[0], rate[1]));
+        out = run(r, tone(edge, rate[0], rate[0], 16384), 160);
+        fit = fitTone(out.data() + skip, out.size() - skip, edge, rate[1]);
+        CHECK(std::fabs(dB(fit.amplitude / 16384)) < 0.2);
+    }
+}
+
+/* The filter's transition band runs from about 0.3 to 0.66 of the lower
+ * rate: flat (-0.2 dB) below, at least 70 dB of rejection above.
+ *
+ * Stop band: when decimating, a sweep above the transition band must not
+ * fold back into the output.
+ */
+static void testStopBand(int inRate, int outRate, double limitDb)
+{
+    double startHz = 0.66 * outRate;
+    double worst = -200;
+    for (double f = startHz; f < inRate / 2.0; f += 250)
+    {
+        Resampler r;
+        CHECK(r.configure(inRate, outRate));
+        auto out = run(r, tone(f, inRate, inRate, 16384), 160);
+
+        size_t skip = outRate / 10;
+        double level = dB(rms(out.data() + skip, out.size() - skip) / (16384 / std::sqrt(2.0)));
+        worst = std::max(worst, level);
+    }
+    printf("  %5d -> %5d  sweep %.0f-%d Hz  worst alias %.1f dB\n", inRate, outRate, startHz,
+           inRate / 2, worst);
+    CHECK(worst < limitDb);
+}
+
+// Upsampling: the images of a tone below the transition band, mirrored
+// around the input rate, must be suppressed
+static void testImages(int inRate, int outRate, double limitDb)
+{
+    double worst = -200;
+    for (double f = 250; f <= inRate * 0.34; f += 250)
+    {
+        Resampler r;
+        CHECK(r.configure(inRate, outRate));
+        auto out = run(r, tone(f, inRate, inRate, 16384), 160);
+
+        size_t skip = outRate / 10;
+        ToneFit image = fitTone(out.data() + skip, out.size() - skip, inRate - f, outRate);
+        worst = std::max(worst, dB(image.amplitude / 16384));
+    }
+    printf("  %5d -> %5d  images of 250-%.0f Hz  worst %.1f dB\n", inRate, outRate, inRate * 0.34, worst);
+    CHECK(worst < limitDb);
+}
+
+int main()
+{
+    testConfigure();
+    testLengthAndFraming();
+    testPassBand();
+    testStopBand(48000, 16000, -70);
+    testStopBand(16000, 8000, -70);
+    testStopBand(44100, 16000, -70);
+    testImages(8000, 16000, -70);
+    testImages(16000, 48000, -70);
+    return checkResult("test_resampler");
+}
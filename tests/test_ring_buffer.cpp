@@ -0,0 +1,175 @@
+#include "AudioReframer.hpp"
+#include "RingBuffer.hpp"
+#include "check.hpp"
+
+#include <cstdint>
+#include <numeric>
+#include <vector>
+
+static void testCapacity()
+{
+    CHECK(RingBuffer<int16_t>(1).capacity() == 1);
+    CHECK(RingBuffer<int16_t>(5).capacity() == 8);
+    CHECK(RingBuffer<int16_t>(640).capacity() == 1024);
+    CHECK(RingBuffer<int16_t>(1024).capacity() == 1024);
+}
+
+static void testPushFetchWrap()
+{
+    RingBuffer<int16_t> ring(8);
+    int16_t in[6], out[6];
+    int16_t next = 0, expect = 0;
+
+    // 6 in, 6 out moves the indices across the wrap point on most rounds
+    for (int round = 0; round < 50; round++)
+    {
+        for (auto &v : in)
+            v = next++;
+        CHECK(ring.push(in, 6) == RingStatus::Ok);
+        CHECK(ring.size() == 6 && ring.space() == 2);
+        CHECK(ring.fetch(out, 6) == RingStatus::Ok);
+        for (auto v : out)
+            CHECK(v == expect++);
+        CHECK(ring.isEmpty());
+    }
+}
+
+static void testOverflowUnderflow()
+{
+    RingBuffer<int16_t> ring(4);
+    int16_t data[5] = {1, 2, 3, 4, 5};
+    int16_t out[5] = {};
+
+    CHECK(ring.fetch(out, 1) == RingStatus::Underflow);
+    CHECK(ring.push(data, 5) == RingStatus::Overflow);
+    CHECK(ring.isEmpty());
+
+    CHECK(ring.push(data, 3) == RingStatus::Ok);
+    CHECK(ring.push(data, 2) == RingStatus::Overflow);
+    CHECK(ring.size() == 3);
+    CHECK(ring.fetch(out, 4) == RingStatus::Underflow);
+    CHECK(ring.size() == 3);
+    CHECK(ring.consume(4) == RingStatus::Underflow);
+    CHECK(ring.commit(2) == RingStatus::Overflow);
+
+    // a failed call leaves the contents alone
+    CHECK(ring.fetch(out, 3) == RingStatus::Ok);
+    CHECK(out[0] == 1 && out[1] == 2 && out[2] == 3);
+}
+
+static void testPeekConsume()
+{
+    RingBuffer<int16_t> ring(8);
+    int16_t data[8];
+    std::iota(data, data + 8, 100);
+
+    // put head at 5 so six stored elements are split 3 + 3
+    CHECK(ring.push(data, 5) == RingStatus::Ok);
+    CHECK(ring.consume(5) == RingStatus::Ok);
+    CHECK(ring.push(data, 6) == RingStatus::Ok);
+
+    auto regions = ring.peek(6);
+    CHECK(regions.first.size() == 3 && regions.second.size() == 3);
+    CHECK(regions.size() == 6);
+    for (size_t i = 0; i < 3; i++)
+    {
+        CHECK(regions.first[i] == data[i]);
+        CHECK(regions.second[i] == data[3 + i]);
+    }
+    CHECK(ring.size() == 6);
+
+    // peek is clamped to what is stored
+    CHECK(ring.peek(100).size() == 6);
+
+    CHECK(ring.consume(4) == RingStatus::Ok);
+    CHECK(ring.peek(1).first[0] == data[4]);
+}
+
+static void testReserveCommit()
+{
+    RingBuffer<int16_t> ring(8);
+    int16_t out[8] = {};
+
+    CHECK(ring.push(out, 6) == RingStatus::Ok);
+    CHECK(ring.consume(6) == RingStatus::Ok);
+
+    // tail at 6: five free slots split 2 + 3
+    auto regions = ring.reserve(5);
+    CHECK(regions.first.size() == 2 && regions.second.size() == 3);
+    int16_t v = 0;
+    for (auto &x : regions.first)
+        x = v++;
+    for (auto &x : regions.second)
+        x = v++;
+    CHECK(ring.isEmpty());
+    CHECK(ring.commit(5) == RingStatus::Ok);
+
+    CHECK(ring.fetch(out, 5) == RingStatus::Ok);
+    for (int i = 0; i < 5; i++)
+        CHECK(out[i] == i);
+
+    // reserve is clamped to the free space
+    CHECK(ring.push(out, 5) == RingStatus::Ok);
+    CHECK(ring.reserve(100).size() == 3);
+
+    ring.clear();
+    CHECK(ring.isEmpty() && ring.space() == 8);
+}
+
+static void testReframer()
+{
+    // 16 kHz, 10 ms capture frames regrouped into 20 ms frames
+    AudioReframer reframer(16000, 160, 320);
+    std::vector<int16_t> frame(160), out(320);
+    int16_t next = 0, expect = 0;
+    int64_t ts = 0;
+
+    for (int i = 0; i < 20; i++)
+    {
+        for (auto &v : frame)
+            v = next++;
+        // 1 ms of jitter on every other capture frame
+        CHECK(reframer.addFrame(frame.data(), 1000000 + i * 10000 + (i & 1) * 1000));
+
+        if (i & 1)
+        {
+            CHECK(reframer.hasMoreFrames());
+            CHECK(reframer.getReframedFrame(out.data(), ts));
+            // starts on an even, jitter free frame
+            CHECK(ts == 1000000 + (i - 1) * 10000);
+            for (auto v : out)
+                CHECK(v == expect++);
+        }
+    }
+    CHECK(!reframer.hasMoreFrames());
+    CHECK(!reframer.getReframedFrame(out.data(), ts));
+
+    // 20 ms in, 15 ms out: the output start falls inside a capture frame
+    AudioReframer split(16000, 320, 240);
+    std::vector<int16_t> in(320);
+    CHECK(split.addFrame(in.data(), 0));
+    CHECK(split.addFrame(in.data(), 20000));
+    CHECK(split.getReframedFrame(out.data(), ts) && ts == 0);
+    CHECK(split.getReframedFrame(out.data(), ts) && ts == 15000);
+    CHECK(!split.getReframedFrame(out.data(), ts));
+    CHECK(split.addFrame(in.data(), 40000));
+    CHECK(split.getReframedFrame(out.data(), ts) && ts == 30000);
+
+    // full buffer drops the frame; 2 x 160 samples round up to 512
+    AudioReframer full(16000, 160, 160);
+    int accepted = 0;
+    for (int i = 0; i < 8; i++)
+        accepted += full.addFrame(frame.data(), i * 10000);
+    CHECK(accepted == 3);
+}
+
+int main()
+{
+    testCapacity();
+    testPushFetchWrap();
+    testOverflowUnderflow();
+    testPeekConsume();
+    testReserveCommit();
+    testReframer();
+    return checkResult("test_ring_buffer");
+}